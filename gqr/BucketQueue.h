@@ -0,0 +1,143 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef BUCKET_QUEUE_H
+#define BUCKET_QUEUE_H
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+/**
+ * A priority queue with decrease-key functionality for small integer keys
+ * and dense indices, e.g., edge weights and edges i*size+j of a network.
+ * Drop-in replacement of PriorityQueue.
+ *
+ * There is one FIFO bucket per key. The current key of an index is stored in
+ * an array indexed by the index itself; decrease-key appends the index to the
+ * bucket of its new key and leaves a stale entry behind, which is skipped
+ * once it reaches the front of its bucket. Insert and decrease-key are O(1);
+ * popMin scans for the next non-empty bucket, which takes at most as many
+ * steps as there are keys between two successive minima.
+ */
+
+class BucketQueue {
+ private:
+    /** Key of an index that is not queued */
+    static const size_t notQueued = (size_t) -1;
+
+    /** Index and stamp of an entry in a bucket */
+    typedef std::pair < size_t, size_t > Entry;
+
+    /** Entries queued with key k, the first m_front[k] ones are popped */
+    std::vector < std::vector < Entry > > m_buckets;
+    std::vector < size_t > m_front;
+    /** Key and stamp of the current entry of each index */
+    std::vector < std::pair < size_t, size_t > > m_current;
+    size_t m_stamp;
+    /** Smallest key of a queued index (if any) */
+    size_t m_min;
+    size_t m_size;
+
+    inline bool isCurrent(const Entry& e, const size_t key) const {
+        return m_current[e.first].first == key && m_current[e.first].second == e.second;
+    }
+
+    /** Drop stale entries at the front of bucket m_min, go to the next bucket if it runs empty */
+    inline void skipStale() {
+        while (true) {
+            std::vector < Entry > &bucket = m_buckets[m_min];
+            size_t &front = m_front[m_min];
+
+            while (front < bucket.size() && !isCurrent(bucket[front], m_min))
+                front++;
+            if (front < bucket.size())
+                return;
+
+            bucket.clear();
+            front = 0;
+            m_min++;
+        }
+    }
+
+ public:
+    BucketQueue() : m_stamp(0), m_min(0), m_size(0) {  /* NOCODE */  }
+
+    /** Remove all elements; takes time linear in the number of keys and entries */
+    inline void clear() {
+        for (size_t k = 0; k < m_buckets.size(); k++) {
+            for (size_t i = 0; i < m_buckets[k].size(); i++)
+                m_current[m_buckets[k][i].first].first = notQueued;
+            m_buckets[k].clear();
+            m_front[k] = 0;
+        }
+        m_min = 0;
+        m_size = 0;
+    }
+
+    inline size_t getSize() const {
+        return m_size;
+    }
+
+    inline bool empty() const {
+        return m_size == 0;
+    }
+
+    inline void popMin() {
+        assert(!empty());
+
+        m_current[m_buckets[m_min][m_front[m_min]].first].first = notQueued;
+        m_front[m_min]++;
+        if (--m_size > 0)
+            skipStale();
+    }
+
+    /** @return pair of index and key */
+    inline std::pair < size_t, size_t > peekMin() const {
+        assert(!empty());
+        return std::make_pair(m_buckets[m_min][m_front[m_min]].first, m_min);
+    }
+
+    inline void insert(const size_t index, const size_t key) {
+        if (index >= m_current.size())
+            m_current.resize(index + 1, std::make_pair((size_t) notQueued, (size_t) 0));
+        if (key >= m_buckets.size()) {
+            m_buckets.resize(key + 1);
+            m_front.resize(key + 1, 0);
+        }
+
+        if (m_current[index].first != notQueued) {
+            assert(m_current[index].first >= key);    // keys can only decrease!
+            if (m_current[index].first == key)
+                return;
+        }
+        else
+            m_size++;
+
+        m_current[index] = std::make_pair(key, ++m_stamp);
+        m_buckets[key].push_back(std::make_pair(index, m_stamp));
+        if (key < m_min || m_size == 1) {
+            m_min = key;
+            skipStale();
+        }
+    }
+};
+
+#endif                          // BUCKET_QUEUE_H
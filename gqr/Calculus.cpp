@@ -27,6 +27,7 @@
 #include "Stringtools.h" // TODO: should we really deal with strings in this class?
 
 #include "Splitter.h"
+#include "CalculusCache.h"
 
 /**
  * Implementation of the Calculus class template
@@ -69,7 +70,7 @@ Calculus::Calculus(const std::string& name,
 	relationWeights(weights),
 	universalRelation(buildUniversalRelation(getNumberOfBaseRelations())),
 	identityRelation(buildIdentityRelation(identity)),
-	splitter(NULL)
+	splitter(NULL), cache(NULL)
 	{
 
 	assert(identity < getNumberOfBaseRelations());
@@ -88,6 +89,7 @@ Calculus::Calculus(const std::string& name,
 
 Calculus::~Calculus() {
 	delete splitter;
+	delete cache;
 }
 
 std::string Calculus::relationToString(const Relation& rel) const {
@@ -253,8 +255,14 @@ bool Calculus::checkCompositionTable() const {
 	return true;
 }
 
-void Calculus::setSplitter(Splitter* s) {
+void Calculus::setSplitter(Splitter* s, const std::string& name) {
 	assert(splitter == NULL);
 	assert(s != NULL);
 	splitter = s;
+	splitterName = name;
+}
+
+void Calculus::setCache(CalculusCache* c) {
+	assert(cache == NULL);
+	cache = c;
 }
@@ -28,6 +28,7 @@
 #include "Relation.h"
 
 class Splitter;
+class CalculusCache;
 
 /** Class representing a relation calculus (relational algebra). */
 class Calculus {
@@ -61,6 +62,11 @@ class Calculus {
 
 		// Splitter (e.g., tractability information */
 		Splitter* splitter;
+		// Name of the splitter (empty if unknown)
+		std::string splitterName;
+
+		// Binary cache of this calculus (NULL if not used)
+		CalculusCache* cache;
 	public:
 		/**
 		* Constructor
@@ -176,9 +182,17 @@ class Calculus {
 		/** Are all base relations of this calculus serial? */
 		inline bool baseRelationsAreSerial() const { return baseRelationsSerial; }
 
-		void setSplitter(Splitter* s);
+		/** Set the splitter (takes ownership); a name identifies the split set in the calculus cache */
+		void setSplitter(Splitter* s, const std::string& name = "");
 
 		const Splitter* getSplitter() const { return splitter; }
+		const std::string& getSplitterName() const { return splitterName; }
+
+		/** Attach a binary cache (takes ownership) */
+		void setCache(CalculusCache* c);
+
+		CalculusCache* getCache() const { return cache; }
+
 		const std::string& getName() const { return calculusName; }
 
 		bool operator==(const Calculus& c) const { return calculusName == c.calculusName; } // TODO: this is quite weak
@@ -0,0 +1,486 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include <fstream>
+#include <sstream>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "CalculusCache.h"
+
+#include "Calculus.h"
+#include "Splitter.h"
+
+// File layout (all numbers are size_t in native byte order):
+//	magic, formatVersion, byte order mark, sizeof(size_t)
+//	number of sources, for each: name, size, modification time
+//	number of sections, for each: key, offset (from the start of the file), length
+//	section data, each section starting at a multiple of 'alignment'
+// Strings are stored as their length followed by the characters, padded to a multiple of 8 byte.
+
+static const char magic[] = "GQRCACHE";
+static const size_t byteOrderMark = 0x01020304;
+
+static size_t padding(const size_t pos, const size_t align) {
+	return (align - pos % align) % align;
+}
+
+void CalculusCache::SectionWriter::put(const size_t v) {
+	const char* p = reinterpret_cast<const char*>(&v);
+	data.insert(data.end(), p, p + sizeof(size_t));
+}
+
+void CalculusCache::SectionWriter::put(const std::string& s) {
+	put(s.size());
+	data.insert(data.end(), s.begin(), s.end());
+	data.resize(data.size() + padding(data.size(), sizeof(size_t)), 0);
+}
+
+void CalculusCache::SectionWriter::putTable(const void* p, const size_t bytes) {
+	data.resize(data.size() + padding(data.size(), alignment), 0);
+	const char* c = static_cast<const char*>(p);
+	data.insert(data.end(), c, c + bytes);
+}
+
+bool CalculusCache::SectionReader::get(size_t& v) {
+	if (!ok || pos + sizeof(size_t) > length)
+		return ok = false;
+	memcpy(&v, data + pos, sizeof(size_t));
+	pos += sizeof(size_t);
+	return true;
+}
+
+bool CalculusCache::SectionReader::get(std::string& s) {
+	size_t l;
+	if (!get(l) || l > length - pos)
+		return ok = false;
+	s.assign(data + pos, l);
+	pos += l;
+	pos += padding(pos, sizeof(size_t));
+	return true;
+}
+
+const char* CalculusCache::SectionReader::getTable(const size_t bytes) {
+	if (!ok)
+		return NULL;
+	pos += padding(pos, alignment);
+	if (pos > length || bytes > length - pos) {
+		ok = false;
+		return NULL;
+	}
+	const char* res = data + pos;
+	pos += bytes;
+	return res;
+}
+
+CalculusCache::CalculusCache(const std::string& dir, const std::string& name)
+	: dataDir(dir), filename(dir + "/" + name + ".cache"),
+	mapping(NULL), mappingLength(0), valid(false) {
+
+	valid = map() && parse();
+	if (!valid) {
+		sources.clear();
+		sections.clear();
+	}
+}
+
+CalculusCache::~CalculusCache() {
+	unmap();
+}
+
+bool CalculusCache::map() {
+	const int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return false;
+	}
+
+	void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return false;
+
+	mapping = static_cast<const char*>(p);
+	mappingLength = st.st_size;
+	return true;
+}
+
+void CalculusCache::unmap() {
+	if (mapping != NULL)
+		munmap(const_cast<char*>(mapping), mappingLength);
+	mapping = NULL;
+	mappingLength = 0;
+}
+
+bool CalculusCache::parse() {
+	if (mappingLength < sizeof(magic) - 1 || memcmp(mapping, magic, sizeof(magic) - 1) != 0)
+		return false;
+
+	SectionReader in(mapping + sizeof(magic) - 1, mappingLength - (sizeof(magic) - 1));
+	size_t version, bom, wordSize;
+	if (!in.get(version) || !in.get(bom) || !in.get(wordSize))
+		return false;
+	if (version != formatVersion || bom != byteOrderMark || wordSize != sizeof(size_t))
+		return false;
+
+	size_t nSources;
+	if (!in.get(nSources))
+		return false;
+	for (size_t i = 0; i < nSources; i++) {
+		SourceStamp recorded, current;
+		if (!in.get(recorded.name) || !in.get(recorded.size) || !in.get(recorded.mtime))
+			return false;
+		if (!stampSource(recorded.name, current)
+			|| current.size != recorded.size || current.mtime != recorded.mtime)
+			return false; // source changed
+		sources.push_back(recorded);
+	}
+
+	size_t nSections;
+	if (!in.get(nSections))
+		return false;
+	for (size_t i = 0; i < nSections; i++) {
+		std::string key;
+		size_t offset, length;
+		if (!in.get(key) || !in.get(offset) || !in.get(length))
+			return false;
+		if (offset > mappingLength || length > mappingLength - offset)
+			return false;
+		sections[key] = std::make_pair(mapping + offset, length);
+	}
+
+	return true;
+}
+
+bool CalculusCache::stampSource(const std::string& name, SourceStamp& stamp) const {
+	const std::string path = dataDir + "/" + name;
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0)
+		return false;
+
+	stamp.name = name;
+	stamp.size = st.st_size;
+	stamp.mtime = st.st_mtime;
+	return true;
+}
+
+void CalculusCache::reset(const std::vector<std::string>& s) {
+	valid = false;
+	sources.clear();
+	sections.clear();
+	addedSections.clear();
+	for (size_t i = 0; i < s.size(); i++)
+		addSource(s[i]);
+}
+
+void CalculusCache::addSource(const std::string& source) {
+	for (size_t i = 0; i < sources.size(); i++)
+		if (sources[i].name == source)
+			return;
+
+	SourceStamp stamp;
+	if (stampSource(source, stamp))
+		sources.push_back(stamp);
+}
+
+std::vector<std::string> CalculusCache::getSectionKeys() const {
+	std::vector<std::string> keys;
+	for (std::map<std::string, std::pair<const char*, size_t> >::const_iterator it = sections.begin(); it != sections.end(); ++it)
+		keys.push_back(it->first);
+	return keys;
+}
+
+const char* CalculusCache::getSection(const std::string& key, size_t& length) const {
+	std::map<std::string, std::pair<const char*, size_t> >::const_iterator it = sections.find(key);
+	if (it == sections.end())
+		return NULL;
+
+	length = it->second.second;
+	return it->second.first;
+}
+
+bool CalculusCache::addSection(const std::string& key, const SectionWriter& section) {
+	std::vector<char>& data = addedSections[key];
+	data = section.getData();
+	sections[key] = std::make_pair(data.empty() ? NULL : &data[0], data.size());
+
+	return write();
+}
+
+bool CalculusCache::write() const {
+	SectionWriter header;
+	header.put(formatVersion);
+	header.put(byteOrderMark);
+	header.put(sizeof(size_t));
+
+	header.put(sources.size());
+	for (size_t i = 0; i < sources.size(); i++) {
+		header.put(sources[i].name);
+		header.put(sources[i].size);
+		header.put(sources[i].mtime);
+	}
+
+	// the section data starts after the directory (number of sections; key, offset, length)
+	size_t offset = sizeof(magic) - 1 + header.getData().size() + sizeof(size_t);
+	for (std::map<std::string, std::pair<const char*, size_t> >::const_iterator it = sections.begin(); it != sections.end(); ++it)
+		offset += 3 * sizeof(size_t) + it->first.size() + padding(it->first.size(), sizeof(size_t));
+
+	header.put(sections.size());
+	std::vector<size_t> offsets;
+	for (std::map<std::string, std::pair<const char*, size_t> >::const_iterator it = sections.begin(); it != sections.end(); ++it) {
+		offset += padding(offset, alignment);
+		offsets.push_back(offset);
+		header.put(it->first);
+		header.put(offset);
+		header.put(it->second.second);
+		offset += it->second.second;
+	}
+
+	// write to a temporary file and rename it, so that concurrent runs never see a partial file
+	std::stringstream tmp;
+	tmp << filename << ".tmp." << getpid();
+	const std::string tmpName = tmp.str();
+
+	std::ofstream out(tmpName.c_str(), std::ios::binary | std::ios::trunc);
+	if (!out.is_open())
+		return false;
+
+	out.write(magic, sizeof(magic) - 1);
+	out.write(&header.getData()[0], header.getData().size());
+	size_t pos = sizeof(magic) - 1 + header.getData().size();
+	size_t i = 0;
+	for (std::map<std::string, std::pair<const char*, size_t> >::const_iterator it = sections.begin(); it != sections.end(); ++it, ++i) {
+		assert(offsets[i] >= pos);
+		const std::string pad(offsets[i] - pos, '\0');
+		out.write(pad.data(), pad.size());
+		out.write(it->second.first, it->second.second);
+		pos = offsets[i] + it->second.second;
+	}
+	out.close();
+
+	if (!out || std::rename(tmpName.c_str(), filename.c_str()) != 0) {
+		std::remove(tmpName.c_str());
+		return false;
+	}
+	return true;
+}
+
+// Relations are stored as bit vectors of words(n) size_t words
+
+static size_t words(const size_t n) {
+	return (n + sizeof(size_t)*8 - 1) / (sizeof(size_t)*8);
+}
+
+static void encodeRelation(const Relation& r, size_t* w) {
+	for (Relation::const_iterator it = r.begin(); it != r.end(); it++)
+		w[*it / (sizeof(size_t)*8)] |= (size_t) 1 << (*it % (sizeof(size_t)*8));
+}
+
+static Relation decodeRelation(const size_t* w, const size_t n) {
+	Relation r;
+	for (size_t i = 0; i < n; i++)
+		if (w[i / (sizeof(size_t)*8)] & ((size_t) 1 << (i % (sizeof(size_t)*8))))
+			r.set(i);
+	return r;
+}
+
+Calculus* CalculusCache::readCalculus(const std::string& name) const {
+	size_t length = 0;
+	const char* data = getSection("calculus", length);
+	return decodeCalculus(data, length, name);
+}
+
+Calculus* CalculusCache::decodeCalculus(const char* data, const size_t length, const std::string& name) {
+	SectionReader in(data, length);
+
+	std::string storedName;
+	size_t n, identity;
+	if (!in.get(storedName) || storedName != name || !in.get(n) || !in.get(identity) || n == 0)
+		return NULL;
+
+	std::vector<std::string> names(n);
+	std::vector<size_t> converse(n), weights(n);
+	for (size_t i = 0; i < n; i++)
+		in.get(names[i]);
+	for (size_t i = 0; i < n; i++)
+		in.get(converse[i]);
+	for (size_t i = 0; i < n; i++)
+		in.get(weights[i]);
+
+	const size_t w = words(n);
+	const size_t* table = reinterpret_cast<const size_t*>(in.getTable(n * n * w * sizeof(size_t)));
+	if (!in.good() || identity >= n)
+		return NULL;
+
+	std::vector<std::vector<Relation> > composition(n, std::vector<Relation>(n));
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			composition[i][j] = decodeRelation(table + (i * n + j) * w, n);
+
+	return new Calculus(name, names, identity, converse, composition, weights);
+}
+
+bool CalculusCache::writeCalculus(const Calculus& c) {
+	const size_t n = c.getNumberOfBaseRelations();
+
+	SectionWriter out;
+	out.put(c.getName());
+	out.put(n);
+	out.put(c.getIdentityBaseRelation());
+	for (size_t i = 0; i < n; i++)
+		out.put(c.getBaseRelationName(i));
+	for (size_t i = 0; i < n; i++)
+		out.put(c.getBaseRelationConverse(i));
+	for (size_t i = 0; i < n; i++)
+		out.put(c.getWeightBaseRelation(i));
+
+	const size_t w = words(n);
+	std::vector<size_t> table(n * n * w, 0);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			encodeRelation(c.getBaseRelationComposition(i, j), &table[(i * n + j) * w]);
+	out.putTable(&table[0], table.size() * sizeof(size_t));
+
+	return addSection("calculus", out);
+}
+
+bool CalculusCache::readRelations(const std::string& key, const Calculus& c, std::vector<Relation>& relations) const {
+	size_t length = 0;
+	const char* data = getSection(key, length);
+	return decodeRelations(data, length, c, relations);
+}
+
+bool CalculusCache::decodeRelations(const char* data, const size_t length, const Calculus& c, std::vector<Relation>& relations) {
+	SectionReader in(data, length);
+
+	const size_t n = c.getNumberOfBaseRelations();
+	size_t storedN, count;
+	if (!in.get(storedN) || storedN != n || !in.get(count))
+		return false;
+
+	const size_t w = words(n);
+	const size_t* table = reinterpret_cast<const size_t*>(in.getTable(count * w * sizeof(size_t)));
+	if (!in.good())
+		return false;
+
+	relations.clear();
+	relations.reserve(count);
+	for (size_t i = 0; i < count; i++)
+		relations.push_back(decodeRelation(table + i * w, n));
+	return true;
+}
+
+bool CalculusCache::writeRelations(const std::string& key, const Calculus& c, const std::vector<Relation>& relations) {
+	const size_t n = c.getNumberOfBaseRelations();
+	const size_t w = words(n);
+
+	SectionWriter out;
+	out.put(n);
+	out.put(relations.size());
+	std::vector<size_t> table(relations.size() * w + 1, 0);
+	for (size_t i = 0; i < relations.size(); i++)
+		encodeRelation(relations[i], &table[i * w]);
+	out.putTable(&table[0], relations.size() * w * sizeof(size_t));
+
+	return addSection(key, out);
+}
+
+// Built-in sections
+//
+// builtin/BuiltinCalculi.h is generated at build time by builtin/GenerateBuiltinCalculi; it defines
+// 'builtinSections', an array of all sections of the calculus caches of the built-in calculi.
+
+namespace {
+
+struct BuiltinSection {
+	const char* calculus;
+	const char* key;
+	const size_t* data;
+	size_t length;
+};
+
+}
+
+#ifdef GQR_BUILTIN_CALCULI
+#include "builtin/BuiltinCalculi.h"
+#else
+static const BuiltinSection builtinSections[] = { { "", "", NULL, 0 } };
+#endif
+
+static const char* findBuiltinSection(const std::string& calculus, const std::string& key, size_t& length) {
+	for (size_t i = 0; i < sizeof(builtinSections)/sizeof(BuiltinSection); i++)
+		if (builtinSections[i].data != NULL && calculus == builtinSections[i].calculus && key == builtinSections[i].key) {
+			length = builtinSections[i].length;
+			return reinterpret_cast<const char*>(builtinSections[i].data);
+		}
+	return NULL;
+}
+
+static bool equalCalculi(const Calculus& a, const Calculus& b) {
+	const size_t n = a.getNumberOfBaseRelations();
+	if (n != b.getNumberOfBaseRelations() || a.getIdentityBaseRelation() != b.getIdentityBaseRelation())
+		return false;
+
+	for (size_t i = 0; i < n; i++) {
+		if (a.getBaseRelationName(i) != b.getBaseRelationName(i)
+			|| a.getBaseRelationConverse(i) != b.getBaseRelationConverse(i)
+			|| a.getWeightBaseRelation(i) != b.getWeightBaseRelation(i))
+			return false;
+		for (size_t j = 0; j < n; j++)
+			if (a.getBaseRelationComposition(i, j) != b.getBaseRelationComposition(i, j))
+				return false;
+	}
+	return true;
+}
+
+const char* CalculusCache::getBuiltinSection(const Calculus& c, const std::string& key, size_t& length) {
+	size_t calculusLength = 0;
+	const char* calculusData = findBuiltinSection(c.getName(), "calculus", calculusLength);
+	if (calculusData == NULL)
+		return NULL;
+
+	Calculus* builtin = decodeCalculus(calculusData, calculusLength, c.getName());
+	const bool matches = builtin != NULL && equalCalculi(c, *builtin);
+	delete builtin;
+
+	return matches ? findBuiltinSection(c.getName(), key, length) : NULL;
+}
+
+bool CalculusCache::builtinSplitterMatches(const Calculus& c) {
+	if (c.getSplitter() == NULL)
+		return true;
+
+	size_t length = 0;
+	const char* data = getBuiltinSection(c, "splitset/" + c.getSplitterName(), length);
+	std::vector<Relation> relations;
+	return data != NULL && decodeRelations(data, length, c, relations)
+		&& relations == c.getSplitter()->getSplitRelations();
+}
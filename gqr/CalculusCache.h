@@ -0,0 +1,170 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef CALCULUS_CACHE_H
+#define CALCULUS_CACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Relation.h"
+
+class Calculus;
+
+/**
+ * Binary cache of a calculus, stored next to its .spec file (as name.cache) and
+ * memory-mapped on later runs.
+ *
+ * The file consists of named sections: the parsed calculus, ordered split sets and
+ * the precomputed tables of gqrtl::CalculusOperations for each relation type.
+ * Sections start at multiples of 64 byte, hence tables can be used in place.
+ * The file records size and modification time of every source file it was built
+ * from; if one of them changes (or the format version, the word size, or the byte
+ * order differs) the whole cache is discarded and rebuilt.
+ */
+class CalculusCache {
+	public:
+		/** Version of the file format; increase whenever the layout of a section changes */
+		static const size_t formatVersion = 1;
+
+		/** Alignment (in byte) of the start of sections and tables */
+		static const size_t alignment = 64;
+
+		/** Append-only writer for the content of a section */
+		class SectionWriter {
+			private:
+				std::vector<char> data;
+			public:
+				void put(const size_t v);
+				void put(const std::string& s);
+				/** Append a table of raw bytes, starting at a multiple of 'alignment' */
+				void putTable(const void* p, const size_t bytes);
+
+				const std::vector<char>& getData() const { return data; }
+		};
+
+		/** Reader for a section; every get fails (returns false) after the first error */
+		class SectionReader {
+			private:
+				const char* data;
+				size_t length;
+				size_t pos;
+				bool ok;
+			public:
+				SectionReader(const char* d, const size_t l) : data(d), length(l), pos(0), ok(d != NULL) {}
+
+				bool get(size_t& v);
+				bool get(std::string& s);
+				/** @return pointer to a table written by putTable, NULL on error */
+				const char* getTable(const size_t bytes);
+
+				bool good() const { return ok; }
+		};
+
+		/**
+		* Open the cache file of a calculus. Maps the file if it exists,
+		* is of the current format, and is up to date.
+		*
+		* @param dataDir directory of the .spec file
+		* @param name name of the calculus
+		*/
+		CalculusCache(const std::string& dataDir, const std::string& name);
+		~CalculusCache();
+
+		/** @return true iff the file is mapped and matches all its source files */
+		bool isValid() const { return valid; }
+
+		const std::string& getFilename() const { return filename; }
+
+		/**
+		* Drop all sections and start over with the given source files.
+		* Names are relative to the data directory.
+		*/
+		void reset(const std::vector<std::string>& sources);
+
+		/** Record another source file (relative to the data directory) */
+		void addSource(const std::string& source);
+
+		/** @return the data of a section and its length in byte, NULL if there is no such section */
+		const char* getSection(const std::string& key, size_t& length) const;
+
+		/** Add (or replace) a section and rewrite the cache file */
+		bool addSection(const std::string& key, const SectionWriter& section);
+
+		/** @return the keys of all sections */
+		std::vector<std::string> getSectionKeys() const;
+
+		/** Reconstruct the calculus from section "calculus", NULL if not present */
+		Calculus* readCalculus(const std::string& name) const;
+		bool writeCalculus(const Calculus& c);
+
+		/** Read (resp. write) an ordered set of relations, e.g. a split set */
+		bool readRelations(const std::string& key, const Calculus& c, std::vector<Relation>& relations) const;
+		bool writeRelations(const std::string& key, const Calculus& c, const std::vector<Relation>& relations);
+
+		/** Decode the content of a section written by writeCalculus (resp. writeRelations) */
+		static Calculus* decodeCalculus(const char* data, const size_t length, const std::string& name);
+		static bool decodeRelations(const char* data, const size_t length, const Calculus& c, std::vector<Relation>& relations);
+
+		/**
+		* Sections compiled into the binary (configure with --enable-builtin-calculi).
+		* They are only returned if c is the calculus they were generated from.
+		*
+		* @return the data of section 'key' of calculus c, NULL if there is none
+		*/
+		static const char* getBuiltinSection(const Calculus& c, const std::string& key, size_t& length);
+
+		/** @return true iff the splitter of c has the ordered split set the built-in sections were generated from */
+		static bool builtinSplitterMatches(const Calculus& c);
+
+	private:
+		const std::string dataDir;
+		const std::string filename;
+
+		struct SourceStamp {
+			std::string name;
+			size_t size;
+			size_t mtime;
+		};
+		std::vector<SourceStamp> sources;
+
+		bool stampSource(const std::string& name, SourceStamp& stamp) const;
+
+		/** Memory-mapped file content (NULL if not mapped) */
+		const char* mapping;
+		size_t mappingLength;
+		bool valid;
+
+		/** Sections: pointer into the mapping or into addedSections */
+		std::map<std::string, std::pair<const char*, size_t> > sections;
+		std::map<std::string, std::vector<char> > addedSections;
+
+		bool map();
+		bool parse();
+		void unmap();
+		bool write() const;
+
+		// no copies
+		CalculusCache(const CalculusCache&);
+		CalculusCache& operator=(const CalculusCache&);
+};
+
+#endif // CALCULUS_CACHE_H
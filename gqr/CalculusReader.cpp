@@ -196,6 +196,7 @@ static void printError(const std::string& s) {
 
 Calculus* CalculusReader::makeCalculus() {
 	assert(stream->is_open());
+	sourceFiles.clear();
 
 	const std::map<std::string, std::string> config = readConfigFile(*stream);
 
@@ -231,6 +232,7 @@ Calculus* CalculusReader::makeCalculus() {
 	std::string filename = it->second;
 	if (!openFile(input, dataDir, filename))
 		return NULL;
+	sourceFiles.push_back(filename);
 	const converseTableType converseTable = readConverseTable(input);
 	input.close();
 
@@ -260,6 +262,7 @@ Calculus* CalculusReader::makeCalculus() {
 
 	if (!openFile(input, dataDir, filename))
 		return NULL;
+	sourceFiles.push_back(filename);
 	const std::map< std::pair<std::string, std::string>, std::set<std::string> > compositionTable = readCompositionTable(input);
 	input.close();
 
@@ -291,6 +294,7 @@ Calculus* CalculusReader::makeCalculus() {
 		filename = it->second;
 		if (!openFile(input, dataDir, filename))
 			return NULL;
+		sourceFiles.push_back(filename);
 		const std::map<std::string, size_t> weights = readWeights(input);
 		input.close();
 
@@ -54,6 +54,9 @@ class CalculusReader : public CalculusMaker {
 		/** Fill baseRelations */
 		void extractBaseRelations(const converseTableType&);
 
+		/** Files read (relative to dataDir) besides the .spec file */
+		std::vector<std::string> sourceFiles;
+
 		/** Translation from string to base relation index in baseRelations */
 		std::map<std::string, size_t> baseRelationsIndex;
 
@@ -117,6 +120,9 @@ class CalculusReader : public CalculusMaker {
 		*/
 		CalculusReader(const std::string& name, const std::string& dir, std::ifstream* stream);
 
+		/** Files (relative to the data directory) the last call to makeCalculus read from, besides the .spec file */
+		const std::vector<std::string>& getSourceFiles() const { return sourceFiles; }
+
 		/** Destructor */
 		virtual ~CalculusReader() {};
 };
@@ -0,0 +1,185 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+#include "ChordalGraph.h"
+#include "gqrtl/StampSet.h"
+
+namespace {
+
+typedef std::vector<std::vector<size_t> > Graph;
+
+/** Mark the nodes of list in the cleared set */
+void mark(const std::vector<size_t>& list, gqrtl::StampSet& marked) {
+	marked.clear();
+	for (size_t i = 0; i < list.size(); i++)
+		marked.insert(list[i]);
+}
+
+/** Number of missing edges between the neighbours of u */
+size_t countFill(const Graph& graph, const size_t u, gqrtl::StampSet& marked) {
+	const std::vector<size_t>& n = graph[u];
+	mark(n, marked);
+
+	// every edge between two neighbours is seen from both of its nodes
+	size_t seen = 0;
+	for (size_t a = 0; a < n.size(); a++)
+		for (size_t b = 0; b < graph[n[a]].size(); b++)
+			if (marked.contains(graph[n[a]][b]))
+				seen++;
+
+	return n.size()*(n.size()-1)/2 - seen/2;
+}
+
+void erase(std::vector<size_t>& list, const size_t v) {
+	list.erase(std::find(list.begin(), list.end(), v));
+}
+
+}
+
+ChordalGraph::ChordalGraph(const size_t s, const std::vector<Tuple>& edges) : size(s), fillEdges(0),
+	neighbours(s), edgeIds(s) {
+
+	// remaining: graph of the nodes not eliminated yet; chordal: all edges so far
+	Graph remaining(size);
+	for (std::vector<Tuple>::const_iterator it = edges.begin(); it != edges.end(); ++it) {
+		assert(it->x < size && it->y < size);
+		if (it->x == it->y)
+			continue;
+		remaining[it->x].push_back(it->y);
+		remaining[it->y].push_back(it->x);
+	}
+	for (size_t v = 0; v < size; v++) {
+		std::sort(remaining[v].begin(), remaining[v].end());
+		remaining[v].erase(std::unique(remaining[v].begin(), remaining[v].end()), remaining[v].end());
+	}
+	Graph chordal = remaining;
+
+	gqrtl::StampSet marked(size), updated(size);
+	std::vector<size_t> changed;	// nodes whose fill changed by an elimination
+	std::vector<bool> eliminated(size, false);
+
+	// (fill, node) of the remaining nodes; an entry is stale if the fill of its node changed since
+	typedef std::pair<size_t, size_t> Entry;
+	std::vector<size_t> fill(size);
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > order;
+	for (size_t v = 0; v < size; v++) {
+		fill[v] = countFill(remaining, v, marked);
+		order.push(std::make_pair(fill[v], v));
+	}
+
+	while (!order.empty()) {
+		const size_t v = order.top().second;
+		if (eliminated[v] || order.top().first != fill[v]) {
+			order.pop();
+			continue;
+		}
+		order.pop();
+		eliminated[v] = true;
+		assert(fill[v] == countFill(remaining, v, marked));
+
+		const std::vector<size_t> n = remaining[v];
+		changed.clear();
+
+		// removing v closes the missing pairs (v,w) of its neighbours, w not adjacent to v
+		mark(n, marked);
+		for (size_t a = 0; a < n.size(); a++) {
+			const std::vector<size_t>& nu = remaining[n[a]];
+			size_t adjacent = 0;
+			for (size_t c = 0; c < nu.size(); c++)
+				if (marked.contains(nu[c]))
+					adjacent++;
+			fill[n[a]] -= nu.size() - 1 - adjacent;
+			erase(remaining[n[a]], v);
+			updated.insert(n[a]);
+			changed.push_back(n[a]);
+		}
+		remaining[v].clear();
+
+		// eliminate v: make its neighbours a clique
+		for (size_t a = 0; a < n.size(); a++) {
+			std::vector<size_t>& na = remaining[n[a]];
+			mark(na, marked);
+			for (size_t b = a+1; b < n.size(); b++) {
+				if (marked.contains(n[b]))
+					continue;
+
+				// the fill edge closes a missing pair of every common neighbour
+				// and opens the pairs of n[a] and n[b] with the others' neighbours
+				std::vector<size_t>& nb = remaining[n[b]];
+				size_t common = 0;
+				for (size_t c = 0; c < nb.size(); c++) {
+					const size_t w = nb[c];
+					if (!marked.contains(w))
+						continue;
+					common++;
+					fill[w]--;
+					if (!updated.contains(w)) {
+						updated.insert(w);
+						changed.push_back(w);
+					}
+				}
+				fill[n[a]] += na.size() - common;
+				fill[n[b]] += nb.size() - common;
+
+				na.push_back(n[b]);
+				nb.push_back(n[a]);
+				marked.insert(n[b]);
+				chordal[n[a]].push_back(n[b]);
+				chordal[n[b]].push_back(n[a]);
+				fillEdges++;
+			}
+		}
+
+		for (size_t c = 0; c < changed.size(); c++)
+			order.push(std::make_pair(fill[changed[c]], changed[c]));
+		updated.clear();
+	}
+
+	// number the edges in lexicographic order
+	for (size_t x = 0; x < size; x++) {
+		std::sort(chordal[x].begin(), chordal[x].end());
+		for (std::vector<size_t>::const_iterator y = std::upper_bound(chordal[x].begin(), chordal[x].end(), x); y != chordal[x].end(); ++y)
+			tuples.push_back(Tuple(x, *y));
+	}
+
+	for (size_t id = 0; id < tuples.size(); id++) {
+		const Tuple& t = tuples[id];
+		neighbours[t.x].push_back(t.y);
+		edgeIds[t.x].push_back(id);
+		neighbours[t.y].push_back(t.x);
+		edgeIds[t.y].push_back(id);
+	}
+	// edges in lexicographic order: the neighbour lists are sorted
+	for (size_t x = 0; x < size; x++)
+		assert(std::adjacent_find(neighbours[x].begin(), neighbours[x].end(), std::greater_equal<size_t>()) == neighbours[x].end());
+}
+
+size_t ChordalGraph::getEdge(const size_t x, const size_t y) const {
+	assert(x < size && y < size);
+	const std::vector<size_t>& n = neighbours[x];
+	const std::vector<size_t>::const_iterator it = std::lower_bound(n.begin(), n.end(), y);
+	if (it == n.end() || *it != y)
+		return noEdge;
+	return edgeIds[x][it - n.begin()];
+}
@@ -0,0 +1,81 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef CHORDAL_GRAPH_H
+#define CHORDAL_GRAPH_H
+
+#include <cassert>
+#include <limits>
+#include <vector>
+
+#include "Tuple.h"
+
+/**
+ * Chordal supergraph of the constraint graph of a network, obtained by
+ * eliminating the nodes in min-fill order: the node whose neighbours lack the
+ * fewest edges among each other is removed next, after connecting its
+ * neighbours. The edges added this way are the fill edges.
+ *
+ * The edges (x,y), x < y, are numbered 0, ..., getEdges()-1 in lexicographic
+ * order; the neighbours of every node are sorted, hence the common neighbours
+ * of two nodes, i.e., the triangles of an edge, can be merged in linear time.
+ */
+
+class ChordalGraph {
+	private:
+		size_t size;
+		size_t fillEdges;
+
+		/** Sorted neighbours of each node and the ids of the respective edges */
+		std::vector<std::vector<size_t> > neighbours;
+		std::vector<std::vector<size_t> > edgeIds;
+
+		/** Nodes of each edge */
+		std::vector<Tuple> tuples;
+
+	public:
+		/** Returned by getEdge if there is no such edge */
+		static const size_t noEdge = (size_t) -1;
+
+		/** Triangulate the graph on the nodes 0, ..., s-1 with the given edges (loops are ignored) */
+		ChordalGraph(const size_t s, const std::vector<Tuple>& edges);
+
+		size_t getSize() const { return size; }
+
+		/** Number of edges, including fill edges */
+		size_t getEdges() const { return tuples.size(); }
+
+		/** Number of edges added by the triangulation */
+		size_t getFillEdges() const { return fillEdges; }
+
+		/** Nodes (x,y), x < y, of edge id */
+		const Tuple& getTuple(const size_t id) const {
+			assert(id < tuples.size());
+			return tuples[id];
+		}
+
+		const std::vector<size_t>& getNeighbours(const size_t x) const { return neighbours[x]; }
+		const std::vector<size_t>& getEdgeIds(const size_t x) const { return edgeIds[x]; }
+
+		/** @return the id of edge (x,y) or noEdge */
+		size_t getEdge(const size_t x, const size_t y) const;
+};
+
+#endif // CHORDAL_GRAPH_H
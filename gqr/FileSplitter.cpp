@@ -40,6 +40,12 @@ FileSplitter::FileSplitter(const Calculus& calculus, std::ifstream* splitSetFile
 	orderSplitRelations(calculus);
 	presortSplitRelations(calculus);
 }
+FileSplitter::FileSplitter(const Calculus& calculus, const std::vector<Relation>& relations)
+	: splitRelations(relations) {
+	assert(!splitRelations.empty());
+	presortSplitRelations(calculus);
+}
+
 FileSplitter::~FileSplitter() {}
 
 void FileSplitter::readSplitSetFromFile(std::ifstream* input, const Calculus& calculus) {
@@ -63,12 +63,19 @@ class FileSplitter : public Splitter {
 			* @param splitSetFile input pointer to ifstream object for the split set file
 			*/
 			FileSplitter(const Calculus& calculus, std::ifstream* splitSetFile);
+			/**
+			* Constructor for a split set that is already ordered (e.g., read from the calculus cache)
+			* @param splitRelations split relations in the order of getSplitRelations()
+			*/
+			FileSplitter(const Calculus& calculus, const std::vector<Relation>& splitRelations);
 			/** Destructor */
 			virtual ~FileSplitter();
 
 			virtual bool isSplit(const Relation& r) const;
 
 			virtual Relation getFirstSplit(const Relation& r) const;
+
+			virtual const std::vector<Relation>& getSplitRelations() const { return splitRelations; }
 };
 
 #endif // FILE_SPLITTER_H
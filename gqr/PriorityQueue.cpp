@@ -31,12 +31,11 @@
 void PriorityQueue::popMin() {
 	assert(!empty());
 
-	m_lookup.erase(m_queue[0].first);
 	m_queue[0] = m_queue.back();
 	m_queue.pop_back();
 	if (empty())            // queue is now empty
 		return;
-	m_lookup[m_queue[0].first] = 0;
+	m_position[m_queue[0].first] = 0;
 
 	size_t i = 0;
 	for (size_t minChild = i;; i = minChild) {
@@ -53,8 +52,8 @@ void PriorityQueue::popMin() {
 
 		if (i == minChild)
 			break;          // enforced heap property
-		m_lookup[m_queue[i].first] = minChild;
-		m_lookup[m_queue[minChild].first] = i;
+		m_position[m_queue[i].first] = minChild;
+		m_position[m_queue[minChild].first] = i;
 
 		std::swap(m_queue[i], m_queue[minChild]);
 	}
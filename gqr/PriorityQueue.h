@@ -26,21 +26,27 @@
 #include <utility>
 #include <vector>
 
-#include "gqrtl/HashMap.h"
-
 /**
- * A simple priority queue (heap based) with decrease-key functionality
+ * A simple priority queue (heap based) with decrease-key functionality.
+ * Indices should be small (e.g., edges i*size+j of a network): the heap
+ * position of each index is stored in an array indexed by the index itself.
  */
 
 class PriorityQueue {
  private:
     std::vector < std::pair < size_t, size_t > > m_queue;
-    gqrtl::HashMap<size_t> m_lookup;
+    /** Heap position of each index; valid iff the index is found at that position (sparse set) */
+    std::vector < size_t > m_position;
+
+    inline bool queued(const size_t index) const {
+        const size_t i = m_position[index];
+        return i < m_queue.size() && m_queue[i].first == index;
+    }
 
  public:
+    /** Remove all elements in O(1) */
     inline void clear() {
         m_queue.clear();
-        m_lookup.clear();
     }
     PriorityQueue() {  /* NOCODE */  }
 
@@ -60,17 +66,15 @@ class PriorityQueue {
     }
 
     inline void insert(const size_t index, const size_t key) {
-        std::pair<size_t*, bool> it = m_lookup.insert(index);
+        if (index >= m_position.size())
+            m_position.resize(index + 1, 0);
 
         size_t i;
-        if (it.second) {
-            if ((m_queue.size() + 1) == m_queue.capacity())
-                m_queue.reserve(m_queue.capacity() * 2);
-
+        if (!queued(index)) {
             i = m_queue.size();
             m_queue.push_back(std::make_pair(index, key));
         } else {
-            i = *it.first;
+            i = m_position[index];
             assert(m_queue[i].second >= key);   // keys can only decrease!
 
             if (m_queue[i].second == key)
@@ -82,11 +86,11 @@ class PriorityQueue {
         for (; (i > 0) && (m_queue[(i - 1) / 2].second > key); i = (i - 1) / 2) {
             const size_t parent = (i - 1) / 2;
 
-            m_lookup[m_queue[parent].first] = i;
+            m_position[m_queue[parent].first] = i;
             std::swap(m_queue[i], m_queue[parent]);
         }
 
-        *it.first = i;
+        m_position[index] = i;
     }
 };
 
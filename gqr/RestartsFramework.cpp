@@ -30,11 +30,23 @@ RestartsFramework::RestartsFramework() :
 	restartsHappened(0),
 	nextCutoffValue(0),
 	useRestarts(true), minimizeNogoods(false),
+	nogoodLimit(4096), nogoodGrowth(1.1), nogoodDecay(0.95),
 	strategy(Geometric), cutoff(10) {
 
 	initialize();
 }
 
+RestartsFramework::RestartsFramework(const RestartsFramework& o) :
+	log(NULL),
+	restartsHappened(0),
+	nextCutoffValue(0),
+	useRestarts(o.useRestarts), minimizeNogoods(o.minimizeNogoods),
+	nogoodLimit(o.nogoodLimit), nogoodGrowth(o.nogoodGrowth), nogoodDecay(o.nogoodDecay),
+	strategy(o.strategy), cutoff(o.cutoff) {
+
+	initialize();
+}
+
 RestartsFramework::~RestartsFramework() {
 	delete log;
 }
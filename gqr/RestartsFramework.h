@@ -38,11 +38,17 @@ class RestartsFramework {
 		// Luby sequence (if required)
 		std::list<size_t> luby_seq;
 		std::list<size_t>::const_iterator luby_seq_pos;
+
+		RestartsFramework& operator=(const RestartsFramework&);
 	public:
 		enum Strategy {Geometric, Luby};
 
 		bool useRestarts;
 		bool minimizeNogoods;
+		/** Nogood database: size limit, growth of the limit per reduction, activity decay per restart */
+		size_t nogoodLimit;
+		double nogoodGrowth;
+		double nogoodDecay;
 		Strategy strategy;
 		size_t cutoff;
 
@@ -51,6 +57,8 @@ class RestartsFramework {
 		void initialize();
 
 		RestartsFramework();
+		/** Copy the options; the copy starts its own sequence of restarts */
+		RestartsFramework(const RestartsFramework&);
 		~RestartsFramework();
 };
 
@@ -30,6 +30,8 @@ class Splitter {
 	public:
 		virtual Relation getFirstSplit(const Relation& r) const =0;
 		virtual bool isSplit(const Relation& r) const =0;
+		/** The split relations in the order they are tried by getFirstSplit */
+		virtual const std::vector<Relation>& getSplitRelations() const =0;
 		virtual ~Splitter() { }
 };
 #endif //SPLITTER_H
@@ -0,0 +1,157 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+/**
+ * Benchmark of the composition operation as used in path consistency:
+ * for random relations a, b, c the refinement (a o b) & c is computed with
+ * the plain nested loop over base relations (computeComposition) and with the
+ * engine selected for the relation type (getComposition).
+ *
+ * Usage (from the top level directory): CompositionBench [calculus] [density]
+ * where one in 'density' base relations of a random relation is set.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Calculus.h"
+#include "CalculusReader.h"
+#include "utils/Timer.h"
+#include "gqrtl/CalculusOperations.h"
+
+namespace {
+
+const size_t poolSize = 4096;
+const size_t minRounds = 100;
+
+size_t seed = 4711;
+
+size_t nextRandom() {
+	seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+	return seed >> 17;
+}
+
+template<class R>
+class Bench {
+	private:
+		const gqrtl::CalculusOperations<R> ops;
+		std::vector<R> pool;
+
+		size_t runCompute(const size_t rounds) const {
+			size_t sum = 0;
+			for (size_t r = 0; r < rounds; r++)
+				for (size_t i = 0; i+2 < poolSize; i++) {
+					R res = ops.computeComposition(pool[i], pool[i+1]);
+					res &= pool[i+2];
+					sum += (res == pool[i+2]);
+				}
+			return sum;
+		}
+
+		size_t runGet(const size_t rounds) const {
+			size_t sum = 0;
+			for (size_t r = 0; r < rounds; r++)
+				for (size_t i = 0; i+2 < poolSize; i++) {
+					R res = ops.getComposition(pool[i], pool[i+1]);
+					res &= pool[i+2];
+					sum += (res == pool[i+2]);
+				}
+			return sum;
+		}
+
+	public:
+		Bench(const Calculus& c, const size_t density) : ops(c), pool(poolSize) {
+			for (size_t i = 0; i < poolSize; i++) {
+				for (size_t b = 0; b < c.getNumberOfBaseRelations(); b++)
+					if (nextRandom() % density == 0)
+						pool[i].set(b);
+				if (pool[i].none())
+					pool[i].set(nextRandom() % c.getNumberOfBaseRelations());
+			}
+		}
+
+		bool run() const {
+			for (size_t i = 0; i+1 < poolSize; i++)
+				if (ops.getComposition(pool[i], pool[i+1]) != ops.computeComposition(pool[i], pool[i+1])) {
+					std::cerr << "Composition results differ\n";
+					return false;
+				}
+
+			const Timer start;
+			size_t check = runCompute(minRounds);
+			const Timer middle;
+			check -= runGet(minRounds);
+			const Timer end;
+
+			const double ops = (double) minRounds * (poolSize - 2);
+			const double compute = middle.msec_passed(start) * 1e6 / ops;
+			const double get = end.msec_passed(middle) * 1e6 / ops;
+			std::cout << "relation type: " << R::maxSize() << " bits\n";
+			std::cout << "computeComposition: " << compute << " ns\n";
+			std::cout << "getComposition:     " << get << " ns\n";
+			if (get > 0)
+				std::cout << "speedup:            " << compute / get << "\n";
+			return check == 0;
+		}
+};
+
+template<class R>
+bool tryBench(const Calculus& c, const size_t density, bool& done) {
+	if (done || R::maxSize() < c.getNumberOfBaseRelations())
+		return true;
+	done = true;
+	Bench<R> b(c, density);
+	return b.run();
+}
+
+}
+
+int main(int argc, char** argv) {
+	const std::string name = argc > 1 ? argv[1] : "opra2";
+	const size_t density = argc > 2 ? atoi(argv[2]) : 4;
+	const std::string dataDir = "./data";
+	const std::string filename = dataDir + "/" + name + ".spec";
+
+	std::ifstream input(filename.c_str());
+	if (!input.is_open() || density == 0) {
+		std::cerr << "Usage (from the top level directory): " << argv[0] << " [calculus] [density]\n";
+		return EXIT_FAILURE;
+	}
+	CalculusReader reader(name, dataDir, &input);
+	Calculus* c = reader.makeCalculus();
+	if (!c)
+		return EXIT_FAILURE;
+
+	bool done = false;
+	bool ok = tryBench<gqrtl::Relation8>(*c, density, done)
+		&& tryBench<gqrtl::Relation16>(*c, density, done)
+		&& tryBench<gqrtl::Relation32>(*c, density, done)
+		&& tryBench<gqrtl::RelationFixedBitset<size_t, 1> >(*c, density, done)
+		&& tryBench<gqrtl::RelationFixedBitset<size_t, 2> >(*c, density, done)
+		&& tryBench<gqrtl::RelationFixedBitset<size_t, 4> >(*c, density, done)
+		&& tryBench<gqrtl::RelationFixedBitset<size_t, 5> >(*c, density, done)
+		&& tryBench<gqrtl::RelationFixedBitset<size_t, 10> >(*c, density, done);
+
+	delete c;
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,315 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+/**
+ * Benchmark of the storage policies of gqrtl::CSP (see gqrtl/CSPMatrix.h) and
+ * the queues of WeightedTripleIterator: algebraic closure is enforced on the
+ * same networks stored in row-major order, in tiles, on a Z-order curve and as
+ * triangular matrix, all with PriorityQueue, and in row-major order with
+ * BucketQueue. Reports the time per round and, if the hardware supports it, L1
+ * data cache and last level cache misses per round (Linux perf events).
+ *
+ * Usage (from the top level directory):
+ *   PropagationBench calculus network [rounds]
+ * where 'network' is a CSP file or the number of nodes of a random tree network
+ * (see randomNetwork).
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Calculus.h"
+#include "CalculusReader.h"
+#include "BucketQueue.h"
+#include "CSPReader.h"
+#include "CSPSparse.h"
+#include "PriorityQueue.h"
+#include "utils/Timer.h"
+#include "gqrtl/CalculusOperations.h"
+#include "gqrtl/CSP.h"
+#include "gqrtl/RelationFixedBitset.h"
+#include "gqrtl/WeightedTripleIterator.h"
+
+namespace {
+
+size_t seed = 4711;
+
+size_t nextRandom() {
+	seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+	return seed >> 17;
+}
+
+/**
+ * Random tree with n nodes labelled by base relations. For calculi with strong composition
+ * (e.g. allen, rcc8) the network is consistent, and closing it refines all n*n edges.
+ */
+CSPSparse* randomNetwork(const Calculus& c, const size_t n) {
+	std::stringstream name;
+	name << "random-tree-" << n;
+	CSPSparse* csp = new CSPSparse(n, c, name.str());
+
+	for (size_t j = 1; j < n; j++) {
+		Relation r;
+		r.set(nextRandom() % c.getNumberOfBaseRelations());
+		csp->addConstraint(nextRandom() % j, j, r);
+	}
+
+	return csp;
+}
+
+/** Hardware event counter of this process, see perf_event_open(2) */
+class EventCounter {
+	private:
+		int fd;
+
+	public:
+		EventCounter(const size_t type, const size_t config) : fd(-1) {
+#ifdef __linux__
+			struct perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = type;
+			attr.config = config;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+		}
+
+		~EventCounter() {
+#ifdef __linux__
+			if (fd >= 0)
+				close(fd);
+#endif
+		}
+
+		bool available() const { return fd >= 0; }
+
+		void start() {
+#ifdef __linux__
+			if (fd >= 0)
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+		}
+
+		void stop() {
+#ifdef __linux__
+			if (fd >= 0)
+				ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+		}
+
+		double read() const {
+#ifdef __linux__
+			__u64 count = 0;
+			if (fd >= 0 && ::read(fd, &count, sizeof(count)) == sizeof(count))
+				return (double) count;
+#endif
+			return 0;
+		}
+};
+
+#ifdef __linux__
+EventCounter l1Misses(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+	| (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+EventCounter llcMisses(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#else
+EventCounter l1Misses(0, 0);
+EventCounter llcMisses(0, 0);
+#endif
+
+template<class R>
+class Bench {
+	private:
+		typedef gqrtl::CalculusOperations<R> Ops;
+		typedef gqrtl::CSP<R, Ops, gqrtl::FullMatrix<R> > Reference;
+
+		const Ops ops;
+		const std::vector<CSPSparse*>& networks;
+		const size_t rounds;
+
+		/** Results of the row-major matrix */
+		std::vector<Reference*> results;
+		double rowMajorTime;
+
+		template<class M, class Q>
+		bool run(const std::string& layout) {
+			typedef gqrtl::CSP<R, Ops, M> Network;
+
+			double time = 0;
+			const double l1Before = l1Misses.read();
+			const double llcBefore = llcMisses.read();
+
+			bool ok = true;
+			for (size_t r = 0; r < rounds; r++) {
+				// set up all networks first: only propagation is timed
+				std::vector<Network*> csps;
+				for (size_t n = 0; n < networks.size(); n++)
+					csps.push_back(new Network(*networks[n], ops));
+				std::vector<bool> consistent(networks.size());
+
+				gqrtl::WeightedTripleIterator<R, Network, Q> propagation;
+				const Timer start;
+				l1Misses.start();
+				llcMisses.start();
+				for (size_t n = 0; n < networks.size(); n++)
+					consistent[n] = propagation.enforce(*csps[n]).empty();
+				l1Misses.stop();
+				llcMisses.stop();
+				time += Timer().msec_passed(start);
+
+				for (size_t n = 0; n < networks.size(); n++) {
+					if (results.size() < networks.size()) {
+						// first layout: reference result
+						results.push_back(new Reference(*networks[n], ops));
+						gqrtl::WeightedTripleIterator<R, Reference>().enforce(*results.back());
+					}
+					const Network& csp = *csps[n];
+					if (consistent[n])
+						for (size_t i = 0; i < csp.getSize(); i++)
+							for (size_t j = i+1; j < csp.getSize(); j++)
+								ok = ok && csp.getConstraint(i, j) == results[n]->getConstraint(i, j);
+					delete csps[n];
+				}
+			}
+
+			if (rowMajorTime == 0)
+				rowMajorTime = time;
+
+			std::cout << std::setw(12) << layout << std::setw(12) << time / rounds;
+			std::cout << std::setw(10) << (time > 0 ? rowMajorTime / time : 0);
+			if (l1Misses.available())
+				std::cout << std::setw(14) << (l1Misses.read() - l1Before) / rounds;
+			else
+				std::cout << std::setw(14) << "n/a";
+			if (llcMisses.available())
+				std::cout << std::setw(14) << (llcMisses.read() - llcBefore) / rounds;
+			else
+				std::cout << std::setw(14) << "n/a";
+			std::cout << "\n";
+
+			if (!ok)
+				std::cerr << "Results of layout " << layout << " differ\n";
+			return ok;
+		}
+
+	public:
+		Bench(const Calculus& c, const std::vector<CSPSparse*>& n, const size_t r) : ops(c), networks(n), rounds(r), rowMajorTime(0) {}
+
+		~Bench() {
+			for (size_t i = 0; i < results.size(); i++)
+				delete results[i];
+		}
+
+		bool run() {
+			std::cout << "relation type: " << R::maxSize() << " bits, " << networks.size() << " network(s), " << rounds << " round(s)\n";
+			std::cout << std::setw(12) << "layout" << std::setw(12) << "ms/round" << std::setw(10) << "speedup";
+			std::cout << std::setw(14) << "L1D misses" << std::setw(14) << "LLC misses" << "\n";
+
+			// row-major first: reference results and time
+			bool ok = run<gqrtl::FullMatrix<R>, PriorityQueue>("row-major");
+			ok = run<gqrtl::FullMatrix<R, gqrtl::TiledIndex<2> >, PriorityQueue>("tiled 4x4") && ok;
+			ok = run<gqrtl::FullMatrix<R, gqrtl::TiledIndex<3> >, PriorityQueue>("tiled 8x8") && ok;
+			ok = run<gqrtl::FullMatrix<R, gqrtl::TiledIndex<4> >, PriorityQueue>("tiled 16x16") && ok;
+			ok = run<gqrtl::FullMatrix<R, gqrtl::MortonIndex>, PriorityQueue>("Z-order") && ok;
+			ok = run<gqrtl::TriangularMatrix<R>, PriorityQueue>("triangular") && ok;
+			ok = run<gqrtl::FullMatrix<R>, BucketQueue>("bucket queue") && ok;
+			return ok;
+		}
+};
+
+template<class R>
+bool tryBench(const Calculus& c, const std::vector<CSPSparse*>& networks, const size_t rounds, bool& done) {
+	if (done || R::maxSize() < c.getNumberOfBaseRelations())
+		return true;
+	done = true;
+	Bench<R> b(c, networks, rounds);
+	return b.run();
+}
+
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cerr << "Usage (from the top level directory): " << argv[0] << " calculus network [rounds]\n";
+		return EXIT_FAILURE;
+	}
+	const std::string name = argv[1];
+	const std::string network = argv[2];
+	const size_t rounds = argc > 3 ? atoi(argv[3]) : 10;
+	const std::string dataDir = "./data";
+	const std::string filename = dataDir + "/" + name + ".spec";
+
+	std::ifstream input(filename.c_str());
+	if (!input.is_open() || rounds == 0) {
+		std::cerr << "Usage (from the top level directory): " << argv[0] << " calculus network [rounds]\n";
+		return EXIT_FAILURE;
+	}
+	CalculusReader reader(name, dataDir, &input);
+	Calculus* c = reader.makeCalculus();
+	if (!c)
+		return EXIT_FAILURE;
+
+	std::vector<CSPSparse*> networks;
+	const size_t nodes = atoi(network.c_str());
+	if (nodes > 1) {
+		networks.push_back(randomNetwork(*c, nodes));
+	}
+	else {
+		std::ifstream csp(network.c_str());
+		if (!csp.is_open()) {
+			std::cerr << "Failed to open CSP \"" << network << "\"\n";
+			delete c;
+			return EXIT_FAILURE;
+		}
+		CSPReader r(&csp, *c);
+		for (CSPSparse* s = r.makeCSP(); s != NULL; s = r.makeCSP())
+			networks.push_back(s);
+	}
+
+	bool done = false;
+	bool ok = tryBench<gqrtl::Relation8>(*c, networks, rounds, done)
+		&& tryBench<gqrtl::Relation16>(*c, networks, rounds, done)
+		&& tryBench<gqrtl::Relation32>(*c, networks, rounds, done)
+		&& tryBench<gqrtl::RelationFixedBitset<size_t, 1> >(*c, networks, rounds, done)
+		&& tryBench<gqrtl::RelationFixedBitset<size_t, 2> >(*c, networks, rounds, done)
+		&& tryBench<gqrtl::RelationFixedBitset<size_t, 4> >(*c, networks, rounds, done)
+		&& tryBench<gqrtl::RelationFixedBitset<size_t, 5> >(*c, networks, rounds, done)
+		&& tryBench<gqrtl::RelationFixedBitset<size_t, 10> >(*c, networks, rounds, done);
+
+	for (size_t i = 0; i < networks.size(); i++)
+		delete networks[i];
+	delete c;
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,152 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+/**
+ * Micro benchmark for the word kernels of RelationFixedBitset.
+ * Each operation is run on a pool of pseudo-random relations with the plain scalar loops
+ * and with the kernels selected at build time (see RelationFixedBitsetKernels.h).
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+
+#include "utils/Timer.h"
+#include "gqrtl/RelationFixedBitsetKernels.h"
+
+namespace {
+
+const size_t poolSize = 1024;
+const size_t rounds = 20000;
+
+size_t seed = 42;
+
+size_t nextRandom() {
+	seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+	return seed ^ (seed >> 29);
+}
+
+/** sparse random words, so that none() and isSubsetOf() do not always exit in the first word */
+std::vector<size_t> makePool(const size_t nWords) {
+	std::vector<size_t> pool(poolSize * nWords);
+	for (size_t i = 0; i < pool.size(); i++)
+		pool[i] = (nextRandom() % 8 == 0) ? nextRandom() : 0;
+	return pool;
+}
+
+template<class K, size_t nWords>
+struct Ops {
+	static size_t runAnd(std::vector<size_t>& p) {
+		for (size_t r = 0; r < rounds; r++)
+			for (size_t i = 0; i+1 < poolSize; i++)
+				K::andAssign(&p[i*nWords], &p[(i+1)*nWords]);
+		return p[0];
+	}
+
+	static size_t runOr(std::vector<size_t>& p) {
+		for (size_t r = 0; r < rounds; r++)
+			for (size_t i = 0; i+1 < poolSize; i++)
+				K::orAssign(&p[i*nWords], &p[(i+1)*nWords]);
+		return p[0];
+	}
+
+	static size_t runFlip(std::vector<size_t>& p) {
+		for (size_t r = 0; r < rounds; r++)
+			for (size_t i = 0; i < poolSize; i++)
+				K::flip(&p[i*nWords]);
+		return p[0];
+	}
+
+	static size_t runNone(std::vector<size_t>& p) {
+		size_t sum = 0;
+		for (size_t r = 0; r < rounds; r++)
+			for (size_t i = 0; i < poolSize; i++)
+				sum += K::none(&p[i*nWords]);
+		return sum;
+	}
+
+	static size_t runEqual(std::vector<size_t>& p) {
+		size_t sum = 0;
+		for (size_t r = 0; r < rounds; r++)
+			for (size_t i = 0; i+1 < poolSize; i++)
+				sum += K::equal(&p[i*nWords], &p[(i+1)*nWords]);
+		return sum;
+	}
+
+	static size_t runSubset(std::vector<size_t>& p) {
+		size_t sum = 0;
+		for (size_t r = 0; r < rounds; r++)
+			for (size_t i = 0; i+1 < poolSize; i++)
+				sum += K::isSubsetOf(&p[i*nWords], &p[(i+1)*nWords]);
+		return sum;
+	}
+};
+
+size_t sink = 0;
+
+double measure(size_t (*op)(std::vector<size_t>&), const size_t nWords) {
+	std::vector<size_t> pool = makePool(nWords);
+	const Timer start;
+	sink += op(pool);
+	const Timer end;
+	return (double) end.msec_passed(start) * 1e6 / (double) (rounds * poolSize); // ns per operation
+}
+
+template<size_t nWords>
+void benchmark() {
+	typedef Ops<gqrtl::ScalarBitsetKernels<size_t, nWords>, nWords> Scalar;
+	typedef Ops<gqrtl::BitsetKernels<size_t, nWords>, nWords> Vector;
+
+	const char* names[] = { "&=", "|=", "flip", "none", "==", "isSubsetOf" };
+	size_t (*scalarOps[])(std::vector<size_t>&) = { Scalar::runAnd, Scalar::runOr, Scalar::runFlip, Scalar::runNone, Scalar::runEqual, Scalar::runSubset };
+	size_t (*vectorOps[])(std::vector<size_t>&) = { Vector::runAnd, Vector::runOr, Vector::runFlip, Vector::runNone, Vector::runEqual, Vector::runSubset };
+
+	for (size_t i = 0; i < 6; i++) {
+		const double s = measure(scalarOps[i], nWords);
+		const double v = measure(vectorOps[i], nWords);
+		std::cout << std::setw(6) << nWords << std::setw(12) << names[i]
+			<< std::setw(12) << s << std::setw(12) << v
+			<< std::setw(10) << (v > 0 ? s / v : 0) << std::endl;
+	}
+}
+
+}
+
+int main() {
+#if defined(GQR_SIMD_AVX2)
+	std::cout << "kernels: AVX2/SSE2" << std::endl;
+#elif defined(GQR_SIMD_SSE2)
+	std::cout << "kernels: SSE2" << std::endl;
+#else
+	std::cout << "kernels: scalar" << std::endl;
+#endif
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << std::setw(6) << "words" << std::setw(12) << "op"
+		<< std::setw(12) << "scalar ns" << std::setw(12) << "kernel ns"
+		<< std::setw(10) << "speedup" << std::endl;
+
+	benchmark<2>();
+	benchmark<4>();
+	benchmark<5>();
+	benchmark<10>();
+
+	return sink == 42 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
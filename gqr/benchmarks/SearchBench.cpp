@@ -0,0 +1,220 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+/**
+ * Stress benchmark of the search engines gqrtl::DFS and gqrtl::RestartingDFS
+ * on large generated networks: the nodes are random intervals of a line, i.e.,
+ * a solution exists for calculi such as allen, and a random tree plus as many
+ * further edges is labelled by the relation of the solution and some further
+ * base relations. Without a cover set every edge is split to base relations,
+ * hence a solution is a branch with one decision per edge of the network.
+ * Reports the visited nodes of the search tree (decisions) per second.
+ *
+ * Usage (from the top level directory):
+ *   SearchBench calculus nodes [networks]
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Calculus.h"
+#include "CalculusReader.h"
+#include "CSPSparse.h"
+#include "RestartsFramework.h"
+#include "utils/Timer.h"
+#include "gqrtl/CalculusOperations.h"
+#include "gqrtl/CSP.h"
+#include "gqrtl/DFS.h"
+#include "gqrtl/RestartingDFS.h"
+#include "gqrtl/RelationFixedBitset.h"
+
+namespace {
+
+size_t seed = 4711;
+
+size_t nextRandom() {
+	seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+	return seed >> 17;
+}
+
+/** Relation of Allen's interval algebra between [s1,e1] and [s2,e2] */
+std::string intervalRelation(const size_t s1, const size_t e1, const size_t s2, const size_t e2) {
+	if (e1 < s2) return "<";
+	if (e2 < s1) return ">";
+	if (e1 == s2) return "m";
+	if (e2 == s1) return "mi";
+	if (s1 == s2 && e1 == e2) return "=";
+	if (s1 == s2) return e1 < e2 ? "s" : "si";
+	if (e1 == e2) return s1 > s2 ? "f" : "fi";
+	if (s1 > s2 && e1 < e2) return "d";
+	if (s1 < s2 && e2 < e1) return "di";
+	return s1 < s2 ? "o" : "oi";
+}
+
+/**
+ * Network with n nodes and 2(n-1) edges, consistent for allen. For other calculi
+ * the edges are labelled by random base relations.
+ */
+CSPSparse* randomNetwork(const Calculus& c, const size_t n, const size_t id) {
+	std::stringstream name;
+	name << "random-intervals-" << n << "-" << id;
+	CSPSparse* csp = new CSPSparse(n, c, name.str());
+
+	const bool intervals = (c.getName() == "allen");
+	std::vector<size_t> start(n), end(n);
+	for (size_t i = 0; i < n; i++) {
+		start[i] = nextRandom() % (4*n);
+		end[i] = start[i] + 1 + nextRandom() % 20;
+	}
+
+	for (size_t e = 1; e < 2*n-1; e++) {
+		const size_t j = (e < n) ? e : 1 + nextRandom() % (n-1);
+		const size_t i = nextRandom() % j;
+
+		Relation r;
+		if (intervals)
+			r = c.encodeRelation(intervalRelation(start[i], end[i], start[j], end[j]));
+		else
+			r.set(nextRandom() % c.getNumberOfBaseRelations());
+		for (size_t k = 0; k < 3; k++)
+			r.set(nextRandom() % c.getNumberOfBaseRelations());
+		csp->addConstraint(i, j, r);
+	}
+
+	return csp;
+}
+
+template<class R>
+class Bench {
+	private:
+		typedef gqrtl::CalculusOperations<R> Ops;
+		typedef gqrtl::CSP<R, Ops> Network;
+
+		const Ops ops;
+		const std::vector<CSPSparse*>& networks;
+
+		void report(const std::string& engine, const size_t consistent, const size_t decisions, const double ms) const {
+			std::cout << std::setw(14) << engine << std::setw(12) << consistent << std::setw(14) << decisions;
+			std::cout << std::setw(12) << ms << std::setw(14) << (ms > 0 ? (size_t) (1000.0 * decisions / ms) : 0) << "\n";
+		}
+
+	public:
+		Bench(const Calculus& c, const std::vector<CSPSparse*>& n) : ops(c), networks(n) {}
+
+		void run() {
+			// a solution has one decision per edge that is not split yet
+			size_t variables = 0;
+			for (size_t n = 0; n < networks.size(); n++) {
+				const Network csp(*networks[n], ops);
+				for (size_t i = 0; i < csp.getSize(); i++)
+					for (size_t j = i+1; j < csp.getSize(); j++)
+						if (!ops.isSplit(csp.getConstraint(i, j)))
+							variables++;
+			}
+
+			std::cout << "relation type: " << R::maxSize() << " bits, " << networks.size() << " network(s), ";
+			std::cout << variables / networks.size() << " variables per network\n";
+			std::cout << std::setw(14) << "engine" << std::setw(12) << "consistent" << std::setw(14) << "decisions";
+			std::cout << std::setw(12) << "ms" << std::setw(14) << "decisions/s" << "\n";
+
+			size_t consistent = 0, decisions = 0;
+			Timer start;
+			for (size_t n = 0; n < networks.size(); n++) {
+				const Network csp(*networks[n], ops);
+				gqrtl::DFS<R> search(csp, NULL);
+				Network* result = search.run();
+				consistent += (result != NULL);
+				decisions += search.getDecisions();
+				delete result;
+			}
+			report("DFS", consistent, decisions, Timer().msec_passed(start));
+
+			consistent = decisions = 0;
+			start = Timer();
+			for (size_t n = 0; n < networks.size(); n++) {
+				const Network csp(*networks[n], ops);
+				RestartsFramework restarts;
+				restarts.initialize();
+				gqrtl::RestartingDFS<R> search(csp, restarts, NULL);
+				Network* result = search.run();
+				consistent += (result != NULL);
+				decisions += search.getDecisions();
+				delete result;
+			}
+			report("RestartingDFS", consistent, decisions, Timer().msec_passed(start));
+		}
+};
+
+template<class R>
+void tryBench(const Calculus& c, const std::vector<CSPSparse*>& networks, bool& done) {
+	if (done || R::maxSize() < c.getNumberOfBaseRelations())
+		return;
+	done = true;
+	Bench<R> b(c, networks);
+	b.run();
+}
+
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cerr << "Usage (from the top level directory): " << argv[0] << " calculus nodes [networks]\n";
+		return EXIT_FAILURE;
+	}
+	const std::string name = argv[1];
+	const size_t nodes = atoi(argv[2]);
+	const size_t count = argc > 3 ? atoi(argv[3]) : 1;
+	const std::string dataDir = "./data";
+	const std::string filename = dataDir + "/" + name + ".spec";
+
+	std::ifstream input(filename.c_str());
+	if (!input.is_open() || nodes < 2 || count == 0) {
+		std::cerr << "Usage (from the top level directory): " << argv[0] << " calculus nodes [networks]\n";
+		return EXIT_FAILURE;
+	}
+	CalculusReader reader(name, dataDir, &input);
+	Calculus* c = reader.makeCalculus();
+	if (!c)
+		return EXIT_FAILURE;
+
+	std::vector<CSPSparse*> networks;
+	for (size_t i = 0; i < count; i++)
+		networks.push_back(randomNetwork(*c, nodes, i));
+
+	bool done = false;
+	tryBench<gqrtl::Relation8>(*c, networks, done);
+	tryBench<gqrtl::Relation16>(*c, networks, done);
+	tryBench<gqrtl::Relation32>(*c, networks, done);
+	tryBench<gqrtl::RelationFixedBitset<size_t, 1> >(*c, networks, done);
+	tryBench<gqrtl::RelationFixedBitset<size_t, 2> >(*c, networks, done);
+	tryBench<gqrtl::RelationFixedBitset<size_t, 4> >(*c, networks, done);
+	tryBench<gqrtl::RelationFixedBitset<size_t, 5> >(*c, networks, done);
+	tryBench<gqrtl::RelationFixedBitset<size_t, 10> >(*c, networks, done);
+
+	for (size_t i = 0; i < networks.size(); i++)
+		delete networks[i];
+	delete c;
+	return EXIT_SUCCESS;
+}
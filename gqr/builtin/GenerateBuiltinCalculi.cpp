@@ -0,0 +1,222 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+/**
+ * Generator of builtin/BuiltinCalculi.h (configure with --enable-builtin-calculi).
+ *
+ * For each calculus given on the command line, the sections of its calculus cache are
+ * written as static arrays: the calculus itself, the precomputed tables of the relation
+ * type gqr uses for it, and the ordered split set and split table for every split set
+ * <calculus>/calculus/*alg. The tables are computed by the same code as at runtime.
+ *
+ * Usage: GenerateBuiltinCalculi dataDir calculus... > BuiltinCalculi.h
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "Calculus.h"
+#include "CalculusCache.h"
+#include "CalculusReader.h"
+#include "FileSplitter.h"
+
+#include "gqrtl/CalculusOperations.h"
+#include "gqrtl/RelationFixedBitset.h"
+
+namespace {
+
+Calculus* readCalculus(const std::string& dataDir, const std::string& name) {
+	const std::string filename = dataDir + "/" + name + ".spec";
+	std::ifstream input(filename.c_str());
+	if (!input.is_open()) {
+		std::cerr << "Failed to open " << filename << "\n";
+		return NULL;
+	}
+
+	CalculusReader reader(name, dataDir, &input);
+	return reader.makeCalculus();
+}
+
+/** Build the calculus operations, which store their tables in the cache of c */
+template<class R>
+bool ground(const Calculus& c) {
+	if (R::maxSize() < c.getNumberOfBaseRelations())
+		return false;
+	gqrtl::CalculusOperations<R> ops(c);
+	return true;
+}
+
+/** Same choice of the relation type as in the consistency subcommands */
+void ground(const Calculus& c) {
+	ground<gqrtl::Relation8>(c)
+		|| ground<gqrtl::Relation16>(c)
+		|| ground<gqrtl::Relation32>(c)
+		|| ground<gqrtl::RelationFixedBitset<size_t, 1> >(c)
+		|| ground<gqrtl::RelationFixedBitset<size_t, 2> >(c)
+		|| ground<gqrtl::RelationFixedBitset<size_t, 4> >(c)
+		|| ground<gqrtl::RelationFixedBitset<size_t, 5> >(c)
+		|| ground<gqrtl::RelationFixedBitset<size_t, 10> >(c);
+}
+
+/** Names of the split sets (files ending in "alg") of a calculus */
+std::vector<std::string> splitSetNames(const std::string& dir) {
+	std::vector<std::string> names;
+	DIR* d = opendir(dir.c_str());
+	if (d == NULL)
+		return names;
+
+	for (struct dirent* e = readdir(d); e != NULL; e = readdir(d)) {
+		const std::string file(e->d_name);
+		if (file.size() > 3 && file.substr(file.size() - 3) == "alg")
+			names.push_back(file.substr(0, file.size() - 3));
+	}
+	closedir(d);
+
+	std::sort(names.begin(), names.end()); // reproducible output
+	return names;
+}
+
+/** Fill the cache in directory tmpDir with all sections of calculus 'name' */
+bool generate(const std::string& dataDir, const std::string& name, const std::string& tmpDir) {
+	Calculus* c = readCalculus(dataDir, name);
+	if (c == NULL)
+		return false;
+
+	c->setCache(new CalculusCache(tmpDir, name));
+	c->getCache()->reset(std::vector<std::string>());
+	if (!c->getCache()->writeCalculus(*c)) {
+		delete c;
+		return false;
+	}
+	ground(*c);
+	delete c;
+
+	const std::vector<std::string> splitSets = splitSetNames(dataDir + "/" + name + "/calculus");
+	for (size_t i = 0; i < splitSets.size(); i++) {
+		CalculusCache* cache = new CalculusCache(tmpDir, name);
+		c = cache->readCalculus(name);
+		if (c == NULL) {
+			delete cache;
+			return false;
+		}
+		c->setCache(cache);
+
+		const std::string filename = dataDir + "/" + name + "/calculus/" + splitSets[i] + "alg";
+		std::ifstream input(filename.c_str());
+		FileSplitter* splitter = new FileSplitter(*c, &input);
+		cache->writeRelations("splitset/" + splitSets[i], *c, splitter->getSplitRelations());
+		c->setSplitter(splitter, splitSets[i]);
+		ground(*c);
+		delete c;
+	}
+
+	return true;
+}
+
+/** C++ identifier for the i-th section of a calculus */
+std::string identifier(const std::string& name, const size_t i) {
+	std::string id = "builtin_";
+	for (size_t j = 0; j < name.size(); j++)
+		id += isalnum(name[j]) ? name[j] : '_';
+	std::stringstream s;
+	s << id << "_" << i;
+	return s.str();
+}
+
+/** Write the sections of the cache in tmpDir as arrays of words; append entries of the section table */
+void emit(const std::string& name, const std::string& tmpDir, std::vector<std::string>& entries) {
+	const CalculusCache cache(tmpDir, name);
+	const std::vector<std::string> keys = cache.getSectionKeys();
+
+	std::cout << "// " << name << "\n";
+	for (size_t i = 0; i < keys.size(); i++) {
+		size_t length = 0;
+		const char* data = cache.getSection(keys[i], length);
+
+		const size_t nWords = (length + sizeof(size_t) - 1) / sizeof(size_t);
+		std::vector<size_t> words(nWords + 1, 0);
+		memcpy(&words[0], data, length);
+
+		const std::string id = identifier(name, i);
+		std::cout << "static const size_t " << id << "[] __attribute__((aligned(" << CalculusCache::alignment << "))) = {";
+		for (size_t w = 0; w < nWords; w++)
+			std::cout << (w % 4 == 0 ? "\n\t" : " ") << "0x" << std::hex << std::setw(2*sizeof(size_t)) << std::setfill('0') << words[w] << std::dec << "UL,";
+		if (nWords == 0)
+			std::cout << " 0";
+		std::cout << "\n};\n";
+
+		std::stringstream entry;
+		entry << "\t{ \"" << name << "\", \"" << keys[i] << "\", " << id << ", " << length << " },\n";
+		entries.push_back(entry.str());
+	}
+	std::cout << "\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " dataDir calculus...\n";
+		return EXIT_FAILURE;
+	}
+	const std::string dataDir(argv[1]);
+
+	char tmpl[] = "/tmp/gqrBuiltinCalculiXXXXXX";
+	if (mkdtemp(tmpl) == NULL) {
+		std::cerr << "Failed to create a temporary directory\n";
+		return EXIT_FAILURE;
+	}
+	const std::string tmpDir(tmpl);
+
+	std::cout << "// Generated by GenerateBuiltinCalculi; do not edit.\n";
+	std::cout << "// Calculus cache sections of the built-in calculi, see CalculusCache.cpp.\n\n";
+
+	bool ok = true;
+	std::vector<std::string> entries;
+	for (int i = 2; i < argc && ok; i++) {
+		const std::string name(argv[i]);
+		ok = generate(dataDir, name, tmpDir);
+		if (ok)
+			emit(name, tmpDir, entries);
+		else
+			std::cerr << "Failed to generate built-in calculus " << name << "\n";
+		std::remove((tmpDir + "/" + name + ".cache").c_str());
+	}
+	rmdir(tmpDir.c_str());
+
+	std::cout << "static const BuiltinSection builtinSections[] = {\n";
+	for (size_t i = 0; i < entries.size(); i++)
+		std::cout << entries[i];
+	std::cout << "\t{ \"\", \"\", NULL, 0 }\n};\n";
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
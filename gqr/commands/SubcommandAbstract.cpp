@@ -29,6 +29,8 @@
 
 #include "CombinedCalculusReader.h"
 #include "CalculusReader.h"
+#include "CalculusCache.h"
+#include "Calculus.h"
 
 #include "utils/Logger.h"
 
@@ -190,13 +192,37 @@ Calculus* SubcommandAbstract::readCalculus(arguments& args) {
 		return res;
 	}
 
-	CalculusReader reader(name, usedDataDir, &input);
-	res = reader.makeCalculus();
+	// the binary cache is stored next to the .spec file and can be disabled by setting GQR_NO_CALCULUS_CACHE
+	CalculusCache* cache = NULL;
+	if (getenv("GQR_NO_CALCULUS_CACHE") == NULL)
+		cache = new CalculusCache(usedDataDir, name);
+
+	if (cache && cache->isValid())
+		res = cache->readCalculus(name);
+
+	if (res != NULL) {
+		if (verbose > 10)
+			std::cout << "Read calculus from cache \"" << cache->getFilename() << "\"\n";
+	}
+	else {
+		CalculusReader reader(name, usedDataDir, &input);
+		res = reader.makeCalculus();
+
+		if (res != NULL && cache) {
+			std::vector<std::string> sources(1, name + ".spec");
+			sources.insert(sources.end(), reader.getSourceFiles().begin(), reader.getSourceFiles().end());
+			cache->reset(sources);
+			if (!cache->writeCalculus(*res) && verbose > 10)
+				std::cout << "Failed to write calculus cache \"" << cache->getFilename() << "\"\n";
+		}
+	}
 
 	if (res == NULL) {
 		// TODO: print some error message
+		delete cache;
 		return NULL;
 	}
+	res->setCache(cache);
 
 	calculusTime.end();
 	if (verbose > 0)
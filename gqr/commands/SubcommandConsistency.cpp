@@ -34,6 +34,7 @@
 #include "CSPReader.h"
 
 #include "FileSplitter.h"
+#include "CalculusCache.h"
 
 #include "gqrtl/RelationFixedBitset.h"
 #include "gqrtl/CSP.h"
@@ -41,6 +42,11 @@
 #include "gqrtl/CalculusOperations.h"
 #include "gqrtl/DFS.h"
 #include "gqrtl/RestartingDFS.h"
+#include "gqrtl/Portfolio.h"
+#include "gqrtl/WorkStealingDFS.h"
+#include "gqrtl/ChordalCSP.h"
+#include "gqrtl/PartialTripleIterator.h"
+#include "ChordalGraph.h"
 
 #include "RestartsFramework.h"
 
@@ -61,12 +67,34 @@ std::string SubcommandConsistency::helpString = std::string(
 	"  --restarts-luby          use 2-way DFS with luby restarting strategy\n"
 	"  --cutoff n               initial cutoff value [default 10]\n"
 	"  --minimize-nogoods       minimize each learnt nogoods\n"
+	"  --nogood-limit n         reduce the learnt nogoods to n/2 whenever there are more\n"
+	"                           than n [default 4096]\n"
+	"  --nogood-growth f        multiply the limit by f after each reduction [default 1.1]\n"
+	"  --nogood-decay f         decay the activity of the nogoods by f per restart\n"
+	"                           [default 0.95]\n"
+	"  --sparse                 propagate partial path consistency on a chordal supergraph\n"
+	"                           of the constraint graph and branch on its edges only\n"
+	"                           (2-way DFS without restarts); -S shows these edges only\n"
+	"  --portfolio n            run n searches in parallel threads, the first answer\n"
+	"                           wins: the one chosen above, the other kinds of search,\n"
+	"                           then all kinds with doubled cutoffs and randomized\n"
+	"                           orderings; disables the composition cache [default 1]\n"
+	"  --threads n              2-way DFS without restarts by n threads, which steal\n"
+	"                           open subtrees near the root from each other; disables\n"
+	"                           the composition cache [default 1]\n"
+	"\n"
+	"  --composition-cache n    cache n compositions (relations with more than 64 base\n"
+	"                           relations only) [default 0, no cache]\n"
 );
 
 SubcommandConsistency::SubcommandConsistency(const std::vector<std::string>& args)
 	: SubcommandAbstract(args), unusedArgs(commandLine),
 	showSolution(false),
 	returnState(false),
+	compositionCacheSize(0),
+	sparse(false),
+	portfolio(1),
+	threads(1),
 	restartOptions(new RestartsFramework()),
 	calculus(NULL) {
 
@@ -144,9 +172,101 @@ bool SubcommandConsistency::parseUnusedArgs() {
 		else if (unusedArgs[i] == "--minimize-nogoods") {
 			restartOptions->minimizeNogoods = true;
 		}
+		else if (unusedArgs[i] == "--nogood-limit") {
+			if (i+1 == unusedArgs.size()) {
+				std::cerr << "Missing argument \"--nogood-limit\"\n";
+				return false;
+			}
+			skip = true;
+
+			std::stringstream in;
+			in << unusedArgs[i+1];
+			in >> restartOptions->nogoodLimit;
+
+			if (restartOptions->nogoodLimit == 0) {
+				std::cerr << "Zero nogood limit given\n";
+				return false;
+			}
+		}
+		else if (unusedArgs[i] == "--nogood-growth") {
+			if (i+1 == unusedArgs.size()) {
+				std::cerr << "Missing argument \"--nogood-growth\"\n";
+				return false;
+			}
+			skip = true;
+
+			std::stringstream in;
+			in << unusedArgs[i+1];
+			in >> restartOptions->nogoodGrowth;
+
+			if (!(restartOptions->nogoodGrowth >= 1.0)) {
+				std::cerr << "Nogood growth must be at least 1\n";
+				return false;
+			}
+		}
+		else if (unusedArgs[i] == "--nogood-decay") {
+			if (i+1 == unusedArgs.size()) {
+				std::cerr << "Missing argument \"--nogood-decay\"\n";
+				return false;
+			}
+			skip = true;
+
+			std::stringstream in;
+			in << unusedArgs[i+1];
+			in >> restartOptions->nogoodDecay;
+
+			if (!(restartOptions->nogoodDecay > 0.0 && restartOptions->nogoodDecay <= 1.0)) {
+				std::cerr << "Nogood decay must be in (0,1]\n";
+				return false;
+			}
+		}
 		else if (unusedArgs[i] == "--2w") {
 			restartOptions->useRestarts = false;
 		}
+		else if (unusedArgs[i] == "--sparse") {
+			sparse = true;
+		}
+		else if (unusedArgs[i] == "--portfolio") {
+			if (i+1 == unusedArgs.size()) {
+				std::cerr << "Missing argument \"--portfolio\"\n";
+				return false;
+			}
+			skip = true;
+
+			std::stringstream in;
+			in << unusedArgs[i+1];
+			in >> portfolio;
+			if (portfolio == 0) {
+				std::cerr << "Invalid argument \"--portfolio " << unusedArgs[i+1] << "\"\n";
+				return false;
+			}
+		}
+		else if (unusedArgs[i] == "--threads") {
+			if (i+1 == unusedArgs.size()) {
+				std::cerr << "Missing argument \"--threads\"\n";
+				return false;
+			}
+			skip = true;
+
+			std::stringstream in;
+			in << unusedArgs[i+1];
+			in >> threads;
+			if (threads == 0) {
+				std::cerr << "Invalid argument \"--threads " << unusedArgs[i+1] << "\"\n";
+				return false;
+			}
+		}
+		else if (unusedArgs[i] == "--composition-cache") {
+			if (i+1 == unusedArgs.size()) {
+				std::cerr << "Missing argument \"--composition-cache\"\n";
+				return false;
+			}
+			skip = true;
+
+			std::stringstream in;
+			in << unusedArgs[i+1];
+			in >> compositionCacheSize;
+		}
 		// TODO: parse/support all options
 		else {
 			new_unused.push_back(unusedArgs[i]);
@@ -155,6 +275,36 @@ bool SubcommandConsistency::parseUnusedArgs() {
 
 	unusedArgs = new_unused;
 
+	if (sparse && restartOptions->useRestarts) {
+		std::cerr << "Restarts ignored for \"--sparse\"\n";
+		restartOptions->useRestarts = false;
+	}
+	if (sparse && portfolio > 1) {
+		std::cerr << "Portfolio ignored for \"--sparse\"\n";
+		portfolio = 1;
+	}
+	if (sparse && threads > 1) {
+		std::cerr << "Multiple threads ignored for \"--sparse\"\n";
+		threads = 1;
+	}
+	if (threads > 1 && portfolio > 1) {
+		std::cerr << "Portfolio ignored for \"--threads " << threads << "\"\n";
+		portfolio = 1;
+	}
+	if (threads > 1 && restartOptions->useRestarts) {
+		std::cerr << "Restarts ignored for \"--threads " << threads << "\"\n";
+		restartOptions->useRestarts = false;
+	}
+	if (portfolio > 1 && compositionCacheSize > 0) {
+		// the composition cache is not safe for concurrent use
+		std::cerr << "Composition cache disabled for \"--portfolio " << portfolio << "\"\n";
+		compositionCacheSize = 0;
+	}
+	if (threads > 1 && compositionCacheSize > 0) {
+		std::cerr << "Composition cache disabled for \"--threads " << threads << "\"\n";
+		compositionCacheSize = 0;
+	}
+
 	#ifndef NDEBUG
 	if (!unusedArgs.empty()) {
 		std::cout << "Remaining (unparsed) arguments:\n";
@@ -176,9 +326,11 @@ bool SubcommandConsistency::setSplitter(const std::string& name) {
 
 	std::ifstream input;
 
+	const std::string algName = calculus->getName() + "/calculus/" + name + "alg";
+	std::string algDataDir;
 	for (size_t i = 0; i < dataDirs.size(); i++) {
-		const std::string& dataDir = dataDirs[i];
-		const std::string algFilename = dataDir + "/" + calculus->getName() + "/calculus/" + name + "alg";
+		algDataDir = dataDirs[i];
+		const std::string algFilename = algDataDir + "/" + algName;
 #ifndef NDEBUG
 std::cout << "Trying to read cover set \"" << name << "\" from \"" << algFilename << "\"\n";
 #endif
@@ -191,8 +343,22 @@ std::cout << "Trying to read cover set \"" << name << "\" from \"" << algFilenam
 		return false;
 	}
 
-	Splitter* splitter = new FileSplitter(*calculus, &input);
-	calculus->setSplitter(splitter);
+	// the ordered split set is kept in the calculus cache (sources are relative to the calculus' data directory)
+	CalculusCache* cache = (algDataDir == usedDataDir) ? calculus->getCache() : NULL;
+	const std::string key = "splitset/" + name;
+
+	FileSplitter* splitter = NULL;
+	std::vector<Relation> splitRelations;
+	if (cache && cache->readRelations(key, *calculus, splitRelations))
+		splitter = new FileSplitter(*calculus, splitRelations);
+	else {
+		splitter = new FileSplitter(*calculus, &input);
+		if (cache) {
+			cache->addSource(algName);
+			cache->writeRelations(key, *calculus, splitter->getSplitRelations());
+		}
+	}
+	calculus->setSplitter(splitter, cache ? name : "");
 
 	splitterTime.end();
 	if (verbose > 0)
@@ -225,16 +391,16 @@ bool SubcommandConsistency::applyConsistency(const std::vector<std::string>& fil
 	if (verbose > 0)
 		b_verbose = true;
 
-	cores.push_back(new runCoreTemplate<gqrtl::Relation8>(showSolution, b_verbose, *restartOptions));
-	cores.push_back(new runCoreTemplate<gqrtl::Relation16>(showSolution, b_verbose, *restartOptions));
-	cores.push_back(new runCoreTemplate<gqrtl::Relation32>(showSolution, b_verbose, *restartOptions));
-	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 1> >(showSolution, b_verbose, *restartOptions));
-	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 2> >(showSolution, b_verbose, *restartOptions));
-	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 4> >(showSolution, b_verbose, *restartOptions));
-	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 5> >(showSolution, b_verbose, *restartOptions));
-	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 10> >(showSolution, b_verbose, *restartOptions));
+	cores.push_back(new runCoreTemplate<gqrtl::Relation8>(showSolution, b_verbose, *restartOptions, compositionCacheSize, sparse, portfolio, threads));
+	cores.push_back(new runCoreTemplate<gqrtl::Relation16>(showSolution, b_verbose, *restartOptions, compositionCacheSize, sparse, portfolio, threads));
+	cores.push_back(new runCoreTemplate<gqrtl::Relation32>(showSolution, b_verbose, *restartOptions, compositionCacheSize, sparse, portfolio, threads));
+	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 1> >(showSolution, b_verbose, *restartOptions, compositionCacheSize, sparse, portfolio, threads));
+	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 2> >(showSolution, b_verbose, *restartOptions, compositionCacheSize, sparse, portfolio, threads));
+	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 4> >(showSolution, b_verbose, *restartOptions, compositionCacheSize, sparse, portfolio, threads));
+	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 5> >(showSolution, b_verbose, *restartOptions, compositionCacheSize, sparse, portfolio, threads));
+	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 10> >(showSolution, b_verbose, *restartOptions, compositionCacheSize, sparse, portfolio, threads));
 	// Fallback default code*/
-	cores.push_back(new runCoreTemplate<Relation>(showSolution, b_verbose, *restartOptions));
+	cores.push_back(new runCoreTemplate<Relation>(showSolution, b_verbose, *restartOptions, compositionCacheSize, sparse, portfolio, threads));
 
 	size_t core;
 	for(core = 0; core < cores.size(); core++)
@@ -255,11 +421,72 @@ bool SubcommandConsistency::applyConsistency(const std::vector<std::string>& fil
 
 	long int total_ms = std::labs(start.msec_passed(Timer()));
 	std::cout << "CSPs processing time: " << ((double) total_ms) / 1000.0 << " seconds" << std::endl;
+	if (b_verbose)
+		cores[core]->printStatistics();
 
 	for (size_t c = 0; c < cores.size(); c++) delete cores[c];
 	return lastState;
 }
 
+RestartsFramework SubcommandConsistency::runCore::portfolioEngine(const size_t i, size_t& seed, std::string& name) const {
+	// kinds of search: 2-way DFS, Luby and geometric restarts
+	// search 0 is the given one, then come the other kinds, then all kinds
+	// with doubled cutoffs and randomized orderings
+	const size_t given = !restartOptions.useRestarts ? 0 : (restartOptions.strategy == RestartsFramework::Luby ? 1 : 2);
+	size_t kind = given, round = 0;
+	seed = 0;
+	if (i > 0 && i < 3)
+		kind = (i <= given) ? i-1 : i;
+	else if (i >= 3) {
+		kind = (i-3) % 3;
+		round = 1 + (i-3) / 3;
+		seed = i;
+	}
+
+	RestartsFramework options(restartOptions);
+	options.useRestarts = (kind != 0);
+	options.strategy = (kind == 1) ? RestartsFramework::Luby : RestartsFramework::Geometric;
+	options.cutoff = restartOptions.cutoff << round;
+
+	std::ostringstream out;
+	if (kind == 0)
+		out << "2-way DFS";
+	else
+		out << (kind == 1 ? "Luby" : "geometric") << " restarts, cutoff " << options.cutoff;
+	if (seed)
+		out << ", seed " << seed;
+	name = out.str();
+	return options;
+}
+
+template<class R>
+template<class N>
+int SubcommandConsistency::runCoreTemplate<R>::report(const std::string& name, N* result) const {
+	if (result == NULL) {
+		std::cout << name << ": 0" << std::endl;
+		return 0;
+	}
+
+	std::cout << name << ": 1" << std::endl;
+	if (showSolution) {
+		std::vector<Tuple> edges;
+		result->getEdges(edges);
+
+		std::cout << result->getSize()-1 << " " << name << std::endl;
+		for (std::vector<Tuple>::const_iterator it = edges.begin(); it != edges.end(); ++it) {
+			const R rel = result->getConstraint(it->x, it->y);
+			if (rel != calculus->getUniversalRelation()) {
+				std::cout << it->x << " " << it->y << " ";
+				std::cout << calculus->getCalculus().relationToString(rel.getRelation());
+				std::cout << std::endl;
+			}
+		}
+		std::cout << ".\n";
+	}
+	delete result;
+	return 1;
+}
+
 template<class R>
 int SubcommandConsistency::runCoreTemplate<R>::execute(const std::string& name) {
 	assert(calculus);
@@ -278,72 +505,91 @@ int SubcommandConsistency::runCoreTemplate<R>::execute(const std::string& name)
 	CSPSparse* input;
 	while ( (input = r.makeCSP()) != NULL) {
 
-		Logger groundTime("CSP ground time", 0);
-		groundTime.start();
-
-		typedef gqrtl::CSP<R, gqrtl::CalculusOperations<R> > GroundedRep;
-		GroundedRep csp(*input, *calculus);
-
-		groundTime.end();
-		if (verbose)
-			groundTime.postLog("", 1, "CSPs");
-
 		Logger* log = NULL;
 		if (verbose) {
 			const std::string name = std::string("DFS on ")+input->name;
 			log = new Logger(name, 30*1000);
 		}
 
+		Logger groundTime("CSP ground time", 0);
+		if (sparse) {
+			typedef gqrtl::ChordalCSP<R, gqrtl::CalculusOperations<R> > ChordalRep;
+			typedef gqrtl::PartialTripleIterator<R, gqrtl::CSPStack<R, gqrtl::CalculusOperations<R>, ChordalRep> > Propagator;
+
+			groundTime.start();
 
-		GroundedRep* result;
-		if (restartOptions.useRestarts) {
-			restartOptions.initialize();
-			gqrtl::RestartingDFS<R> search(csp, restartOptions, log);
-			result = search.run();
+			std::vector<Tuple> constrained;
+			for (CSPSparse::const_iterator it = input->begin(); it != input->end(); ++it)
+				constrained.push_back(Tuple(it->first.first, it->first.second));
+			const ChordalGraph graph(input->getSize(), constrained);
+			ChordalRep csp(*input, *calculus, graph);
+
+			groundTime.end();
+			if (verbose)
+				groundTime.postLog("", 1, "CSPs");
+
+			gqrtl::DFS<R, ChordalRep, Propagator> search(csp, log);
+			ChordalRep* result = search.run();
 			if (log)
 				log->finalReport( (result != NULL), search);
+			ret = report(input->name, result);
 		}
 		else {
-			gqrtl::DFS<R> search(csp, log);
-			result = search.run();
-			if (log)
-				log->finalReport( (result != NULL), search);
-		}
+			typedef gqrtl::CSP<R, gqrtl::CalculusOperations<R> > GroundedRep;
 
+			groundTime.start();
 
-		delete log;
+			GroundedRep csp(*input, *calculus);
 
-		if (result == NULL) {
-			std::cout << input->name << ": 0";
-//		if (swVerbose) {
-//		    consistency->printStatistics();
-//		}
-			std::cout << std::endl;
-			ret = 0;
-		}
-		else { // if (!consistencyFindAllConsistentSubCSPs) {
-//	    if (swDisplayConsistentNetworks) {
-			std::cout << input->name << ": 1";
-//		if (swVerbose) {
-//			consistency->printStatistics();
-//		}
-			std::cout << std::endl;
-			if (showSolution) {
-				std::cout << csp.getSize()-1 << " " << csp.name << std::endl;
-				for (size_t i = 0; i < csp.getSize(); ++i)
-					for (size_t j = i+1; j < csp.getSize(); ++j) {
-						const R& rel = result->getConstraint(i,j);
-						if (rel != calculus->getUniversalRelation()) {
-							std::cout << i << " " << j << " ";
-							std::cout << calculus->getCalculus().relationToString(rel.getRelation());
-							std::cout << std::endl;
-						}
-					}
-				std::cout << ".\n";
+			groundTime.end();
+			if (verbose)
+				groundTime.postLog("", 1, "CSPs");
+
+			GroundedRep* result;
+			if (threads > 1) {
+				gqrtl::WorkStealingDFS<R> search(csp, threads, log, getenv("SD") ? atoi(getenv("SD")) : 8);
+				result = search.run();
+				if (log) {
+					std::cout << "\tWork stealing; threads=" << threads << ", stolen subtrees=" << search.getStolen() << "\n";
+					log->finalReport( (result != NULL), search);
+				}
+			}
+			else if (portfolio > 1) {
+				gqrtl::Portfolio<R> search(csp);
+				std::vector<std::string> names;
+				for (size_t e = 0; e < portfolio; e++) {
+					size_t seed = 0;
+					names.push_back("");
+					const RestartsFramework options = portfolioEngine(e, seed, names.back());
+					search.addEngine(options, seed);
+				}
+
+				if (log)
+					log->start();
+				result = search.run();
+				if (log) {
+					log->end();
+					std::cout << "\tPortfolio; first answer by search #" << search.getWinner() << " (" << names[search.getWinner()] << ")\n";
+					log->finalReport( (result != NULL), search.getWinnerReport());
+				}
+			}
+			else if (restartOptions.useRestarts) {
+				restartOptions.initialize();
+				gqrtl::RestartingDFS<R> search(csp, restartOptions, log);
+				result = search.run();
+				if (log)
+					log->finalReport( (result != NULL), search);
 			}
-			delete result;
-			ret = 1;
+			else {
+				gqrtl::DFS<R> search(csp, log);
+				result = search.run();
+				if (log)
+					log->finalReport( (result != NULL), search);
+			}
+			ret = report(input->name, result);
 		}
+
+		delete log;
 		delete input;
 	}
 	i.close();
@@ -362,8 +608,8 @@ std::cout << "gqrtl::Calculus build on relations with a maximum of " << R::maxSi
 	Logger groundTime("Calculus ground time", 0);
 	groundTime.start();
 
-	R::init();
 	calculus = new gqrtl::CalculusOperations<R>(c);
+	calculus->setCompositionCacheSize(compositionCacheSize);
 
 	groundTime.end();
 	if (verbose)
@@ -372,9 +618,14 @@ std::cout << "gqrtl::Calculus build on relations with a maximum of " << R::maxSi
 	return true;
 }
 
+template<class R>
+void SubcommandConsistency::runCoreTemplate<R>::printStatistics() const {
+	if (calculus)
+		calculus->printStatistics();
+}
+
 template<class R>
 SubcommandConsistency::runCoreTemplate<R>::~runCoreTemplate() {
 	if (!calculus) return;
 	delete calculus;
-	R::clean_up();
 }
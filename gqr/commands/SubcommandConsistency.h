@@ -42,6 +42,10 @@ class SubcommandConsistency: public SubcommandAbstract {
 
 		bool showSolution;
 		bool returnState;
+		size_t compositionCacheSize;
+		bool sparse;
+		size_t portfolio;
+		size_t threads;
 
 		RestartsFramework* restartOptions;
 
@@ -52,22 +56,35 @@ class SubcommandConsistency: public SubcommandAbstract {
 				bool showSolution;
 				bool verbose;
 				RestartsFramework& restartOptions;
+				size_t compositionCacheSize;
+				bool sparse;
+				size_t portfolio;
+				size_t threads;
+
+				/** Options and seed of search i of the portfolio; a readable description is stored in name */
+				RestartsFramework portfolioEngine(const size_t i, size_t& seed, std::string& name) const;
 			public:
-				runCore(const bool s, const bool v, RestartsFramework& o) : showSolution(s), verbose(v), restartOptions(o) {}
+				runCore(const bool s, const bool v, RestartsFramework& o, const size_t c, const bool sp, const size_t p, const size_t t) : showSolution(s), verbose(v), restartOptions(o), compositionCacheSize(c), sparse(sp), portfolio(p), threads(t) {}
 				virtual ~runCore() {}
 				virtual int execute(const std::string&) = 0;
 				virtual bool ground(const Calculus& c) = 0;
+				virtual void printStatistics() const = 0;
 		};
 
 		template<class R>
 		class runCoreTemplate : public runCore {
 			private:
 				gqrtl::CalculusOperations<R>* calculus;
+
+				/** Print (and delete) the solution of a network, NULL if it is inconsistent. @return 1 iff consistent */
+				template<class N>
+				int report(const std::string& name, N* result) const;
 			public:
-				runCoreTemplate(const bool a, const bool b, RestartsFramework& o) : runCore(a,b, o), calculus(NULL) {};
+				runCoreTemplate(const bool a, const bool b, RestartsFramework& o, const size_t c, const bool sp, const size_t p, const size_t t) : runCore(a,b, o, c, sp, p, t), calculus(NULL) {};
 				virtual ~runCoreTemplate();
 				virtual int execute(const std::string&);
 				virtual bool ground(const Calculus& c);
+				virtual void printStatistics() const;
 		};
 
 		bool applyConsistency(const std::vector<std::string>& filenames) const;
@@ -22,6 +22,8 @@
 #include <cassert>
 #include <cstdlib>
 
+#include <sstream>
+
 #include <fstream>
 
 #include "utils/Timer.h"
@@ -30,12 +32,17 @@
 #include "SubcommandPathConsistency.h"
 #include "Calculus.h"
 #include "CSPReader.h"
+#include "BucketQueue.h"
 
 #include "gqrtl/RelationFixedBitset.h"
 #include "gqrtl/CSP.h"
 #include "CSPSparse.h"
 #include "gqrtl/CalculusOperations.h"
 #include "gqrtl/WeightedTripleIterator.h"
+#include "gqrtl/ParallelTripleIterator.h"
+#include "gqrtl/ChordalCSP.h"
+#include "gqrtl/PartialTripleIterator.h"
+#include "ChordalGraph.h"
 
 std::string SubcommandPathConsistency::helpString = std::string(
 	"Path consistency: enforce path consistency on constraint networks described in 'file_i'\n"
@@ -48,6 +55,17 @@ std::string SubcommandPathConsistency::helpString = std::string(
 	"                           (suppresses -n)\n"
 	"  -S, --solution           display solution (if any) for each network\n"
 	"  -q                       return state of last CSP (0 inconsistent, 1 otherwise)\n"
+	"  -v, --verbose            show statistics of the composition cache and of skipped\n"
+	"                           revisions\n"
+	"  --composition-cache n    cache n compositions (relations with more than 64 base\n"
+	"                           relations only) [default 0, no cache]\n"
+	"  --threads n              enforce path consistency with n threads; disables the\n"
+	"                           composition cache [default 1]\n"
+	"  --skip-revisions         skip revisions of triangles whose edges did not change\n"
+	"                           since they were last revised (single thread only)\n"
+	"  --sparse                 enforce partial path consistency on a chordal supergraph\n"
+	"                           of the constraint graph (min-fill triangulation); -S shows\n"
+	"                           the edges of that graph only (single thread only)\n"
 );
 
 SubcommandPathConsistency::SubcommandPathConsistency(const std::vector<std::string>& a) : SubcommandAbstract(a),
@@ -55,10 +73,16 @@ unusedArgs(commandLine),
 negativeOnly(false), positiveOnly(false),
 showSolution(false),
 returnState(false),
+compositionCacheSize(0),
+threads(1),
+skipRevisions(false),
+sparse(false),
 //swPrintConvTable(false), swPrintCompTable(false), swPrintBaseRelations(false),
 calculus(NULL) {
 
 	if (!commandLine.empty()) {
+		parseArguments(unusedArgs); // sets "verbose"
+
 		calculus = readCalculus(unusedArgs);
 		if (!calculus)
 			return;
@@ -78,7 +102,13 @@ SubcommandPathConsistency::~SubcommandPathConsistency() {
 bool SubcommandPathConsistency::parseUnusedArgs() {
 	std::vector<std::string> new_unused;
 
+	bool skip = false;
 	for (size_t i = 0; i < unusedArgs.size(); i++) {
+		if (skip) {
+			skip = false;
+			continue;
+		}
+
 		if (unusedArgs[i] == "-n") {
 			negativeOnly = true;
 			positiveOnly = false;
@@ -94,6 +124,38 @@ bool SubcommandPathConsistency::parseUnusedArgs() {
 		else if (unusedArgs[i] == "-S") {
 			showSolution = true;
 		}
+		else if (unusedArgs[i] == "--composition-cache") {
+			if (i+1 == unusedArgs.size()) {
+				std::cerr << "Missing argument \"--composition-cache\"\n";
+				return false;
+			}
+			skip = true;
+
+			std::stringstream in;
+			in << unusedArgs[i+1];
+			in >> compositionCacheSize;
+		}
+		else if (unusedArgs[i] == "--skip-revisions") {
+			skipRevisions = true;
+		}
+		else if (unusedArgs[i] == "--sparse") {
+			sparse = true;
+		}
+		else if (unusedArgs[i] == "--threads") {
+			if (i+1 == unusedArgs.size()) {
+				std::cerr << "Missing argument \"--threads\"\n";
+				return false;
+			}
+			skip = true;
+
+			std::stringstream in;
+			in << unusedArgs[i+1];
+			in >> threads;
+			if (threads == 0) {
+				std::cerr << "Invalid argument \"--threads " << unusedArgs[i+1] << "\"\n";
+				return false;
+			}
+		}
 		else {
 			new_unused.push_back(unusedArgs[i]);
 		}
@@ -101,6 +163,20 @@ bool SubcommandPathConsistency::parseUnusedArgs() {
 
 	unusedArgs = new_unused;
 
+	if (threads > 1 && compositionCacheSize > 0) {
+		// the composition cache is not safe for concurrent use
+		std::cerr << "Composition cache disabled for \"--threads " << threads << "\"\n";
+		compositionCacheSize = 0;
+	}
+	if (threads > 1 && skipRevisions) {
+		std::cerr << "Revision skipping disabled for \"--threads " << threads << "\"\n";
+		skipRevisions = false;
+	}
+	if (threads > 1 && sparse) {
+		std::cerr << "Multiple threads ignored for \"--sparse\"\n";
+		threads = 1;
+	}
+
 	#ifndef NDEBUG
 	if (!unusedArgs.empty()) {
 		std::cout << "Remaining (unparsed) arguments:\n";
@@ -133,6 +209,36 @@ int SubcommandPathConsistency::run() {
 	return 0;	// no errors
 }
 
+template<class R>
+template<class N>
+void SubcommandPathConsistency::runCoreTemplate<R>::report(const N& csp, const bool consistent) const {
+	if (!consistent) {
+		if (!positiveOnly)
+			std::cout << csp.name << ": 0\n";
+		return;
+	}
+	if (negativeOnly)
+		return;
+
+	std::cout << csp.name << ": 1\n";
+	if (!showSolution)
+		return;
+
+	std::vector<Tuple> edges;
+	csp.getEdges(edges);
+
+	std::cout << csp.getSize()-1 << " " << csp.name << std::endl;
+	for (std::vector<Tuple>::const_iterator it = edges.begin(); it != edges.end(); ++it) {
+		const R rel = csp.getConstraint(it->x, it->y);
+		if (rel != calculus->getUniversalRelation()) {
+			std::cout << it->x << " " << it->y << " ";
+			std::cout << calculus->getCalculus().relationToString(rel.getRelation());
+			std::cout << std::endl;
+		}
+	}
+	std::cout << ".\n";
+}
+
 template<class R>
 int SubcommandPathConsistency::runCoreTemplate<R>::execute(const std::string& name) {
 	assert(calculus);
@@ -148,47 +254,61 @@ int SubcommandPathConsistency::runCoreTemplate<R>::execute(const std::string& na
 
 	bool path_consistent = true;	// TODO: there is no reasonable default value
 
+	// the closure does not depend on the order of the queue: use buckets,
+	// and keep their memory from one network to the next
+	typedef gqrtl::CSP<R, gqrtl::CalculusOperations<R> > GroundedRep;
+	gqrtl::WeightedTripleIterator<R, GroundedRep, BucketQueue> propagation;
+	gqrtl::ParallelTripleIterator<R, GroundedRep, BucketQueue> parallelPropagation(threads);
+	propagation.setRevisionSkipping(skipRevisions);
+
+	typedef gqrtl::ChordalCSP<R, gqrtl::CalculusOperations<R> > ChordalRep;
+	gqrtl::PartialTripleIterator<R, ChordalRep, BucketQueue> partialPropagation;
+
 	CSPSparse* input;
 	while ( (input = r.makeCSP()) != NULL) {
-		Logger groundTime("CSP ground time", 0);
-		groundTime.start();
+		if (sparse) {
+			Logger groundTime("CSP ground time", 0);
+			groundTime.start();
 
-		typedef gqrtl::CSP<R, gqrtl::CalculusOperations<R> > GroundedRep;
-		GroundedRep csp(*input, *calculus);
-		gqrtl::WeightedTripleIterator<R, GroundedRep> propagation;
+			std::vector<Tuple> constrained;
+			for (CSPSparse::const_iterator it = input->begin(); it != input->end(); ++it)
+				constrained.push_back(Tuple(it->first.first, it->first.second));
+			const ChordalGraph graph(input->getSize(), constrained);
+			ChordalRep csp(*input, *calculus, graph);
 
-		groundTime.end();
-		groundTime.postLog("", 1, "CSPs");
+			groundTime.end();
+			groundTime.postLog("", 1, "CSPs");
 
-		path_consistent = (propagation.enforce(csp).empty());
+			chordalEdges += graph.getEdges();
+			fillEdges += graph.getFillEdges();
+			pairs += (graph.getSize()*(graph.getSize()-1))/2;
 
-		if (!path_consistent) {
-			if (!positiveOnly)
-				std::cout << csp.name << ": 0\n";
+			path_consistent = (partialPropagation.enforce(csp).empty());
+			report(csp, path_consistent);
 		}
 		else {
-			if (!negativeOnly) {
-				std::cout << csp.name << ": 1\n";
-				if (showSolution) {
-					std::cout << csp.getSize()-1 << " " << csp.name << std::endl;
-					for (size_t i = 0; i < csp.getSize(); ++i)
-						for (size_t j = i+1; j < csp.getSize(); ++j) {
-							const R& rel = csp.getConstraint(i,j);
-							if (rel != calculus->getUniversalRelation()) {
-								std::cout << i << " " << j << " ";
-								std::cout << calculus->getCalculus().relationToString(rel.getRelation());
-								std::cout << std::endl;
-							}
-						}
-					std::cout << ".\n";
-				}
-			}
+			Logger groundTime("CSP ground time", 0);
+			groundTime.start();
+
+			GroundedRep csp(*input, *calculus);
+
+			groundTime.end();
+			groundTime.postLog("", 1, "CSPs");
+
+			if (threads > 1)
+				path_consistent = (parallelPropagation.enforce(csp).empty());
+			else
+				path_consistent = (propagation.enforce(csp).empty());
+			report(csp, path_consistent);
 		}
 
 		delete input;
 	}
 	i.close();
 
+	revisions += propagation.getRevisions();
+	skippedRevisions += propagation.getSkippedRevisions();
+
 	if (path_consistent)
 		return 1;
 	return 0;
@@ -204,8 +324,8 @@ std::cout << "gqrtl::Calculus build on relations with a maximum of " << R::maxSi
 	Logger groundTime("Calculus ground time", 0);
 	groundTime.start();
 
-	R::init();
 	calculus = new gqrtl::CalculusOperations<R>(c);
+	calculus->setCompositionCacheSize(compositionCacheSize);
 
 	groundTime.end();
 	groundTime.postLog("", 1, "calculi");
@@ -213,26 +333,47 @@ std::cout << "gqrtl::Calculus build on relations with a maximum of " << R::maxSi
 	return true;
 }
 
+template<class R>
+void SubcommandPathConsistency::runCoreTemplate<R>::printStatistics() const {
+	if (calculus)
+		calculus->printStatistics();
+	if (skipRevisions) {
+		const size_t total = revisions + skippedRevisions;
+		std::cout << "\tRevisions; performed=" << revisions;
+		std::cout << ", skipped=" << skippedRevisions;
+		if (total > 0)
+			std::cout << ", skip rate=" << (double) skippedRevisions / (double) total << "\n";
+		else
+			std::cout << ", no skip rate\n";
+		std::cout << std::flush;
+	}
+	if (sparse) {
+		std::cout << "\tChordal graphs; edges=" << chordalEdges;
+		std::cout << ", fill edges=" << fillEdges;
+		std::cout << ", pairs of nodes=" << pairs << "\n";
+		std::cout << std::flush;
+	}
+}
+
 template<class R>
 SubcommandPathConsistency::runCoreTemplate<R>::~runCoreTemplate() {
 	if (!calculus) return;
 	delete calculus;
-	R::clean_up();
 }
 
 bool SubcommandPathConsistency::applyPathConsistency(const std::vector<std::string>& filenames) const {
 	std::vector<runCore*> cores;
 
-	cores.push_back(new runCoreTemplate<gqrtl::Relation8>(positiveOnly, negativeOnly, showSolution));
-	cores.push_back(new runCoreTemplate<gqrtl::Relation16>(positiveOnly, negativeOnly, showSolution));
-	cores.push_back(new runCoreTemplate<gqrtl::Relation32>(positiveOnly, negativeOnly, showSolution));
-	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 1> >(positiveOnly, negativeOnly, showSolution));
-	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 2> >(positiveOnly, negativeOnly, showSolution));
-	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 4> >(positiveOnly, negativeOnly, showSolution));
-	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 5> >(positiveOnly, negativeOnly, showSolution));
-	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 10> >(positiveOnly, negativeOnly, showSolution));
+	cores.push_back(new runCoreTemplate<gqrtl::Relation8>(positiveOnly, negativeOnly, showSolution, compositionCacheSize, threads, skipRevisions, sparse));
+	cores.push_back(new runCoreTemplate<gqrtl::Relation16>(positiveOnly, negativeOnly, showSolution, compositionCacheSize, threads, skipRevisions, sparse));
+	cores.push_back(new runCoreTemplate<gqrtl::Relation32>(positiveOnly, negativeOnly, showSolution, compositionCacheSize, threads, skipRevisions, sparse));
+	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 1> >(positiveOnly, negativeOnly, showSolution, compositionCacheSize, threads, skipRevisions, sparse));
+	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 2> >(positiveOnly, negativeOnly, showSolution, compositionCacheSize, threads, skipRevisions, sparse));
+	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 4> >(positiveOnly, negativeOnly, showSolution, compositionCacheSize, threads, skipRevisions, sparse));
+	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 5> >(positiveOnly, negativeOnly, showSolution, compositionCacheSize, threads, skipRevisions, sparse));
+	cores.push_back(new runCoreTemplate<gqrtl::RelationFixedBitset<size_t, 10> >(positiveOnly, negativeOnly, showSolution, compositionCacheSize, threads, skipRevisions, sparse));
 	// Fallback default code
-	cores.push_back(new runCoreTemplate<Relation>(positiveOnly, negativeOnly, showSolution));
+	cores.push_back(new runCoreTemplate<Relation>(positiveOnly, negativeOnly, showSolution, compositionCacheSize, threads, skipRevisions, sparse));
 
 	size_t core;
 	for(core = 0; core < cores.size(); core++)
@@ -253,6 +394,8 @@ bool SubcommandPathConsistency::applyPathConsistency(const std::vector<std::stri
 
 	long int total_ms = std::labs(start.msec_passed(Timer()));
 	std::cout << "CSPs processing time: " << ((double) total_ms) / 1000.0 << " seconds" << std::endl;
+	if (verbose > 0)
+		cores[core]->printStatistics();
 
 	for (size_t c = 0; c < cores.size(); c++) delete cores[c];
 	return lastState;
@@ -44,6 +44,14 @@ class SubcommandPathConsistency: public SubcommandAbstract {
 
 		bool returnState;
 
+		size_t compositionCacheSize;
+
+		size_t threads;
+
+		bool skipRevisions;
+
+		bool sparse;
+
 		Calculus* calculus;
 
 		class runCore {
@@ -51,22 +59,35 @@ class SubcommandPathConsistency: public SubcommandAbstract {
 				bool positiveOnly;
 				bool negativeOnly;
 				bool showSolution;
+				size_t compositionCacheSize;
+				size_t threads;
+				bool skipRevisions;
+				bool sparse;
 			public:
-				runCore(const bool p, const bool n, const bool s) : positiveOnly(p), negativeOnly(n), showSolution(s) {}
+				runCore(const bool p, const bool n, const bool s, const size_t c, const size_t t, const bool r, const bool sp) : positiveOnly(p), negativeOnly(n), showSolution(s), compositionCacheSize(c), threads(t), skipRevisions(r), sparse(sp) {}
 				virtual ~runCore() {}
 				virtual int execute(const std::string&) = 0;
 				virtual bool ground(const Calculus& c) = 0;
+				virtual void printStatistics() const = 0;
 		};
 
 		template<class R>
 		class runCoreTemplate : public runCore {
 			private:
 				gqrtl::CalculusOperations<R>* calculus;
+				size_t revisions, skippedRevisions;
+				/** Edges of all chordal graphs (--sparse), the fill edges among them, and all pairs of nodes */
+				size_t chordalEdges, fillEdges, pairs;
+
+				/** Print the result of enforcing path consistency to csp */
+				template<class N>
+				void report(const N& csp, const bool consistent) const;
 			public:
-				runCoreTemplate(const bool a, const bool b, const bool s) : runCore(a,b,s), calculus(NULL) {};
+				runCoreTemplate(const bool a, const bool b, const bool s, const size_t c, const size_t t, const bool r, const bool sp) : runCore(a,b,s,c,t,r,sp), calculus(NULL), revisions(0), skippedRevisions(0), chordalEdges(0), fillEdges(0), pairs(0) {};
 				virtual ~runCoreTemplate();
 				virtual int execute(const std::string&);
 				virtual bool ground(const Calculus& c);
+				virtual void printStatistics() const;
 		};
 
 		bool applyPathConsistency(const std::vector<std::string>& filenames) const;
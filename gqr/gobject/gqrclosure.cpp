@@ -0,0 +1,107 @@
+/*
+ * gqrclosure.cpp
+ */
+
+#include <cstring>
+#include <stdlib.h>
+
+#include "gqrclosure.h"
+#include "gqrcsp.h"
+
+extern "C" {
+G_DEFINE_TYPE(GqrClosure, gqr_closure, G_TYPE_OBJECT)
+}
+
+/*
+ * Private member stuff
+ */
+#define GQR_CLOSURE_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GQR_TYPE_CLOSURE, GqrClosurePrivate))
+
+struct _GqrClosurePrivate
+{
+    GQR_Closure *closure;
+};
+
+
+/*
+ * Constructor
+ */
+static void gqr_closure_init(GqrClosure *self)
+{
+    self->priv = GQR_CLOSURE_GET_PRIVATE(self);
+    self->priv->closure = 0;
+}
+
+/*
+ * Destructor
+ */
+static void gqr_closure_finalize(GObject *gobject)
+{
+    GqrClosure *self = GQR_CLOSURE(gobject);
+
+    delete self->priv->closure;
+
+    /* Chain up to the parent class */
+    G_OBJECT_CLASS (gqr_closure_parent_class)->finalize(gobject);
+}
+
+static void gqr_closure_class_init(GqrClosureClass *klass)
+{
+    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+    gobject_class->finalize = gqr_closure_finalize;
+
+    g_type_class_add_private(klass, sizeof(GqrClosurePrivate));
+}
+
+/*
+ * Methods
+ */
+
+void gqr_closure_unref(GqrClosure *self) {
+    g_object_unref(self);
+}
+
+int gqr_closure_get_size(GqrClosure *self) {
+    return self->priv->closure->getSize();
+}
+
+bool gqr_closure_is_consistent(GqrClosure *self) {
+    return self->priv->closure->is_consistent();
+}
+
+// tighten a constraint and propagate
+bool gqr_closure_add_constraint(GqrClosure *self, int i, int j, char *relation) {
+    return self->priv->closure->add_constraint(i, j, std::string(relation));
+}
+
+int gqr_closure_checkpoint(GqrClosure *self) {
+    return self->priv->closure->checkpoint();
+}
+
+bool gqr_closure_rollback(GqrClosure *self, int id) {
+    return self->priv->closure->rollback(id);
+}
+
+// read constraint
+char *gqr_closure_get_constraint(GqrClosure *self, int i, int j) {
+    const std::string c = self->priv->closure->get_constraint(i, j);
+    char const *s = c.c_str();
+    size_t slen = strlen(s);
+    char *result = (char *) malloc(slen + 1);
+    std::strcpy(result, s);
+    return result;
+}
+
+GqrCsp *gqr_closure_get_csp(GqrClosure *self) {
+    return gqr_csp_new_from_csp(self->priv->closure->get_csp());
+}
+
+GqrClosure *gqr_closure_new_from_closure(GQR_Closure *closure) {
+    if (closure) {
+        GqrClosure *_closure = (GqrClosure *)g_object_new(GQR_TYPE_CLOSURE, NULL);
+        _closure->priv->closure = closure;
+        return _closure;
+    } else {
+        return 0;
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * gqrclosure.h
+ */
+
+#ifndef GQRCLOSURE_H_
+#define GQRCLOSURE_H_
+
+#include <glib-object.h>
+#include <gobject/gqrcsp.h>
+
+
+#ifndef __cplusplus
+
+#include <stdbool.h>
+
+#else
+
+#include "gqr_wrap.h"
+
+
+extern "C" {
+#endif
+
+/*
+ * Typedef common macros
+ */
+#define GQR_TYPE_CLOSURE (gqr_closure_get_type())
+#define GQR_CLOSURE(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), GQR_TYPE_CLOSURE, GqrClosure))
+#define GQR_IS_CLOSURE(obj)               (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GQR_TYPE_CLOSURE))
+#define GQR_CLOSURE_CLASS(klass)          (G_TYPE_CHECK_CLASS_CAST ((klass), GQR_TYPE_CLOSURE, GqrClosureClass))
+#define GQR_IS_CLOSURE_CLASS(klass)       (G_TYPE_CHECK_CLASS_TYPE ((klass), GQR_TYPE_CLOSURE))
+#define GQR_CLOSURE_GET_CLASS(obj)        (G_TYPE_INSTANCE_GET_CLASS ((obj), GQR_TYPE_CLOSURE, GqrClosureClass))
+
+typedef struct _GqrClosure        GqrClosure;
+typedef struct _GqrClosureClass   GqrClosureClass;
+typedef struct _GqrClosurePrivate GqrClosurePrivate;
+
+struct _GqrClosure
+{
+  GObject parent_instance;
+
+  /* instance members */
+  GqrClosurePrivate *priv;
+};
+
+struct _GqrClosureClass
+{
+  GObjectClass parent_class;
+
+  /* class members */
+};
+
+
+/*
+ * Methods
+ */
+
+/* An a-closed network that is refined one constraint at a time; created by
+   gqr_solver_new_closure. Each update propagates only from the tightened
+   constraint. */
+
+/* delete closure */
+void gqr_closure_unref(GqrClosure *self);
+
+/* read size of the network */
+int gqr_closure_get_size(GqrClosure *self);
+
+/* returns false once an empty relation has been inferred; the network is not
+   changed any more until it is rolled back to a checkpoint */
+bool gqr_closure_is_consistent(GqrClosure *self);
+
+/* tighten constraint (i,j) and enforce algebraic closure from it; returns
+   gqr_closure_is_consistent */
+bool gqr_closure_add_constraint(GqrClosure *self, int i, int j, char *relation);
+
+/* remember the current network; returns the id of the checkpoint */
+int gqr_closure_checkpoint(GqrClosure *self);
+
+/* restore the network of checkpoint "id", which is removed together with all
+   later checkpoints (returns false if there is no such checkpoint) */
+bool gqr_closure_rollback(GqrClosure *self, int id);
+
+/* read constraint from the network */
+char *gqr_closure_get_constraint(GqrClosure *self, int i, int j);
+
+/* return a copy of the current network */
+GqrCsp *gqr_closure_get_csp(GqrClosure *self);
+
+
+
+#ifdef __cplusplus
+
+}
+
+// wrap an existing C++ instance to GType Closure
+GqrClosure *gqr_closure_new_from_closure(GQR_Closure *closure);
+
+#endif
+
+#endif /* GQRCLOSURE_H_ */
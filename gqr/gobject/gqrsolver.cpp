@@ -10,6 +10,7 @@
 
 #include "gqrsolver.h"
 #include "gqrcsp.h"
+#include "gqrclosure.h"
 
 extern "C" {
 G_DEFINE_TYPE(GqrSolver, gqr_solver, G_TYPE_OBJECT)
@@ -79,12 +80,23 @@ bool gqr_solver_set_tractable_subclass(GqrSolver *self, char *algFilename) {
     return self->priv->solver->set_tractable_subclass(std::string(algFilename));
 }
 
+// number of threads used to enforce algebraic closure
+void gqr_solver_set_threads(GqrSolver *self, unsigned int threads) {
+    self->priv->solver->set_threads(threads);
+}
+
 // return false if revised CSP contains empty relations
 bool gqr_solver_enforce_algebraic_closure(GqrSolver *self, GqrCsp *i) {
     GQR_CSP *in = gqr_csp_get_csp(i);
     return self->priv->solver->enforce_algebraic_closure(*in);
 }
 
+// return an a-closed copy of input that can be refined incrementally
+GqrClosure* gqr_solver_new_closure(GqrSolver *self, GqrCsp *input) {
+    GQR_CSP *in = gqr_csp_get_csp(input);
+    return gqr_closure_new_from_closure(self->priv->solver->new_closure(*in));
+}
+
 // calculate and return an a-closed sub-csp (atomic or tractable)
 GqrCsp* gqr_solver_get_scenario(GqrSolver *self, GqrCsp *input) {
     GQR_CSP *in = gqr_csp_get_csp(input);
@@ -12,6 +12,7 @@
 #include <glib-object.h>
 #include "gqrcalculus.h"
 #include "gqrcsp.h"
+#include "gqrclosure.h"
 
 #ifndef __cplusplus
 
@@ -68,10 +69,18 @@ void gqr_solver_unref(GqrSolver *self);
 /* chain instance to a specific tractable subclass (returns true on success) */
 bool gqr_solver_set_tractable_subclass(GqrSolver *self, char *algFilename);
 
+/* number of threads used by gqr_solver_enforce_algebraic_closure (default 1);
+   the result does not depend on it */
+void gqr_solver_set_threads(GqrSolver *self, unsigned int threads);
+
 /* enforce algebraic closure on csp: aborts and returns false once an empty
    relation has been inferred; returns true if network is now a-closed. */
 bool gqr_solver_enforce_algebraic_closure(GqrSolver *self, GqrCsp *i);
 
+/* return an a-closed copy of input that can be refined incrementally, see
+   gqrclosure.h; the solver must not be deleted before the copy */
+GqrClosure* gqr_solver_new_closure(GqrSolver *self, GqrCsp *input);
+
 /* calculate and return an a-closed sub-csp (atomic or tractable relations;
    depending on whether a tractable subclass has been loaded) */
 GqrCsp* gqr_solver_get_scenario(GqrSolver *self, GqrCsp *input);
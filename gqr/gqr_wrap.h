@@ -33,12 +33,9 @@
 #include "gqrtl/CSP.h"
 #include "gqrtl/CalculusOperations.h"
 #include "gqrtl/WeightedTripleIterator.h"
+#include "gqrtl/ParallelTripleIterator.h"
 #include "gqrtl/DFS.h"
-
-static bool initialized_relation_class_1 = false;
-static bool initialized_relation_class_2 = false;
-static bool initialized_relation_class_3 = false;
-static bool initialized_relation_class_4 = false;
+#include "gqrtl/IncrementalClosure.h"
 
 static std::string strip_relation_string(std::string s) {
     if (s.size() < 2)
@@ -179,6 +176,73 @@ class GQR_CSP {
 };
 
 
+// a-closed network that is refined one constraint at a time
+class GQR_Closure {
+    public:
+    virtual ~GQR_Closure() {}
+
+    virtual int getSize() const = 0;
+    // false once an empty relation has been inferred
+    virtual bool is_consistent() const = 0;
+    // tighten constraint (i,j) and propagate from it; returns is_consistent()
+    virtual bool add_constraint(const int i, const int j, const std::string relation) = 0;
+    // remember the current state and return its id
+    virtual int checkpoint() = 0;
+    // restore the state of checkpoint id, discarding it and all later ones
+    virtual bool rollback(const int id) = 0;
+    virtual std::string get_constraint(const int i, const int j) const = 0;
+    // copy of the current network
+    virtual GQR_CSP* get_csp() const = 0;
+};
+
+template<class R>
+class GQR_ClosureTemplate : public GQR_Closure {
+    private:
+    GQR_Calculus& calculus;
+    gqrtl::IncrementalClosure<R, gqrtl::CalculusOperations<R> > closure;
+
+    bool valid(const int i, const int j) const {
+        return i >= 0 && j >= 0 && (size_t) i < closure.getSize() && (size_t) j < closure.getSize();
+    }
+
+    public:
+    GQR_ClosureTemplate(const GQR_CSP& input, gqrtl::CalculusOperations<R>& c) : calculus(input.calculus),
+    closure(gqrtl::CSP<R, gqrtl::CalculusOperations<R> >(*input.csp, c)) {}
+
+    int getSize() const { return closure.getSize(); }
+
+    bool is_consistent() const { return closure.isConsistent(); }
+
+    bool add_constraint(const int i, const int j, const std::string relation) {
+        if (!valid(i, j))
+            return false;
+        const Relation r = calculus.calculus->encodeRelation(strip_relation_string(relation));
+        return closure.addConstraint((size_t) i, (size_t) j, R(r));
+    }
+
+    int checkpoint() { return closure.checkpoint(); }
+
+    bool rollback(const int id) {
+        if (id < 0)
+            return false;
+        return closure.rollback((size_t) id);
+    }
+
+    std::string get_constraint(const int i, const int j) const {
+        if (!valid(i, j))
+            return "";
+        return calculus.calculus->relationToString(closure.getConstraint((size_t) i, (size_t) j).getRelation());
+    }
+
+    GQR_CSP* get_csp() const {
+        GQR_CSP* result = new GQR_CSP(closure.getSize(), calculus);
+        for (size_t i = 0; i < closure.getSize(); i++)
+            for (size_t j = i; j < closure.getSize(); j++)
+                result->csp->setConstraint(i, j, closure.getConstraint(i, j).getRelation());
+        return result;
+    }
+};
+
 // GQR Functionality
 class GQR_Solver {
     public:
@@ -189,9 +253,25 @@ class GQR_Solver {
     gqrtl::CalculusOperations<gqrtl::Relation16>* c2;
     gqrtl::CalculusOperations<gqrtl::Relation32>* c3;
     gqrtl::CalculusOperations<gqrtl::RelationFixedBitset<size_t, 10> >* c4;
+    // fallback, only grounded for new_closure
+    gqrtl::CalculusOperations<Relation>* c0;
+
+    // threads used to enforce algebraic closure
+    size_t threads;
 
     GQR_Solver(GQR_Calculus& calc) : calculus(*calc.calculus),
-    c1(NULL), c2(NULL), c3(NULL), c4(NULL) {}
+    c1(NULL), c2(NULL), c3(NULL), c4(NULL), c0(NULL), threads(1) {}
+
+    void set_threads(const size_t t) { threads = (t > 0 ? t : 1); }
+
+    // enforce algebraic closure on c with the configured number of threads
+    template<class R, class N>
+    bool close(N& c) const {
+        if (threads > 1)
+            return gqrtl::ParallelTripleIterator<R, N>(threads).enforce(c).empty();
+        gqrtl::WeightedTripleIterator<R, N> prop;
+        return prop.enforce(c).empty();
+    }
 
     void ground_calculus() {
         if (c1 != NULL) return;
@@ -200,35 +280,19 @@ class GQR_Solver {
         if (c4 != NULL) return;
 
         if (calculus.getNumberOfBaseRelations() <= 8) {
-            if (!initialized_relation_class_1) {
-                initialized_relation_class_1 = true;
-                gqrtl::Relation8::init();
-            }
             c1 = new gqrtl::CalculusOperations<gqrtl::Relation8>(calculus);
         }
         else if (calculus.getNumberOfBaseRelations() <= 16) {
-            if (!initialized_relation_class_2) {
-                initialized_relation_class_2 = true;
-                gqrtl::Relation16::init();
-            }
             c2 = new gqrtl::CalculusOperations<gqrtl::Relation16>(calculus);
         }
         else if (calculus.getNumberOfBaseRelations() <= 32) {
-            if (!initialized_relation_class_3) {
-                initialized_relation_class_3 = true;
-                gqrtl::Relation32::init();
-            }
             c3 = new gqrtl::CalculusOperations<gqrtl::Relation32>(calculus);
         }
         else if (calculus.getNumberOfBaseRelations() <= 10*gqrtl::RelationFixedBitset<size_t, 10>::maxSize()) {
-            if (!initialized_relation_class_4) {
-                initialized_relation_class_4 = true;
-                gqrtl::RelationFixedBitset<size_t, 10>::init();
-            }
             c4 = new gqrtl::CalculusOperations<gqrtl::RelationFixedBitset<size_t, 10> >(calculus);
         }
     }
-    ~GQR_Solver() { delete c1; delete c2; delete c3; delete c4; }
+    ~GQR_Solver() { delete c1; delete c2; delete c3; delete c4; delete c0; }
 
     // chain instance to a specific tractable subclass (returns true on success)
     bool set_tractable_subclass(const std::string algFilename) {
@@ -258,9 +322,7 @@ class GQR_Solver {
 
         if (c1 != NULL) {
             gqrtl::CSP<gqrtl::Relation8, gqrtl::CalculusOperations<gqrtl::Relation8> > c(*input.csp, *c1);
-            gqrtl::WeightedTripleIterator<gqrtl::Relation8, gqrtl::CSP<gqrtl::Relation8, gqrtl::CalculusOperations<gqrtl::Relation8> > >
-                prop;
-            ret = prop.enforce(c).empty();
+            ret = close<gqrtl::Relation8>(c);
 
             for (size_t i = 0; i < c.getSize(); i++)
                 for (size_t j = i; j < c.getSize(); j++)
@@ -268,9 +330,7 @@ class GQR_Solver {
         }
         else if (c2 != NULL) {
             gqrtl::CSP<gqrtl::Relation16, gqrtl::CalculusOperations<gqrtl::Relation16> > c(*input.csp, *c2);
-            gqrtl::WeightedTripleIterator<gqrtl::Relation16, gqrtl::CSP<gqrtl::Relation16, gqrtl::CalculusOperations<gqrtl::Relation16> > >
-                prop;
-            ret = prop.enforce(c).empty();
+            ret = close<gqrtl::Relation16>(c);
 
             for (size_t i = 0; i < c.getSize(); i++)
                 for (size_t j = i; j < c.getSize(); j++)
@@ -278,9 +338,7 @@ class GQR_Solver {
         }
         else if (c3 != NULL) {
             gqrtl::CSP<gqrtl::Relation32, gqrtl::CalculusOperations<gqrtl::Relation32> > c(*input.csp, *c3);
-            gqrtl::WeightedTripleIterator<gqrtl::Relation32, gqrtl::CSP<gqrtl::Relation32, gqrtl::CalculusOperations<gqrtl::Relation32> > >
-                prop;
-            ret = prop.enforce(c).empty();
+            ret = close<gqrtl::Relation32>(c);
 
             for (size_t i = 0; i < c.getSize(); i++)
                 for (size_t j = i; j < c.getSize(); j++)
@@ -288,23 +346,38 @@ class GQR_Solver {
         }
         else if (c4 != NULL) {
             gqrtl::CSP<gqrtl::RelationFixedBitset<size_t, 10>, gqrtl::CalculusOperations<gqrtl::RelationFixedBitset<size_t, 10> > > c(*input.csp, *c4);
-            gqrtl::WeightedTripleIterator<gqrtl::RelationFixedBitset<size_t, 10>, gqrtl::CSP<gqrtl::RelationFixedBitset<size_t, 10>, gqrtl::CalculusOperations<gqrtl::RelationFixedBitset<size_t, 10> > > >
-                prop;
-            ret = prop.enforce(c).empty();
+            ret = close<gqrtl::RelationFixedBitset<size_t, 10> >(c);
 
             for (size_t i = 0; i < c.getSize(); i++)
                 for (size_t j = i; j < c.getSize(); j++)
                     input.csp->setConstraint(i,j, c.getConstraint(i,j).getRelation());
         }
         else {
-            gqrtl::WeightedTripleIterator<Relation, gqrtl::CSP<Relation, Calculus> > prop;
-
-            ret = prop.enforce(*input.csp).empty();
+            ret = close<Relation>(*input.csp);
         }
 
         return ret;
     }
 
+    // return an a-closed copy of input that can be refined incrementally;
+    // the solver must outlive the copy
+    GQR_Closure* new_closure(const GQR_CSP& input) {
+        ground_calculus();
+
+        if (c1 != NULL)
+            return new GQR_ClosureTemplate<gqrtl::Relation8>(input, *c1);
+        if (c2 != NULL)
+            return new GQR_ClosureTemplate<gqrtl::Relation16>(input, *c2);
+        if (c3 != NULL)
+            return new GQR_ClosureTemplate<gqrtl::Relation32>(input, *c3);
+        if (c4 != NULL)
+            return new GQR_ClosureTemplate<gqrtl::RelationFixedBitset<size_t, 10> >(input, *c4);
+
+        if (c0 == NULL)
+            c0 = new gqrtl::CalculusOperations<Relation>(calculus);
+        return new GQR_ClosureTemplate<Relation>(input, *c0);
+    }
+
     // calculate and return an a-closed sub-csp (atomic or tractable)
     GQR_CSP* get_scenario(const GQR_CSP& input) {
         ground_calculus();
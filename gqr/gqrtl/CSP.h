@@ -24,11 +24,14 @@
 #ifndef SIMPLE_CSP_H
 #define SIMPLE_CSP_H
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <cassert>
 
 #include "CSPSparse.h"
+#include "Tuple.h"
+#include "gqrtl/CSPMatrix.h"
 
 // for conversion constructor
 class Calculus;
@@ -39,22 +42,24 @@ namespace gqrtl {
 /**
  * Class representing a binary constraint satisfaction problem (CSP).
  * It does not manage any kind of trailing.
+ * The edges are stored in a matrix M, see CSPMatrix.h.
  */
-template<class R, class C>
+template<class R, class C, class M = typename DefaultMatrix<R>::type>
 class CSP {
 	private:
 		/** Reference to underlying calculus representing the qualitative calculus the CSP is formulated in. */
 		const C& calculus;
 
-		/** Vector representing a two dimensional array containing the edges between variables. */
-		std::vector<R> matrix;
+		/** Two dimensional array containing the edges between variables. */
+		M matrix;
 
 		/** Number of nodes in the CSP */
 		const size_t size;
 
-		inline size_t getPos(const size_t x, const size_t y) const { return x*size+y; }
-
 	public:
+		/** Return type of getConstraint: a reference or, if the matrix computes the edge, a value */
+		typedef typename M::const_reference const_reference;
+
 		/**
 		* String containing the name (e.g, parameters used to generate the CSP)
 		*/
@@ -70,12 +75,12 @@ class CSP {
 			assert(size > 1);
 
 			// labels between different nodes contain the universal relation:
-			matrix = std::vector<R>(size*size, calculus.getUniversalRelation());
+			matrix.init(size, calculus.getUniversalRelation());
 
 			// initialize diagonal label (edge) values:
 			for (size_t i = 0; i < size; ++i) {
 				/// labels between the same node contain the identity relation:
-				matrix[getPos(i,i)] = calculus.getIdentityRelation();
+				setConstraint(i, i, calculus.getIdentityRelation());
 			}
 		}
 
@@ -83,7 +88,7 @@ class CSP {
 		CSP(const CSPSparse& csp, const C& nc) : calculus(nc), size(csp.getSize()),
 			name(csp.name) {
 
-			matrix.resize(size*size, calculus.getUniversalRelation());
+			matrix.init(size, calculus.getUniversalRelation());
 			for (CSPSparse::const_iterator it = csp.begin(); it != csp.end(); ++it) {
 				const std::pair<size_t, size_t>& var = it->first;
 				const Relation& r = it->second;
@@ -95,7 +100,7 @@ class CSP {
 		CSP(const CSP<Relation, Calculus>& csp, C& nc) : calculus(nc), size(csp.getSize()),
 			name(csp.name) {
 
-			matrix.resize(size*size);
+			matrix.init(size, R());
 			for (size_t i = 0; i < size; ++i)
 				for (size_t j = i; j < size; ++j)
 					setConstraint(i, j, R(csp.getConstraint(i,j)));
@@ -108,16 +113,13 @@ class CSP {
 		* @param y another node
 		* @param r the relation between node x and node y
 		*/
-		void setConstraint(const size_t x, const size_t y, const R r) {
-			matrix[getPos(x,y)] = r;
-			matrix[getPos(y,x)] = calculus.getConverse(r);
+		inline void setConstraint(const size_t x, const size_t y, const R r) {
+			matrix.set(x, y, r, calculus);
 		}
 
 		/** Get a constraint @param x a node @param y another node @return the relation between x and y */
-		inline const R& getConstraint(const size_t x, const size_t y) const {
-			// network should be normalized
-			assert(matrix[getPos(y,x)] == calculus.getConverse(matrix[getPos(x,y)]));
-			return matrix[getPos(x,y)];
+		inline const_reference getConstraint(const size_t x, const size_t y) const {
+			return matrix.get(x, y, calculus);
 		}
 
 		/** Get the size of the CSP @return the number of nodes in the CSP */
@@ -126,8 +128,23 @@ class CSP {
 		/** Get reference to Calculus object */
 		const C& getCalculus() const { return calculus; }
 
+		/** Append the edges (x,y), x < y, of the network to edges: all pairs of nodes */
+		void getEdges(std::vector<Tuple>& edges) const {
+			for (size_t i = 0; i < size; ++i)
+				for (size_t j = i+1; j < size; ++j)
+					edges.push_back(Tuple(i, j));
+		}
+
+		/** Number of edges (x,y), x <= y, used to index data per edge by getEdgePosition */
+		size_t getEdgePositions() const { return (size*(size+1))/2; }
+		inline size_t getEdgePosition(size_t x, size_t y) const {
+			if (x > y)
+				std::swap(x, y);
+			return y + x*size - (x*(x+1))/2;
+		}
+
 		/** Equality operator. Two CSPs are equal if they have the same size, reference the same calculus and feature the same constraints */
-		inline bool operator== (const CSP<R, C>& b) const {
+		inline bool operator== (const CSP<R, C, M>& b) const {
 			if (size == b.size
 				&& calculus == b.calculus
 				&& matrix == b.matrix)
@@ -0,0 +1,211 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef CSP_MATRIX_H
+#define CSP_MATRIX_H
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace gqrtl {
+
+/**
+ * Storage policies for the constraint matrix of gqrtl::CSP.
+ *
+ * A matrix is initialized by init() and accessed by get() and set(), which
+ * receive the calculus to compute converses. The type returned by get() is
+ * const_reference; code that keeps it across a set() must copy it.
+ */
+
+/**
+ * Index policies of FullMatrix: map (x,y) to the position of the edge.
+ * init(size) is called before the first access; elements() is the number of
+ * positions needed for a network of that size.
+ */
+
+/** Row-major order, (x,y) at x*size+y */
+class RowMajorIndex {
+	private:
+		size_t size;
+
+	public:
+		RowMajorIndex() : size(0) {}
+
+		void init(const size_t s) { size = s; }
+		size_t elements() const { return size*size; }
+
+		inline size_t operator()(const size_t x, const size_t y) const { return x*size+y; }
+};
+
+/**
+ * Square tiles of 2^TileBits * 2^TileBits edges, tiles and the edges within
+ * a tile in row-major order. A column of a tile shares its cache lines with
+ * the neighbouring columns, hence column-wise scans as in path consistency
+ * load fewer lines than in row-major order.
+ */
+template<size_t TileBits = 4>
+class TiledIndex {
+	private:
+		static const size_t tileMask = (1 << TileBits) - 1;
+		size_t tilesPerRow;
+
+	public:
+		TiledIndex() : tilesPerRow(0) {}
+
+		void init(const size_t s) { tilesPerRow = (s + tileMask) >> TileBits; }
+		size_t elements() const { return (tilesPerRow*tilesPerRow) << (2*TileBits); }
+
+		inline size_t operator()(const size_t x, const size_t y) const {
+			const size_t tile = (x >> TileBits) * tilesPerRow + (y >> TileBits);
+			return (tile << (2*TileBits)) | ((x & tileMask) << TileBits) | (y & tileMask);
+		}
+};
+
+/**
+ * Z-order (Morton) curve: the bits of x and y are interleaved. Rows and columns
+ * are local on every scale, at the price of padding the matrix to the next power
+ * of two. Supports networks of up to 2^16 nodes.
+ */
+class MortonIndex {
+	private:
+		size_t side;
+
+		/** Spread the lower 16 bit of v to the even bit positions */
+		static inline size_t spread(size_t v) {
+			v = (v | (v << 8)) & 0x00ff00ffUL;
+			v = (v | (v << 4)) & 0x0f0f0f0fUL;
+			v = (v | (v << 2)) & 0x33333333UL;
+			v = (v | (v << 1)) & 0x55555555UL;
+			return v;
+		}
+
+	public:
+		MortonIndex() : side(0) {}
+
+		void init(const size_t s) {
+			assert(s <= (1 << 16));
+			for (side = 1; side < s; side <<= 1) ;
+		}
+		size_t elements() const { return side*side; }
+
+		inline size_t operator()(const size_t x, const size_t y) const { return (spread(x) << 1) | spread(y); }
+};
+
+/**
+ * Full matrix, position of the edges given by the index policy I. Both (x,y)
+ * and its converse (y,x) are stored, hence every write computes a converse
+ * but reads are plain loads.
+ */
+template<class R, class I = RowMajorIndex>
+class FullMatrix {
+	private:
+		std::vector<R> matrix;
+		I getPos;
+
+	public:
+		typedef const R& const_reference;
+
+		void init(const size_t s, const R& universal) {
+			getPos.init(s);
+			matrix.assign(getPos.elements(), universal);
+		}
+
+		template<class C>
+		inline void set(const size_t x, const size_t y, const R& r, const C& calculus) {
+			matrix[getPos(x,y)] = r;
+			matrix[getPos(y,x)] = calculus.getConverse(r);
+		}
+
+		template<class C>
+		inline const_reference get(const size_t x, const size_t y, const C& calculus) const {
+			// network should be normalized
+			assert(matrix[getPos(y,x)] == calculus.getConverse(matrix[getPos(x,y)]));
+			(void) calculus;
+			return matrix[getPos(x,y)];
+		}
+
+		inline bool operator==(const FullMatrix& b) const { return matrix == b.matrix; }
+};
+
+/**
+ * Upper triangle (including the diagonal) of the matrix, stored row by row.
+ * Only (x,y) with x <= y is stored; the lower triangle is the converse of the
+ * upper one and computed on demand by the precomputed converse of the calculus.
+ * Needs about half the memory of FullMatrix; writes to the upper triangle
+ * compute no converse at all.
+ */
+template<class R>
+class TriangularMatrix {
+	private:
+		std::vector<R> matrix;
+		size_t size;
+
+		/** Position of (x,y), x <= y: rows 0..x-1 hold size, size-1, ..., size-x+1 entries */
+		inline size_t getPos(const size_t x, const size_t y) const {
+			assert(x <= y);
+			return x*(2*size-x-1)/2 + y;
+		}
+
+	public:
+		typedef R const_reference;
+
+		TriangularMatrix() : size(0) {}
+
+		void init(const size_t s, const R& universal) {
+			size = s;
+			matrix.assign(size*(size+1)/2, universal);
+		}
+
+		template<class C>
+		inline void set(const size_t x, const size_t y, const R& r, const C& calculus) {
+			if (x <= y)
+				matrix[getPos(x,y)] = r;
+			else
+				matrix[getPos(y,x)] = calculus.getConverse(r);
+		}
+
+		template<class C>
+		inline const_reference get(const size_t x, const size_t y, const C& calculus) const {
+			if (x <= y)
+				return matrix[getPos(x,y)];
+			return calculus.getConverse(matrix[getPos(y,x)]);
+		}
+
+		inline bool operator==(const TriangularMatrix& b) const { return matrix == b.matrix; }
+};
+
+/** Matrix used by CSP unless given explicitly, selected by configure --csp-layout */
+template<class R>
+struct DefaultMatrix {
+#if defined(GQR_CSP_TRIANGULAR)
+	typedef TriangularMatrix<R> type;
+#elif defined(GQR_CSP_TILED)
+	typedef FullMatrix<R, TiledIndex<> > type;
+#elif defined(GQR_CSP_MORTON)
+	typedef FullMatrix<R, MortonIndex> type;
+#else
+	typedef FullMatrix<R> type;
+#endif
+};
+
+}
+
+#endif // CSP_MATRIX_H
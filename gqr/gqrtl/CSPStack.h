@@ -21,9 +21,10 @@
 #ifndef CSPSTACK_H
 #define CSPSTACK_H
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
 #include <vector>
-#include <list>
 
 #include "Tuple.h"
 #include "gqrtl/CSP.h"
@@ -31,59 +32,116 @@
 namespace gqrtl {
 
 /**
- * Template class representing a stack of CSPs.
+ * Template class representing a stack of CSPs. The network N is a CSP or any
+ * class with the same interface, e.g., ChordalCSP.
+ *
+ * The states are kept on one contiguous trail: every level records the value
+ * an edge had before its first change at that level; later changes of the
+ * same edge are not trailed again. A level is a position in the trail plus the
+ * stamp marking its trailed edges. The trail keeps its capacity, hence a search
+ * allocates it only while it grows.
+ *
+ * After trackChanges() the stack also records which edges were changed,
+ * including the changes undone by a reset, until clearChanges().
  */
-template<class R, class C>
+template<class R, class C, class N = CSP<R, C> >
 class CSPStack {
 	private:
-		CSP<R, C> csp;
+		N csp;
 
+		/** Edge and its value at the start of the level */
 		typedef std::pair<Tuple, R> change;
-		std::list<std::vector<change> > trail;
+		std::vector<change> trail;
+
+		/** Position in the trail and stamp of every level */
+		std::vector<std::pair<size_t, unsigned int> > levels;
+		/** Stamp of the level that last trailed an edge, by getEdgePosition */
+		std::vector<unsigned int> trailed;
+		/** Last stamp given to a level */
+		unsigned int stamp;
+
+		/** Changed edges, each once, and whether an edge position is among them; empty if not tracked */
+		std::vector<Tuple> changes;
+		std::vector<bool> changed;
+
+		inline void updateTrail(const Tuple t, const size_t pos) {
+			if (levels.empty()) return;
+
+			unsigned int& s = trailed[pos];
+			if (s == levels.back().second)
+				return;
+			s = levels.back().second;
+			trail.push_back(std::make_pair(t, R(csp.getConstraint(t.x, t.y))));
+		}
+
+		/** Stamps ran out: forget all trailed edges, number the levels anew */
+		void resetStamps() {
+			std::fill(trailed.begin(), trailed.end(), 0);
+			for (size_t l = 0; l < levels.size(); l++)
+				levels[l].second = l+1;
+			stamp = levels.size()+1;
+		}
 
-		inline void updateTrail(const Tuple t, const R& o, const R& n) {
-			if (trail.empty()) return;
+		inline void recordChange(const Tuple t, const size_t pos) {
+			if (changed.empty() || changed[pos]) return;
 
-			const R diff = o & csp.getCalculus().getNegation(n);
-			trail.back().push_back(std::make_pair(t, diff));
+			changed[pos] = true;
+			changes.push_back(t);
 		}
 
 	public:
-		CSPStack(const CSP<R, C>& input) : csp(input) {}
+		CSPStack(const N& input) : csp(input), trailed(csp.getEdgePositions(), 0), stamp(0) {}
 
 		// remember current state for trailing
 		inline void backupState() {
-			trail.push_back(std::vector<change>());
+			if (++stamp == 0)
+				resetStamps();
+			levels.push_back(std::make_pair(trail.size(), stamp));
 		}
 
 		// set a value
 		inline void setValue(const Tuple& var, const R r) {
-			updateTrail(var, csp.getConstraint(var.x, var.y), r);
+			const size_t pos = csp.getEdgePosition(var.x, var.y);
+			updateTrail(var, pos);
+			recordChange(var, pos);
 
 			csp.setConstraint(var.x, var.y, r);
 		}
 		inline void setConstraint(const size_t i, const size_t j, const R r) { return setValue(Tuple(i,j), r); }
 
 		void resetToLastState() {
-			assert(!trail.empty());
-
-			for (typename std::vector<change>::const_iterator it = trail.back().begin();
-				it != trail.back().end(); ++it) {
-				const Tuple& t = it->first;
-				const R& bits = it->second;
-
-				R update = csp.getConstraint(t.x, t.y);
-				update |= bits;
-				csp.setConstraint(t.x, t.y, update);
+			assert(!levels.empty());
+
+			// an edge may be trailed again after a level above was reset,
+			// restoring in reverse order leaves the oldest value
+			const size_t start = levels.back().first;
+			for (size_t i = trail.size(); i > start; i--) {
+				const Tuple& t = trail[i-1].first;
+				if (!changed.empty())
+					recordChange(t, csp.getEdgePosition(t.x, t.y));
+				csp.setConstraint(t.x, t.y, trail[i-1].second);
 			}
-			trail.pop_back();
+			trail.erase(trail.begin()+start, trail.end());
+			levels.pop_back();
 		}
 
-		void resetToInitialState() { while(!trail.empty()) resetToLastState(); }
+		void resetToInitialState() { while(!levels.empty()) resetToLastState(); }
+		/** Number of saved states, i.e., the current decision level */
+		size_t getDepth() const { return levels.size(); }
+
+		/** Record the changed edges from now on */
+		void trackChanges() { changed.assign(csp.getEdgePositions(), false); }
+		/** Edges changed since the last clearChanges() */
+		const std::vector<Tuple>& getChanges() const { return changes; }
+		void clearChanges() {
+			for (size_t i = 0; i < changes.size(); i++)
+				changed[csp.getEdgePosition(changes[i].x, changes[i].y)] = false;
+			changes.clear();
+		}
 
 		// read a value
-		inline const R& getValue(const Tuple& t) const { return csp.getConstraint(t.x, t.y); }
-		inline const R& getConstraint(const size_t i, const size_t j) const { return csp.getConstraint(i, j); }
+		inline typename N::const_reference getValue(const Tuple& t) const { return csp.getConstraint(t.x, t.y); }
+		inline typename N::const_reference getConstraint(const size_t i, const size_t j) const { return csp.getConstraint(i, j); }
 
 		/** Get the size of the CSP @return the number of nodes in the CSP */
 		const size_t getSize() const { return csp.getSize(); }
@@ -92,11 +150,11 @@ class CSPStack {
 
 
 		// Check whether current state of stacks is equal
-		bool operator== (const CSPStack<R, C>& b) const {
+		bool operator== (const CSPStack<R, C, N>& b) const {
 			return csp == b.csp;
 		}
 
-		const CSP<R, C>& getCSP() { return csp; } // TODO: really necessary?
+		const N& getCSP() const { return csp; } // TODO: really necessary?
 };
 
 }
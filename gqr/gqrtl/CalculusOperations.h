@@ -22,12 +22,17 @@
 #define CALCULUS_OPERATIONS_H
 
 #include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
 #include <vector>
 
 #include "Calculus.h"
+#include "CalculusCache.h"
 
 #include "Splitter.h"
 
+#include "gqrtl/PrecomputedTable.h"
 #include "gqrtl/RelationFixedBitset.h"
 #include "gqrtl/ValueHeuristic.h"
 
@@ -49,9 +54,9 @@ class CalculusOperations {
 		const R universal;
 
 		size_t precomputationOffset;
-		std::vector<R> precomputedCompositionTable;
+		PrecomputedTable<R> precomputedCompositionTable;
 		inline void precomputeComposition() {}
-		std::vector<R> precomputedConverseTable;
+		PrecomputedTable<R> precomputedConverseTable;
 		inline void precomputeConverse() {}
 
 		// For Hogge's method
@@ -64,7 +69,7 @@ class CalculusOperations {
 		/** Array holding the sizes of the quadrants of precomputed compositions */
 		size_t quadrantSizes[2];
 
-		std::vector<size_t> precomputedWeights;
+		PrecomputedTable<size_t> precomputedWeights;
 		void precomputeWeights() {}
 
 		std::vector<std::vector<R> > compositionTable;
@@ -79,19 +84,93 @@ class CalculusOperations {
 			}
 		}
 
-		std::vector<R> precomputedSplit;
+		PrecomputedTable<R> precomputedSplit;
 		void precomputeSplit() {};
+
+		// Precomputed tables in the calculus cache
+		/** Identifies the relation type in the calculus cache; empty if its tables cannot be cached */
+		static std::string cacheTag() {
+			std::stringstream tag;
+			tag << R::maxSize() << "x" << sizeof(R);
+			return tag.str();
+		}
+
+		/** Section of the composition, converse and weight tables */
+		std::string tablesKey() const { return "tables/" + cacheTag(); }
+		/** Section of the split table, which depends on the splitter; empty if it cannot be cached */
+		std::string splitKey() const {
+			if (calculus.getSplitter() != NULL && calculus.getSplitterName().empty())
+				return "";
+			return "split/" + cacheTag() + "/" + calculus.getSplitterName();
+		}
+
+		bool readPrecomputedTables();
+		void writePrecomputedTables() const;
+		bool readPrecomputedSplit();
+		void writePrecomputedSplit() const;
+
+		// Chunked tables for single word relations with up to 64 base relations
+		/** Upper bound (in byte) for the chunked composition table */
+		static const size_t chunkTableBudget = 4 << 20;
+		/** Width and number of the chunks indexing the chunked composition table */
+		size_t compositionChunkBits, compositionChunks;
+		/** Width and number of the chunks indexing the chunked converse and weight tables */
+		size_t unaryChunkBits, unaryChunks;
+
+		void precomputeChunkedComposition();
+		void precomputeChunkedConverse();
+		void precomputeChunkedWeights();
+		inline R getChunkedComposition(const R& a, const R& b) const;
+		inline R getChunkedConverse(const R& r) const;
+		inline size_t getChunkedWeight(const R& r) const;
+
+		// Row-mask tables for relations spanning multiple words
+		/** Upper bound (in byte) for the row-mask table */
+		static const size_t rowMaskBudget = 16 << 20;
+		/** Width (1, 2, 4 or 8; 0 if the table does not fit) and number of the chunks of the second operand */
+		size_t rowChunkBits, rowChunks;
+
+		void precomputeRowMasks();
+		inline R getRowMaskComposition(const R& a, const R& b) const;
+
+		// Direct-mapped cache of compositions for relations spanning multiple words
+		struct CompositionCacheEntry {
+			R a;
+			R b;
+			R result;
+			bool valid;
+
+			CompositionCacheEntry() : valid(false) {}
+		};
+		mutable std::vector<CompositionCacheEntry> compositionCache;
+		/** the index of an entry are the highest bits of the hash value of a pair of relations */
+		size_t compositionCacheShift;
+		mutable size_t compositionCacheHits, compositionCacheMisses;
+
+		inline R getCachedComposition(const R& a, const R& b) const;
 	public:
 		CalculusOperations(const ::Calculus& c) : calculus(c),
-			identity(c.getIdentityRelation()), universal(c.getUniversalRelation())
+			identity(c.getIdentityRelation()), universal(c.getUniversalRelation()),
+			precomputationOffset(0),
+			compositionChunkBits(0), compositionChunks(0), unaryChunkBits(0), unaryChunks(0),
+			rowChunkBits(0), rowChunks(0),
+			compositionCacheShift(0), compositionCacheHits(0), compositionCacheMisses(0)
 			{
 				assert(R::maxSize() >= getNumberOfBaseRelations());
+				splitValues[0] = splitValues[1] = 0;
+				quadrantSizes[0] = quadrantSizes[1] = 0;
 
 				buildCompositionTable();
-				precomputeComposition();
-				precomputeConverse();
-				precomputeWeights();
-				precomputeSplit();
+				if (!readPrecomputedTables()) {
+					precomputeComposition();
+					precomputeConverse();
+					precomputeWeights();
+					writePrecomputedTables();
+				}
+				if (!readPrecomputedSplit()) {
+					precomputeSplit();
+					writePrecomputedSplit();
+				}
 			}
 		/** Are all base relations of this calculus serial? */
 		inline bool baseRelationsAreSerial() const { return calculus.baseRelationsAreSerial(); }
@@ -125,9 +204,8 @@ class CalculusOperations {
 
 		inline size_t computeWeight(const R& r) const {
 			size_t res = 0;
-			for (size_t i = 0; i < getNumberOfBaseRelations(); i++)
-				if (r[i])
-					res += calculus.getWeightBaseRelation(i);
+			for (typename R::const_iterator it = r.begin(); it != r.end(); ++it)
+				res += calculus.getWeightBaseRelation(*it);
 			return res;
 		}
 		inline size_t getWeight(const R& r) const { return computeWeight(r); }
@@ -135,7 +213,38 @@ class CalculusOperations {
 		inline const R& getIdentityRelation() const { return identity; }
 		inline const R& getUniversalRelation() const { return universal; }
 
-		void printStatistics() const { }
+		/**
+		* Cache at least 'entries' compositions (rounded up to a power of 2); 0 disables the cache.
+		* Only relation types with a table based composition that is slow compared to a lookup
+		* (i.e., RelationFixedBitset with multiple words) use the cache.
+		*/
+		void setCompositionCacheSize(const size_t entries) {
+			compositionCache.clear();
+			compositionCacheHits = compositionCacheMisses = 0;
+			if (entries == 0)
+				return;
+
+			size_t bits = 1;
+			while (((size_t) 1 << bits) < entries && bits < sizeof(size_t)*8 - 1)
+				bits++;
+			compositionCacheShift = sizeof(size_t)*8 - bits;
+			compositionCache.resize((size_t) 1 << bits);
+		}
+		size_t getCompositionCacheSize() const { return compositionCache.size(); }
+
+		void printStatistics() const {
+			if (compositionCache.empty())
+				return;
+			const size_t lookups = compositionCacheHits + compositionCacheMisses;
+			std::cout << "\tComposition cache; entries=" << compositionCache.size();
+			std::cout << ", hits=" << compositionCacheHits;
+			std::cout << ", misses=" << compositionCacheMisses;
+			if (lookups > 0)
+				std::cout << ", hit rate=" << (double) compositionCacheHits / (double) lookups << "\n";
+			else
+				std::cout << ", no hit rate\n";
+			std::cout << std::flush;
+		}
 
 		const ::Calculus& getCalculus() const { return calculus; }
 
@@ -163,6 +272,22 @@ class CalculusOperations {
 
 		R getFirstSplit(const R& r) const { return computeFirstSplit(r); }
 
+		/** First split of r without its k lowest base relations (k < r.count()), used for randomized value orderings */
+		R getFirstSplit(const R& r, size_t k) const {
+			assert(k < r.count());
+			if (k == 0)
+				return computeFirstSplit(r);
+
+			R rest;
+			for (typename R::const_iterator it = r.begin(); it != r.end(); ++it) {
+				if (k > 0)
+					k--;
+				else
+					rest.set(*it);
+			}
+			return computeFirstSplit(rest);
+		}
+
 		bool isSplit(const R& r) const {
 			if (getCalculus().getSplitter() != NULL)
 				return getCalculus().getSplitter()->isSplit(r.getRelation());
@@ -172,14 +297,379 @@ class CalculusOperations {
 		bool operator==(const CalculusOperations& c) const { return calculus == c.calculus; } // TODO: this is quite weak
 };
 
+// Precomputed tables in the calculus cache
+//
+// The section of a relation type holds the parameters of all table layouts, followed by the
+// composition, converse and weight tables, which are then used in place (memory-mapped).
+// The split table is stored separately, as it depends on the splitter (if any).
+// Sections compiled into the binary (built-in calculi) take precedence over the cache file.
+
+template<class R>
+bool CalculusOperations<R>::readPrecomputedTables() {
+	if (cacheTag().empty())
+		return false;
+
+	size_t length = 0;
+	const char* data = CalculusCache::getBuiltinSection(calculus, tablesKey(), length);
+	if (data == NULL && calculus.getCache() != NULL)
+		data = calculus.getCache()->getSection(tablesKey(), length);
+	CalculusCache::SectionReader in(data, length);
+
+	size_t* parameters[] = { &precomputationOffset, &splitValues[0], &splitValues[1],
+		&quadrantSizes[0], &quadrantSizes[1], &compositionChunkBits, &compositionChunks,
+		&unaryChunkBits, &unaryChunks, &rowChunkBits, &rowChunks };
+	for (size_t i = 0; i < sizeof(parameters)/sizeof(size_t*); i++)
+		in.get(*parameters[i]);
+
+	size_t nComposition = 0, nConverse = 0, nWeights = 0;
+	in.get(nComposition);
+	in.get(nConverse);
+	in.get(nWeights);
+	const char* composition = in.getTable(nComposition * sizeof(R));
+	const char* converse = in.getTable(nConverse * sizeof(R));
+	const char* weights = in.getTable(nWeights * sizeof(size_t));
+	if (!in.good())
+		return false; // parameters are set again by the precomputation
+
+	precomputedCompositionTable.assign(reinterpret_cast<const R*>(composition), nComposition);
+	precomputedConverseTable.assign(reinterpret_cast<const R*>(converse), nConverse);
+	precomputedWeights.assign(reinterpret_cast<const size_t*>(weights), nWeights);
+	return true;
+}
+
+template<class R>
+void CalculusOperations<R>::writePrecomputedTables() const {
+	CalculusCache* cache = calculus.getCache();
+	if (cache == NULL || cacheTag().empty())
+		return;
+
+	CalculusCache::SectionWriter out;
+	const size_t parameters[] = { precomputationOffset, splitValues[0], splitValues[1],
+		quadrantSizes[0], quadrantSizes[1], compositionChunkBits, compositionChunks,
+		unaryChunkBits, unaryChunks, rowChunkBits, rowChunks };
+	for (size_t i = 0; i < sizeof(parameters)/sizeof(size_t); i++)
+		out.put(parameters[i]);
+
+	out.put(precomputedCompositionTable.size());
+	out.put(precomputedConverseTable.size());
+	out.put(precomputedWeights.size());
+	out.putTable(precomputedCompositionTable.begin(), precomputedCompositionTable.size() * sizeof(R));
+	out.putTable(precomputedConverseTable.begin(), precomputedConverseTable.size() * sizeof(R));
+	out.putTable(precomputedWeights.begin(), precomputedWeights.size() * sizeof(size_t));
+
+	cache->addSection(tablesKey(), out);
+}
+
+template<class R>
+bool CalculusOperations<R>::readPrecomputedSplit() {
+	if (cacheTag().empty() || splitKey().empty())
+		return false;
+
+	size_t length = 0;
+	const char* data = NULL;
+	if (CalculusCache::builtinSplitterMatches(calculus))
+		data = CalculusCache::getBuiltinSection(calculus, splitKey(), length);
+	if (data == NULL && calculus.getCache() != NULL)
+		data = calculus.getCache()->getSection(splitKey(), length);
+	CalculusCache::SectionReader in(data, length);
+
+	size_t n = 0;
+	in.get(n);
+	const char* split = in.getTable(n * sizeof(R));
+	if (!in.good())
+		return false;
+
+	precomputedSplit.assign(reinterpret_cast<const R*>(split), n);
+	return true;
+}
+
+template<class R>
+void CalculusOperations<R>::writePrecomputedSplit() const {
+	CalculusCache* cache = calculus.getCache();
+	if (cache == NULL || cacheTag().empty() || splitKey().empty() || precomputedSplit.empty())
+		return;
+
+	CalculusCache::SectionWriter out;
+	out.put(precomputedSplit.size());
+	out.putTable(precomputedSplit.begin(), precomputedSplit.size() * sizeof(R));
+
+	cache->addSection(splitKey(), out);
+}
+
+// Row-mask tables
+//
+// For every base relation a, the second operand B is cut into chunks of k bits (k divides the
+// word size, hence no chunk spans two words). A flat array holds for each chunk c and each
+// value v of the chunk the composition of a with the relation given by v at position c.
+// Then a o B is the union of the row entries for the non-empty chunks of B, over all base
+// relations in a. The non-empty chunks of B are extracted once per composition, and the
+// computation stops as soon as the universal relation is reached.
+// The row-mask table is used for RelationFixedBitset with two and more words.
+
+template<class R>
+void CalculusOperations<R>::precomputeRowMasks() {
+	const size_t n = getNumberOfBaseRelations();
+
+	rowChunkBits = 0;
+	for (size_t k = 8; k > 0; k /= 2) {
+		const size_t chunks = (n + k - 1) / k;
+		if (n * chunks * ((size_t) 1 << k) * R::memSize() <= rowMaskBudget) {
+			rowChunkBits = k;
+			rowChunks = chunks;
+			break;
+		}
+	}
+	if (rowChunkBits == 0) {
+#ifndef NDEBUG
+std::cout << "Row-mask table does not fit into " << rowMaskBudget << " byte; not using precomputed composition\n";
+#endif
+		return;
+	}
+
+	const size_t& k = rowChunkBits;
+	const size_t values = (size_t) 1 << k;
+	precomputationOffset = rowChunks * values; // size of a row
+	precomputedCompositionTable.resize(n * precomputationOffset);
+
+#ifndef NDEBUG
+std::cout << "Precompute row-mask composition table with " << rowChunks << " chunks of " << k << " bits\n";
+std::cout << "Using " << precomputedCompositionTable.size()*R::memSize() << " byte\n";
+#endif
+
+	for (size_t a = 0; a < n; a++)
+		for (size_t c = 0; c < rowChunks; c++) {
+			R* table = &precomputedCompositionTable[a * precomputationOffset + c * values];
+			for (size_t v = 1; v < values; v++) {
+				const size_t lowV = v & (~v + 1);
+				if (v != lowV)
+					table[v] = table[v ^ lowV] | table[lowV];
+				else if (c * k + __builtin_ctzl(v) < n)
+					table[v] = compositionTable[a][c * k + __builtin_ctzl(v)];
+			}
+		}
+}
+
+template<class R>
+inline R CalculusOperations<R>::getRowMaskComposition(const R& a, const R& b) const {
+	if (rowChunkBits == 0)
+		return computeComposition(a, b);
+
+	const size_t& k = rowChunkBits;
+	const size_t mask = ((size_t) 1 << k) - 1;
+	const size_t wordBits = sizeof(typename R::getType) * 8;
+
+	// offsets of the non-empty chunks of b within a row
+	size_t offsets[sizeof(R) * 8];
+	size_t nOffsets = 0;
+	for (size_t w = 0; w < R::getNWords(); w++) {
+		const size_t word = b.getWord(w);
+		size_t rest = word;
+		while (rest != 0) {
+			const size_t shift = __builtin_ctzl(rest) / k * k;
+			const size_t c = (w * wordBits + shift) / k;
+			offsets[nOffsets++] = (c << k) + ((word >> shift) & mask);
+			rest &= ~(mask << shift);
+		}
+	}
+
+	R result;
+	for (typename R::const_iterator it = a.begin(); it != a.end(); ++it) {
+		const R* row = &precomputedCompositionTable[*it * precomputationOffset];
+		for (size_t i = 0; i < nOffsets; i++)
+			result |= row[offsets[i]];
+		if (result == universal)
+			break;
+	}
+	assert(result == computeComposition(a, b));
+	return result;
+}
+
+template<class R>
+inline R CalculusOperations<R>::getCachedComposition(const R& a, const R& b) const {
+	if (compositionCache.empty())
+		return getRowMaskComposition(a, b);
+
+	size_t hash = a.hash() * 0x9E3779B97F4A7C15UL + b.hash();
+	hash *= 0xC2B2AE3D27D4EB4FUL;
+	CompositionCacheEntry& entry = compositionCache[hash >> compositionCacheShift];
+	if (entry.valid && entry.a == a && entry.b == b) {
+		compositionCacheHits++;
+		assert(entry.result == computeComposition(a, b));
+		return entry.result;
+	}
+
+	compositionCacheMisses++;
+	entry.a = a;
+	entry.b = b;
+	entry.result = getRowMaskComposition(a, b);
+	entry.valid = true;
+	return entry.result;
+}
+
 // Template specialization for optimizations:
 //	-> precomputations
 //	-> optimizations for specific data structures
+
+#include <stdint.h>
+
+// Chunked tables
+//
+// A relation is cut into chunks of k bits. For each pair of chunks (ci, cj) a table holds the
+// composition of all 2^k x 2^k relations restricted to these chunks. a o b is then the union
+// of the table entries for all pairs of non-empty chunks of a and b. k is the largest width
+// such that the table stays within chunkTableBudget.
+// Converse and weight tables are built the same way, with one table per chunk of at most 16 bits.
+// Tables are filled incrementally: an entry for a chunk value with more than one bit is the
+// union (resp. sum) of the entries for its lowest bit and the remaining bits.
+
+template<class R>
+void CalculusOperations<R>::precomputeChunkedComposition() {
+	const size_t n = getNumberOfBaseRelations();
+	assert(n > 0 && n <= sizeof(size_t)*8);
+
+	for (compositionChunks = 1; ; compositionChunks++) {
+		compositionChunkBits = (n + compositionChunks - 1) / compositionChunks;
+		if (2*compositionChunkBits >= sizeof(size_t)*8) // shifts below would overflow
+			continue;
+		const size_t size = compositionChunks * compositionChunks * ((size_t) 1 << 2*compositionChunkBits);
+		if (size * R::memSize() <= chunkTableBudget)
+			break;
+	}
+
+	const size_t& k = compositionChunkBits;
+	const size_t values = (size_t) 1 << k;
+	precomputedCompositionTable.resize(compositionChunks * compositionChunks * values * values);
+
 #ifndef NDEBUG
-#include <iostream>
+std::cout << "Precompute chunked composition table with " << compositionChunks << " chunks of " << k << " bits\n";
+std::cout << "Using " << precomputedCompositionTable.size()*R::memSize() << " byte\n";
 #endif
 
-#include <stdint.h>
+	for (size_t ci = 0; ci < compositionChunks; ci++)
+		for (size_t cj = 0; cj < compositionChunks; cj++) {
+			R* table = &precomputedCompositionTable[(ci * compositionChunks + cj) << 2*k];
+			for (size_t x = 1; x < values; x++) {
+				const size_t lowX = x & (~x + 1);
+				for (size_t y = 1; y < values; y++) {
+					R& entry = table[(x << k) + y];
+					if (x != lowX) {
+						entry = table[((x ^ lowX) << k) + y] | table[(lowX << k) + y];
+						continue;
+					}
+					const size_t lowY = y & (~y + 1);
+					if (y != lowY) {
+						entry = table[(x << k) + (y ^ lowY)] | table[(x << k) + lowY];
+						continue;
+					}
+					const size_t a = ci * k + __builtin_ctzl(x);
+					const size_t b = cj * k + __builtin_ctzl(y);
+					if (a < n && b < n)
+						entry = compositionTable[a][b];
+				}
+			}
+		}
+}
+
+template<class R>
+inline R CalculusOperations<R>::getChunkedComposition(const R& a, const R& b) const {
+	const size_t& k = compositionChunkBits;
+	const size_t mask = ((size_t) 1 << k) - 1;
+	const size_t wordA = a.lowestWord();
+	const size_t wordB = b.lowestWord();
+
+	R result;
+	for (size_t ci = 0; ci < compositionChunks; ci++) {
+		const size_t x = (wordA >> (ci * k)) & mask;
+		if (x == 0)
+			continue;
+
+		const R* row = &precomputedCompositionTable[((ci * compositionChunks) << 2*k) + (x << k)];
+		for (size_t cj = 0; cj < compositionChunks; cj++) {
+			const size_t y = (wordB >> (cj * k)) & mask;
+			if (y != 0)
+				result |= row[(cj << 2*k) + y];
+		}
+		if (result == universal)
+			break;
+	}
+	assert(result == computeComposition(a, b));
+	return result;
+}
+
+template<class R>
+void CalculusOperations<R>::precomputeChunkedConverse() {
+	const size_t n = getNumberOfBaseRelations();
+	unaryChunks = (n + 15) / 16;
+	unaryChunkBits = (n + unaryChunks - 1) / unaryChunks;
+
+	const size_t values = (size_t) 1 << unaryChunkBits;
+	precomputedConverseTable.resize(unaryChunks * values);
+
+#ifndef NDEBUG
+std::cout << "Precompute chunked converse table with " << unaryChunks << " chunks of " << unaryChunkBits << " bits\n";
+std::cout << "Using " << precomputedConverseTable.size()*R::memSize() << " byte\n";
+#endif
+
+	for (size_t c = 0; c < unaryChunks; c++) {
+		R* table = &precomputedConverseTable[c * values];
+		for (size_t x = 1; x < values; x++) {
+			const size_t lowX = x & (~x + 1);
+			if (x != lowX)
+				table[x] = table[x ^ lowX] | table[lowX];
+			else if (c * unaryChunkBits + __builtin_ctzl(x) < n)
+				table[x].set(calculus.getBaseRelationConverse(c * unaryChunkBits + __builtin_ctzl(x)));
+		}
+	}
+}
+
+template<class R>
+inline R CalculusOperations<R>::getChunkedConverse(const R& r) const {
+	const size_t mask = ((size_t) 1 << unaryChunkBits) - 1;
+	const size_t word = r.lowestWord();
+
+	R result;
+	for (size_t c = 0; c < unaryChunks; c++)
+		result |= precomputedConverseTable[(c << unaryChunkBits) + ((word >> (c * unaryChunkBits)) & mask)];
+	assert(result == computeConverse(r));
+	return result;
+}
+
+template<class R>
+void CalculusOperations<R>::precomputeChunkedWeights() {
+	// uses the chunks of the converse table
+	const size_t n = getNumberOfBaseRelations();
+	const size_t values = (size_t) 1 << unaryChunkBits;
+	precomputedWeights.resize(unaryChunks * values);
+
+#ifndef NDEBUG
+std::cout << "Precompute chunked weight table with " << precomputedWeights.size() << " entries\n";
+std::cout << "Using " << precomputedWeights.size()*sizeof(size_t) << " byte\n";
+#endif
+
+	for (size_t c = 0; c < unaryChunks; c++) {
+		size_t* table = &precomputedWeights[c * values];
+		for (size_t x = 1; x < values; x++) {
+			const size_t lowX = x & (~x + 1);
+			if (x != lowX)
+				table[x] = table[x ^ lowX] + table[lowX];
+			else if (c * unaryChunkBits + __builtin_ctzl(x) < n)
+				table[x] = calculus.getWeightBaseRelation(c * unaryChunkBits + __builtin_ctzl(x));
+		}
+	}
+}
+
+template<class R>
+inline size_t CalculusOperations<R>::getChunkedWeight(const R& r) const {
+	const size_t mask = ((size_t) 1 << unaryChunkBits) - 1;
+	const size_t word = r.lowestWord();
+
+	size_t result = 0;
+	for (size_t c = 0; c < unaryChunks; c++)
+		result += precomputedWeights[(c << unaryChunkBits) + ((word >> (c * unaryChunkBits)) & mask)];
+	assert(result == computeWeight(r));
+	return result;
+}
+
 
 // Relation8
 // Full precomputations
@@ -450,51 +940,79 @@ Relation16 CalculusOperations<Relation16>::getFirstSplit(const Relation16& r) co
 	return precomputedSplit[r.lowestWord()];
 }
 
-// Relation32
+// Relation32 and RelationFixedBitset<size_t, 1>
 
-// Hogge's converses
+// Chunked tables for composition, converses and weights
 template<> inline
-void CalculusOperations<Relation32>::precomputeConverse() {
-	splitValues[1] = getNumberOfBaseRelations()/2 + getNumberOfBaseRelations()%2;
-	quadrantSizes[0] = 1 << splitValues[1];
-	quadrantSizes[1] = 1 << getNumberOfBaseRelations()/2;
+void CalculusOperations<Relation32>::precomputeComposition() { precomputeChunkedComposition(); }
 
-	splitValues[0] = quadrantSizes[0] + quadrantSizes[1];
-	const size_t& size = splitValues[0];
-	precomputedConverseTable.resize(size);
+template<> inline
+Relation32 CalculusOperations<Relation32>::getComposition(const Relation32& a, const Relation32& b) const { return getChunkedComposition(a, b); }
 
-#ifndef NDEBUG
-std::cout << "Precompute Hogge's converse function.\n";
-std::cout << "Using " << size*Relation32::memSize() << " byte\n";
-#endif
-	precomputedConverseTable.resize(size);
-	for (size_t i = 0; i < quadrantSizes[0]; i++) {
-		const Relation32 r(i);
-		precomputedConverseTable[r.lowestWord()] = computeConverse(r);
-	}
-	for (size_t i = 0; i < quadrantSizes[1]; i++) {
-		Relation32 r(i);
-		r <<= splitValues[1];
-		precomputedConverseTable[quadrantSizes[0]+i] = computeConverse(r);
-	}
-}
+template<> inline
+void CalculusOperations<Relation32>::precomputeConverse() { precomputeChunkedConverse(); }
 
 template<> inline
-Relation32 CalculusOperations<Relation32>::getConverse(const Relation32& r) const {
-	const size_t low_mask = (1 << splitValues[1]) - 1;
-	const size_t lower_addr = low_mask & r.lowestWord();
-	const Relation32 higher_part = r >> splitValues[1];
+Relation32 CalculusOperations<Relation32>::getConverse(const Relation32& r) const { return getChunkedConverse(r); }
 
-	const Relation32& result1 = precomputedConverseTable[lower_addr];
-	const Relation32& result2 = precomputedConverseTable[higher_part.lowestWord()+quadrantSizes[0]];
-	const Relation32 result = result1 | result2;
-	assert(result == computeConverse(r));
-	return result;
-}
+template<> inline
+void CalculusOperations<Relation32>::precomputeWeights() { precomputeChunkedWeights(); }
+
+template<> inline
+size_t CalculusOperations<Relation32>::getWeight(const Relation32& r) const { return getChunkedWeight(r); }
+
+template<> inline
+void CalculusOperations<RelationFixedBitset<size_t, 1> >::precomputeComposition() { precomputeChunkedComposition(); }
+
+template<> inline
+RelationFixedBitset<size_t, 1> CalculusOperations<RelationFixedBitset<size_t, 1> >::getComposition(const RelationFixedBitset<size_t, 1>& a, const RelationFixedBitset<size_t, 1>& b) const { return getChunkedComposition(a, b); }
+
+template<> inline
+void CalculusOperations<RelationFixedBitset<size_t, 1> >::precomputeConverse() { precomputeChunkedConverse(); }
+
+template<> inline
+RelationFixedBitset<size_t, 1> CalculusOperations<RelationFixedBitset<size_t, 1> >::getConverse(const RelationFixedBitset<size_t, 1>& r) const { return getChunkedConverse(r); }
+
+template<> inline
+void CalculusOperations<RelationFixedBitset<size_t, 1> >::precomputeWeights() { precomputeChunkedWeights(); }
+
+template<> inline
+size_t CalculusOperations<RelationFixedBitset<size_t, 1> >::getWeight(const RelationFixedBitset<size_t, 1>& r) const { return getChunkedWeight(r); }
+
+// RelationFixedBitset with multiple words
+
+// Row-mask tables for composition, optionally behind the composition cache
+template<> inline
+void CalculusOperations<RelationFixedBitset<size_t, 2> >::precomputeComposition() { precomputeRowMasks(); }
+
+template<> inline
+RelationFixedBitset<size_t, 2> CalculusOperations<RelationFixedBitset<size_t, 2> >::getComposition(const RelationFixedBitset<size_t, 2>& a, const RelationFixedBitset<size_t, 2>& b) const { return getCachedComposition(a, b); }
+
+template<> inline
+void CalculusOperations<RelationFixedBitset<size_t, 4> >::precomputeComposition() { precomputeRowMasks(); }
+
+template<> inline
+RelationFixedBitset<size_t, 4> CalculusOperations<RelationFixedBitset<size_t, 4> >::getComposition(const RelationFixedBitset<size_t, 4>& a, const RelationFixedBitset<size_t, 4>& b) const { return getCachedComposition(a, b); }
+
+template<> inline
+void CalculusOperations<RelationFixedBitset<size_t, 5> >::precomputeComposition() { precomputeRowMasks(); }
+
+template<> inline
+RelationFixedBitset<size_t, 5> CalculusOperations<RelationFixedBitset<size_t, 5> >::getComposition(const RelationFixedBitset<size_t, 5>& a, const RelationFixedBitset<size_t, 5>& b) const { return getCachedComposition(a, b); }
+
+template<> inline
+void CalculusOperations<RelationFixedBitset<size_t, 10> >::precomputeComposition() { precomputeRowMasks(); }
+
+template<> inline
+RelationFixedBitset<size_t, 10> CalculusOperations<RelationFixedBitset<size_t, 10> >::getComposition(const RelationFixedBitset<size_t, 10>& a, const RelationFixedBitset<size_t, 10>& b) const { return getCachedComposition(a, b); }
 
 
 // General Relation type
 
+// not a plain array of words, cannot be cached
+template<>
+inline std::string CalculusOperations<Relation>::cacheTag() { return ""; }
+
 template<> inline
 Relation CalculusOperations<Relation>::getNegation(const Relation& r) const {
 	Relation result;
@@ -0,0 +1,126 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef CHORDAL_CSP_H
+#define CHORDAL_CSP_H
+
+#include <string>
+#include <vector>
+#include <cassert>
+
+#include "CSPSparse.h"
+#include "ChordalGraph.h"
+#include "Tuple.h"
+
+namespace gqrtl {
+
+/**
+ * Binary CSP that stores only the edges of a chordal graph, i.e., memory is
+ * linear in the edges of the graph instead of quadratic in the nodes. Other
+ * edges read as the universal relation and must not be set. Same interface
+ * as CSP; the graph must outlive the network.
+ *
+ * Like FullMatrix, both orientations of an edge are stored, hence every write
+ * computes a converse but reads are plain loads.
+ */
+template<class R, class C>
+class ChordalCSP {
+	private:
+		const C& calculus;
+		const ChordalGraph& graph;
+
+		/** Relations (x,y) and (y,x), x < y, of each edge at 2*id and 2*id+1 */
+		std::vector<R> edges;
+		/** Relation of each edge (x,x) */
+		std::vector<R> diagonal;
+
+	public:
+		typedef const R& const_reference;
+
+		/** String containing the name (e.g, parameters used to generate the CSP) */
+		const std::string name;
+
+		/** Build from the sparse CSP, whose constraint graph must be a subgraph of g */
+		ChordalCSP(const CSPSparse& csp, const C& c, const ChordalGraph& g) : calculus(c), graph(g),
+			edges(2*g.getEdges(), c.getUniversalRelation()), diagonal(g.getSize(), c.getIdentityRelation()), name(csp.name) {
+			assert(csp.getSize() == graph.getSize());
+
+			for (CSPSparse::const_iterator it = csp.begin(); it != csp.end(); ++it)
+				setConstraint(it->first.first, it->first.second, R(it->second));
+		}
+
+		inline void setConstraint(const size_t x, const size_t y, const R r) {
+			if (x == y)
+				diagonal[x] = r;
+			else {
+				const size_t id = getEdgeId(x, y);
+				edges[2*id + (x > y)] = r;
+				edges[2*id + (x < y)] = calculus.getConverse(r);
+			}
+		}
+
+		inline const_reference getConstraint(const size_t x, const size_t y) const {
+			if (x == y)
+				return diagonal[x];
+
+			const size_t id = graph.getEdge(x, y);
+			if (id == ChordalGraph::noEdge)
+				return calculus.getUniversalRelation();
+			return edges[2*id + (x > y)];
+		}
+
+		/** Relation (x,y) of edge id = (x,y), x < y, or (y,x) if converse is set */
+		inline const_reference getEdgeConstraint(const size_t id, const bool converse) const {
+			return edges[2*id + converse];
+		}
+
+		/** Id of edge (x,y) in the graph, which must exist */
+		inline size_t getEdgeId(const size_t x, const size_t y) const {
+			const size_t id = graph.getEdge(x, y);
+			assert(id != ChordalGraph::noEdge);
+			return id;
+		}
+
+		const size_t getSize() const { return graph.getSize(); }
+		const C& getCalculus() const { return calculus; }
+		const ChordalGraph& getGraph() const { return graph; }
+
+		/** Append the edges (x,y), x < y, of the graph to e */
+		void getEdges(std::vector<Tuple>& e) const {
+			for (size_t id = 0; id < graph.getEdges(); id++)
+				e.push_back(graph.getTuple(id));
+		}
+
+		/** Number of edges (x,y), x <= y, used to index data per edge by getEdgePosition */
+		size_t getEdgePositions() const { return graph.getEdges() + graph.getSize(); }
+		inline size_t getEdgePosition(const size_t x, const size_t y) const {
+			if (x == y)
+				return graph.getEdges() + x;
+			return getEdgeId(x, y);
+		}
+
+		inline bool operator== (const ChordalCSP<R, C>& b) const {
+			return &graph == &b.graph && calculus == b.calculus && edges == b.edges && diagonal == b.diagonal;
+		}
+};
+
+}
+
+#endif // CHORDAL_CSP_H
@@ -30,24 +30,28 @@
 #include "gqrtl/CSPStack.h"
 #include "gqrtl/VariableHeuristic.h"
 #include "gqrtl/DFSReport.h"
+#include "gqrtl/StopFlag.h"
+#include "gqrtl/SearchTasks.h"
 
 #include "gqrtl/WeightedTripleIterator.h"
 
 class Logger;
 
 /**
- * Implements a 2-way dfs
+ * Implements a 2-way dfs on a network N (CSP or ChordalCSP) with propagator P,
+ * which operates on a CSPStack of N. The search is a loop over the explicit
+ * stack of decisions, hence its depth is not limited by the call stack.
  */
 
 namespace gqrtl {
 
-template<class R>
+template<class R, class N = CSP<R, CalculusOperations<R> >, class P = WeightedTripleIterator<R, CSPStack<R, CalculusOperations<R>, N> > >
 class DFS : public DFSReport {
 	private:
-		typedef CSPStack<R, CalculusOperations<R> > CoreCSPStack; // TODO: Move somewhere else
-		typedef CSP<R, CalculusOperations<R> > CoreCSP; // TODO: Move somewhere else
+		typedef CSPStack<R, CalculusOperations<R>, N> CoreCSPStack; // TODO: Move somewhere else
+		typedef N CoreCSP;
 
-		WeightedTripleIterator<R, CoreCSPStack> propagate;
+		P propagate;
 
 		CoreCSPStack current_state;
 
@@ -65,11 +69,23 @@ class DFS : public DFSReport {
 		Tuple lastConflict;
 
 		const Tuple decideVariable();
+		/** Append var to the variables */
+		inline void addVariable(const Tuple& var);
+		/** Remove variables[pos], the last variable takes its place */
+		inline const Tuple removeVariable(const size_t pos);
 		const R decideValue(const R& values);
 		bool decide();
 		bool enforceConsistency();
+		/** Refute the latest positive decision whose refutation was not stolen. @return false if there is none, i.e., the (sub)tree is exhausted */
+		bool backtrack();
+		/** Search iteratively with the explicit stack of decisions */
 		bool dfs();
 
+		#ifndef NDEBUG
+		/** Network before each positive decision on the stack */
+		std::vector<CoreCSP> debugStates;
+		#endif
+
 		std::vector<Tuple> variables;
 
 		/** print statistics if log interval exceeded */
@@ -79,10 +95,50 @@ class DFS : public DFSReport {
 
 		void generateLogReport();
 
+		/** Polled once per node; the search is abandoned once it is raised */
+		const StopFlag* stop;
+		bool stopped;
+
+		/** Randomized value ordering and tie-breaking of the variables unless 0 */
+		size_t seed;
+		size_t random;
+
+		/** Open subtrees shared with searches in other threads (WorkStealingDFS); NULL if searching alone */
+		SearchTasks<R>* tasks;
+		size_t thread;
+		size_t shareDepth;
+		/** Decisions that led from the input of all threads to the network searched */
+		const typename SearchTasks<R>::Path* rootPath;
+		typename SearchTasks<R>::Path sharedPath;
+		/** Offer the refutation of the latest (positive) decision to the other threads */
+		void shareRefutation();
+
 	public:
 		DFS(const CoreCSP& csp, Logger* log);
 		~DFS();
 
+		/**
+		 * Pick the values at random and break ties between the variables by the
+		 * seed; 0 (the default) keeps the deterministic orderings. Call before run().
+		 */
+		void setSeed(const size_t s);
+
+		/** Stop the search once the flag is raised; run() then returns NULL */
+		void setStopFlag(const StopFlag* flag) { stop = flag; }
+		/** @return true iff run() was abandoned due to the stop flag */
+		bool isStopped() const { return stopped; }
+
+		/**
+		 * Offer the refutations of the positive decisions up to level depth as
+		 * thread t; the network searched is the input of all threads restricted
+		 * by the decisions of root. Call before run().
+		 */
+		void setTasks(SearchTasks<R>* st, const size_t t, const size_t depth, const typename SearchTasks<R>::Path& root) {
+			tasks = st; thread = t; shareDepth = depth; rootPath = &root;
+		}
+		/** Start with the learned weights of another search on the same network; call before run() */
+		void setLearnedWeights(const std::vector<size_t>& weights) { variableHeuristic.setLearnedWeights(weights); }
+
 		// Run search
 		CoreCSP* run();
 };
@@ -26,47 +26,79 @@
 
 namespace gqrtl {
 
-template<class R>
-DFS<R>::DFS(const DFS::CoreCSP& csp, ::Logger* l) : DFSReport(),
-	current_state(csp), lastConflict(InvalidTuple), variableHeuristic(csp.getSize()), log(l) {}
-
-template<class R>
-DFS<R>::~DFS() {}
+template<class R, class N, class P>
+DFS<R,N,P>::DFS(const DFS::CoreCSP& csp, ::Logger* l) : DFSReport(),
+	current_state(csp), lastConflict(InvalidTuple), variableHeuristic(csp.getEdgePositions()), log(l),
+	stop(NULL), stopped(false), seed(0), random(0),
+	tasks(NULL), thread(0), shareDepth(0), rootPath(NULL) {}
+
+template<class R, class N, class P>
+DFS<R,N,P>::~DFS() {}
+
+template<class R, class N, class P>
+void DFS<R,N,P>::setSeed(const size_t s) {
+	seed = s;
+	random = s;
+	variableHeuristic.setSeed(s);
+}
 
-template<class R>
-const Tuple DFS<R>::decideVariable() {
+template<class R, class N, class P>
+const Tuple DFS<R,N,P>::decideVariable() {
 	assert(!variables.empty());
 
 	size_t pos;
 	if (lastConflict != InvalidTuple) {
 		assert(std::find(variables.begin(), variables.end(), lastConflict) != variables.end());
 
-		for (pos = variables.size()-1; variables[pos] != lastConflict; --pos);
+		pos = variableHeuristic.getIndex(lastConflict, current_state.getCSP());
 		assert(variables[pos] == lastConflict);
 	}
 	else {
+		variableHeuristic.update(current_state.getChanges(), current_state.getCSP());
+		current_state.clearChanges();
 		pos = variableHeuristic.decide(variables, current_state.getCSP());
 	}
 
-	std::swap(variables[pos], variables.back());
-	Tuple res = variables.back();
+	return removeVariable(pos);
+}
+
+template<class R, class N, class P>
+inline void DFS<R,N,P>::addVariable(const Tuple& var) {
+	variables.push_back(var);
+	variableHeuristic.insert(var, variables.size()-1, current_state.getCSP());
+}
+
+template<class R, class N, class P>
+inline const Tuple DFS<R,N,P>::removeVariable(const size_t pos) {
+	const Tuple res = variables[pos];
+	variableHeuristic.remove(res, current_state.getCSP());
+
+	if (pos != variables.size()-1) {
+		variables[pos] = variables.back();
+		variableHeuristic.move(variables[pos], pos, current_state.getCSP());
+	}
 	variables.pop_back();
 
 	return res;
 }
 
-template<class R>
-const R DFS<R>::decideValue(const R& values) {
+template<class R, class N, class P>
+const R DFS<R,N,P>::decideValue(const R& values) {
 	assert(!values.none());
 
-	const R value = current_state.getCalculus().getFirstSplit(values);
-	assert(!value.none());
+	if (seed == 0)
+		return current_state.getCalculus().getFirstSplit(values);
+
+	// the first split without a random number of the lowest base relations
+	random = random * 1103515245 + 12345;
+	const R value = current_state.getCalculus().getFirstSplit(values, (random >> 16) % values.count());
+	assert(!value.none() && value.isSubsetOf(values));
 
 	return value;
 }
 
-template<class R>
-bool DFS<R>::decide() {
+template<class R, class N, class P>
+bool DFS<R,N,P>::decide() {
 	const Tuple var = decideVariable();
 
 	const R& values = current_state.getValue(var);
@@ -77,7 +109,7 @@ bool DFS<R>::decide() {
 		return false;	// no need to assign a new value
 	}
 
-	const R value = current_state.getCalculus().getFirstSplit(values);
+	const R value = decideValue(values);
 	assert(!value.none());
 	assert(value != current_state.getValue(var));
 
@@ -87,11 +119,27 @@ bool DFS<R>::decide() {
 	current_state.backupState();			// new depth
 	current_state.setValue(var, value);		// enforce decision
 
+	if (tasks && current_state.getDepth() <= shareDepth)
+		shareRefutation();
+
 	return true;
 }
 
-template<class R>
-bool DFS<R>::enforceConsistency() {
+template<class R, class N, class P>
+void DFS<R,N,P>::shareRefutation() {
+	sharedPath = *rootPath;
+	for (size_t i = 0; i < decisions.size(); i++)
+		if (decisions[i].type != Decision::implied)
+			sharedPath.push_back(std::make_pair(decisions[i].variable, decisions[i].value));
+
+	assert(decisions.back().type == Decision::positive);
+	sharedPath.back().second = current_state.getCalculus().getNegation(decisions.back().value);
+
+	tasks->offer(thread, current_state.getDepth(), sharedPath, variableHeuristic.getLearnedWeights());
+}
+
+template<class R, class N, class P>
+bool DFS<R,N,P>::enforceConsistency() {
 	if (decisions.empty()) {
 		propagation_calls++;
 
@@ -105,7 +153,7 @@ bool DFS<R>::enforceConsistency() {
 		propagation_calls++;
 		std::vector<Tuple> t = propagate.enforce(current_state, var.x, var.y);
 		if (!t.empty()) {
-			variableHeuristic.reportFailure(t, decisions.size());
+			variableHeuristic.reportFailure(t, decisions.size(), current_state.getCSP());
 			return false;
 		}
 	}
@@ -113,97 +161,129 @@ bool DFS<R>::enforceConsistency() {
 	return true;
 }
 
-template<class R>
-bool DFS<R>::dfs() {
-	if (log) {
-		visited_depth_min = std::min<size_t>(visited_depth_min, decisions.size());
-		visited_depth_max = std::max<size_t>(visited_depth_max, decisions.size());
-		if (log->logDue())
-			generateLogReport();
+template<class R, class N, class P>
+bool DFS<R,N,P>::backtrack() {
+	// the latest positive decision, if any, is the one to refute
+	size_t last = decisions.size();
+	while (last > 0 && decisions[last-1].type != Decision::positive)
+		last--;
+	if (last == 0)
+		return false;
+
+	while(decisions.back().type != Decision::positive) {
+		if (decisions.back().type == Decision::implied) {
+			addVariable(decisions.back().variable);
+		}
+		decisions.pop_back();
 	}
 
-	if (!enforceConsistency())	// inconsistent
-		return false;
+	const Tuple var = decisions.back().variable;
+	addVariable(var);
+
+	// another thread searches the refutation if it stole it
+	const size_t level = current_state.getDepth();
+	const bool stolen = tasks && level <= shareDepth && !tasks->reclaim(thread, level);
+
+	current_state.resetToLastState();
 
 	#ifndef NDEBUG
-	const CoreCSP DEBUG = current_state.getCSP();
+	assert(current_state.getCSP() == debugStates.back());
+	debugStates.pop_back();
 	#endif
 
-	// make new decision
-	if (!decisions.empty() && lastConflict != InvalidTuple
-		&& (decisions.back().type == Decision::positive || decisions.back().type == Decision::implied)) {
-		assert(decisions.back().variable == lastConflict);	// positve/implied decision may only happen on lastConflict
-		lastConflict = InvalidTuple;
+	if (stolen) {	// recurses at most shareDepth times
+		decisions.pop_back();
+		return backtrack();
 	}
 
-	if (variables.empty())
-		return true;
+	number_negative_decisions++;
+	if (lastConflict == InvalidTuple)
+		lastConflict = var;
 
-	if (!decide())	// implied decisions
-		return dfs();
+	const R nvalue = current_state.getCalculus().getNegation(decisions.back().value);
 
-	// positive decision
-	if (dfs()) {
-		return true;
-	}
-	else {
-		number_negative_decisions++;
-		while(decisions.back().type != Decision::positive) {
-			if (decisions.back().type == Decision::implied) {
-				variables.push_back(decisions.back().variable);
-			}
-			decisions.pop_back();
-		}
+	current_state.setValue(var, nvalue & current_state.getValue(var));
+	assert(!nvalue.none());
 
-		const Tuple var = decisions.back().variable;
-		if (lastConflict == InvalidTuple)
-			lastConflict = var;
+	// replace positive decision with negative one
+	decisions.pop_back();
+	decisions.push_back(Decision(var, nvalue, Decision::negative));
 
-		variables.push_back(var);
+	return true;
+}
 
-		current_state.resetToLastState();
+template<class R, class N, class P>
+bool DFS<R,N,P>::dfs() {
+	#ifndef NDEBUG
+	debugStates.clear();
+	#endif
 
-		#ifndef NDEBUG
-		assert(current_state == DEBUG);
-		#endif
+	// every iteration visits one node of the search tree
+	while (true) {
+		if (stop && stop->isRaised()) {
+			stopped = true;
+			return false;
+		}
+
+		if (log) {
+			visited_depth_min = std::min<size_t>(visited_depth_min, decisions.size());
+			visited_depth_max = std::max<size_t>(visited_depth_max, decisions.size());
+			if (log->logDue())
+				generateLogReport();
+		}
 
-		const R nvalue = current_state.getCalculus().getNegation(decisions.back().value);
+		if (!enforceConsistency()) {	// inconsistent
+			if (!backtrack())
+				return false;
+			continue;
+		}
 
-		current_state.setValue(var, nvalue & current_state.getValue(var));
-//		std::cout << "Negative decision: " << var << " set to " << nvalue << "\n";;
-		assert(!nvalue.none());
+		// make new decision
+		if (!decisions.empty() && lastConflict != InvalidTuple
+			&& (decisions.back().type == Decision::positive || decisions.back().type == Decision::implied)) {
+			assert(decisions.back().variable == lastConflict);	// positve/implied decision may only happen on lastConflict
+			lastConflict = InvalidTuple;
+		}
 
-		// replace positive decision with negative one
-		decisions.pop_back();
-		decisions.push_back(Decision(var, nvalue, Decision::negative));
+		if (variables.empty())
+			return true;
 
-		return dfs();
+		#ifndef NDEBUG
+		debugStates.push_back(current_state.getCSP());
+		if (!decide())	// implied decision
+			debugStates.pop_back();
+		#else
+		decide();
+		#endif
 	}
 }
 
 
-template<class R>
-typename DFS<R>::CoreCSP* DFS<R>::run() {
+template<class R, class N, class P>
+typename DFS<R,N,P>::CoreCSP* DFS<R,N,P>::run() {
 	if (log)
 		log->start();
 
-	const size_t& size = current_state.getSize();
+	std::vector<Tuple> edges;
+	current_state.getCSP().getEdges(edges);
 
+	current_state.trackChanges();
 	variables.clear();
-	for (size_t i = 0; i < size; i++)
-		for (size_t j = i+1; j < size; j++) {
-			const Tuple current = Tuple(i,j);
-			const R& value = current_state.getValue(current);
-			if (!current_state.getCalculus().isSplit(value))
-				variables.push_back(current);
-			else
-				number_implied_decisions++;
-		}
+	for (std::vector<Tuple>::const_iterator it = edges.begin(); it != edges.end(); ++it) {
+		const R& value = current_state.getValue(*it);
+		if (!current_state.getCalculus().isSplit(value))
+			addVariable(*it);
+		else
+			number_implied_decisions++;
+	}
 #ifndef NDEBUG
 std::cout << "Ignoring " << number_implied_decisions << " variables which are already tractable\n";
 #endif
 
 	const bool consistent = dfs();
+	if (stopped)
+		return NULL;
+
 	if (log) {
 		log->end();
 		generateLogReport();
@@ -216,8 +296,8 @@ std::cout << "Ignoring " << number_implied_decisions << " variables which are al
 	return NULL;
 }
 
-template<class R>
-void DFS<R>::generateLogReport(void) {
+template<class R, class N, class P>
+void DFS<R,N,P>::generateLogReport(void) {
 	assert(log);
 
 	branch_positive_decisions = 0;
@@ -58,6 +58,17 @@ class DFSReport {
 			  depth(0), unassigned_variables(0),
 			  visited_depth_min(0), visited_depth_max(0) {}
 
+		/** Nodes of the search tree visited so far, i.e., decisions made */
+		size_t getDecisions() const { return number_positive_decisions + number_negative_decisions + number_implied_decisions; }
+
+		/** Add the decisions and propagation calls of another search, e.g., one of several threads */
+		void addDecisions(const DFSReport& r) {
+			number_positive_decisions += r.number_positive_decisions;
+			number_negative_decisions += r.number_negative_decisions;
+			number_implied_decisions += r.number_implied_decisions;
+			propagation_calls += r.propagation_calls;
+		}
+
 	friend class ::Logger; // Logger may read data in here
 };
 
@@ -0,0 +1,91 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef INCREMENTAL_CLOSURE_H
+#define INCREMENTAL_CLOSURE_H
+
+#include <vector>
+
+#include "gqrtl/CSP.h"
+#include "gqrtl/CSPStack.h"
+#include "gqrtl/WeightedTripleIterator.h"
+
+/**
+ * An algebraically closed network that is refined one constraint at a time.
+ *
+ * The network is closed once on construction. Afterwards, addConstraint()
+ * intersects a single edge and propagates from that edge only (see
+ * WeightedTripleIterator::enforce(csp,i,j)), hence the cost of an update
+ * depends on the edges it refines, not on the size of the network.
+ * Checkpoints record the state of the network on the trail of a CSPStack;
+ * rollback() undoes all refinements made since a checkpoint.
+ */
+
+namespace gqrtl {
+
+template<class R, class C>
+class IncrementalClosure {
+	private:
+		CSPStack<R, C> network;
+		WeightedTripleIterator<R, CSPStack<R, C> > propagation;
+
+		/** False once an edge became empty */
+		bool consistent;
+
+		/** Value of consistent when each checkpoint was taken, oldest first */
+		std::vector<bool> checkpoints;
+
+	public:
+		/** Copy input and enforce algebraic closure on it */
+		IncrementalClosure(const CSP<R, C>& input);
+
+		/** @return true iff the network is algebraically closed, i.e., no edge became empty */
+		bool isConsistent() const { return consistent; }
+
+		/**
+		 * Intersect R_{ij} with r and enforce algebraic closure from (i,j).
+		 * An inconsistent network is not changed any more until rollback().
+		 * @return isConsistent()
+		 */
+		bool addConstraint(const size_t i, const size_t j, const R& r);
+
+		/** Remember the current state. @return the id of the checkpoint */
+		size_t checkpoint();
+
+		/**
+		 * Restore the state of checkpoint id; the checkpoint and all later ones are removed.
+		 * @return false iff there is no such checkpoint
+		 */
+		bool rollback(const size_t id);
+
+		/** Number of checkpoints that can be rolled back to */
+		size_t getCheckpoints() const { return checkpoints.size(); }
+
+		inline typename CSP<R, C>::const_reference getConstraint(const size_t i, const size_t j) const { return network.getConstraint(i, j); }
+		const size_t getSize() const { return network.getSize(); }
+		const C& getCalculus() const { return network.getCalculus(); }
+		const CSP<R, C>& getCSP() { return network.getCSP(); }
+};
+
+}
+
+#include "gqrtl/IncrementalClosure.tcc"
+
+#endif // INCREMENTAL_CLOSURE_H
@@ -0,0 +1,70 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#include <cassert>
+
+namespace gqrtl {
+
+template<class R, class C>
+IncrementalClosure<R,C>::IncrementalClosure(const CSP<R, C>& input) : network(input) {
+	consistent = propagation.enforce(network).empty();
+}
+
+template<class R, class C>
+bool IncrementalClosure<R,C>::addConstraint(const size_t i, const size_t j, const R& r) {
+	assert(i < getSize() && j < getSize());
+	if (!consistent)
+		return false;
+
+	const R old = network.getConstraint(i, j);
+	const R refined = old & r;
+	if (refined == old)
+		return true;
+
+	network.setConstraint(i, j, refined);
+	if (i == j) // the identity relation can only become empty
+		consistent = !refined.none();
+	else
+		consistent = propagation.enforce(network, i, j).empty();
+
+	return consistent;
+}
+
+template<class R, class C>
+size_t IncrementalClosure<R,C>::checkpoint() {
+	network.backupState();
+	checkpoints.push_back(consistent);
+	return checkpoints.size() - 1;
+}
+
+template<class R, class C>
+bool IncrementalClosure<R,C>::rollback(const size_t id) {
+	if (id >= checkpoints.size())
+		return false;
+
+	while (checkpoints.size() > id) {
+		network.resetToLastState();
+		consistent = checkpoints.back();
+		checkpoints.pop_back();
+	}
+	return true;
+}
+
+}
@@ -23,23 +23,45 @@
 
 #include <cassert>
 #include <string>
-#include <list>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 #include "Tuple.h"
 
-#include "gqrtl/HashMap.h"
+#include "gqrtl/StampSet.h"
 
 namespace gqrtl {
 
+/**
+ * Database of nogoods, propagated by two watched atoms per nogood.
+ *
+ * The atoms of all nogoods are stored contiguously in one arena, a nogood is
+ * a range of it. Watch lists hold the indices of the nogoods and are compacted
+ * in place while they are checked. The atoms of a nogood are reordered (the
+ * watched ones first) when the nogood is first checked in a propagation.
+ *
+ * Once the database holds more than a limit of nogoods, manageNogoods removes
+ * the worst ones in bulk until half of the limit is left. Nogoods are ranked
+ * by their activity per atom: a nogood is bumped whenever it reduces the
+ * network, and the bump grows by 1/decay per restart, so that older uses
+ * count less. The atoms of a nogood are decisions of distinct levels, hence
+ * its size is also its number of decision levels; nogoods of two atoms are
+ * never removed, nor are those learned at the latest restart. The limit is
+ * multiplied by the growth factor after each reduction.
+ */
 template<class R>
 class NogoodDB {
 	public:
 		typedef std::vector<std::pair<Tuple, R> > nogood;
 	protected:
+		/** Position of edge t, t.x <= t.y, in the upper triangle of the network */
+		inline size_t getEdge(const Tuple& t) const {
+			return t.y+t.x*network_size - (t.x*(t.x+1))/2;
+		}
+
 		inline size_t getPos(const Tuple& t, const size_t b) const {
-			return (t.y+t.x*network_size - (t.x*(t.x+1))/2)*calculus_size+b;
+			return getEdge(t)*calculus_size+b;
 		}
 
 		typedef CSPStack<R, CalculusOperations<R> > CoreCSPStack;
@@ -61,32 +83,91 @@ class NogoodDB {
 
 		class nogoodNode {
 			public:
-				nogood ng;
+				/** atoms arena[start], ..., arena[start+size-1] */
+				size_t start;
+				size_t size;
 				watchedAtoms wa;
 				size_t idx_1; // first wa index (in ng)
 				size_t idx_2; // second wa index (in ng)
+				/** activity, bumped whenever the nogood reduces the network */
 				double used;
-				nogoodNode(const nogood& ng, const watchedAtoms at, const size_t i1, const size_t i2)
-					: ng(ng), wa(at), idx_1(i1), idx_2(i2), used(0) {};
-
-				friend std::ostream& operator<<(std::ostream& os, const nogoodNode& n) {
-					os << "WAtoms: " << n.wa.first << "\t" << n.wa.second << "\n";
-					for (size_t i = 0; i < n.ng.size(); i++) {
-						const R& r = n.ng[i].second;
-						os << n.ng[i].first << "<-" << r << " and ";
-					}
-					os << "T -> UNSAT\n";
-					return os;
+				/** propagation in which the atoms were last reordered */
+				size_t epoch;
+				nogoodNode(const size_t s, const size_t n, const watchedAtoms at, const size_t i1, const size_t i2, const size_t e)
+					: start(s), size(n), wa(at), idx_1(i1), idx_2(i2), used(0), epoch(e) {};
+		};
+
+		/** Orders nogoods by activity per atom, the least active first; older ones first on ties */
+		class lessActive {
+			private:
+				const std::vector<nogoodNode>& nogoods;
+			public:
+				lessActive(const std::vector<nogoodNode>& n) : nogoods(n) {}
+				bool operator()(const size_t a, const size_t b) const {
+					const double qa = nogoods[a].used / nogoods[a].size;
+					const double qb = nogoods[b].used / nogoods[b].size;
+					return qa < qb || (qa == qb && a < b);
 				}
 		};
 
+		/** Atoms of all nogoods */
+		std::vector<std::pair<Tuple, R> > arena;
+		/** Nogoods in the order they were added */
+		std::vector<nogoodNode> nogoods;
+		/** Indices of the nogoods watching base relation b of edge t at watched_atoms[getEdge(t)][b]; empty for edges never watched */
+		std::vector<std::vector<std::vector<size_t> > > watched_atoms;
+		/** Base relations of each edge that are (or were) watched */
+		std::vector<R> watched_bits;
+
+		inline std::vector<size_t>& watchers(const Tuple& t, const size_t b) {
+			const size_t e = getEdge(t);
+			std::vector<std::vector<size_t> >& edge = watched_atoms[e];
+			if (edge.empty())
+				edge.resize(calculus_size);
+			watched_bits[e].set(b);
+			return edge[b];
+		}
+
+		/** Counts the propagations; a nogood is reordered once per propagation */
+		size_t epoch;
+
+		/** Move the watched atoms of the nogood to the front, once per propagation */
+		inline void reorder(nogoodNode& n) {
+			if (n.epoch == epoch)
+				return;
+			n.epoch = epoch;
+			if (n.idx_1 < 2 && n.idx_2 < 2)
+				return;
+
+			std::swap(arena[n.start], arena[n.start+n.idx_1]);
+			n.idx_1 = 0;
+			std::swap(arena[n.start+1], arena[n.start+n.idx_2]);
+			n.idx_2 = 1;
+		}
+
+		void printNogood(std::ostream& os, const nogoodNode& n) const {
+			os << "WAtoms: " << n.wa.first << "\t" << n.wa.second << "\n";
+			for (size_t i = 0; i < n.size; i++) {
+				const R& r = arena[n.start+i].second;
+				os << arena[n.start+i].first << "<-" << r << " and ";
+			}
+			os << "T -> UNSAT\n";
+		}
 
-		std::list<nogoodNode> nogoods;
-		HashMap<std::list<nogoodNode*> > watched_atoms;
+		// avoid checking removed values twice (cleared by startPropagation)
+		StampSet processed_labels;
 
-		// avoid checking removed values twice
-		HashMap<bool> processed_labels; // TODO: could be a hash set
-		std::vector<size_t> undo_processed;
+		/** Reduce the database when it holds more than maxNogoods nogoods */
+		size_t maxNogoods;
+		const double growth;
+		const double decay;
+		/** Current bump of the activity */
+		double activityInc;
+		/** Nogoods learned after the latest call of manageNogoods start here */
+		size_t firstRecent;
+
+		/** Remove the marked nogoods, keeping the order of the others */
+		void removeNogoods(const std::vector<bool>& removed);
 
 	public:
 		void startPropagation();
@@ -98,11 +179,18 @@ class NogoodDB {
 		inline bool check(const Tuple& t, const size_t b) const {
 			assert(b < calculus_size);
 
-			const size_t mempos = getPos(t, b);
-			return !(watched_atoms[mempos].empty() || processed_labels[mempos]);
+			const std::vector<std::vector<size_t> >& edge = watched_atoms[getEdge(t)];
+			return !(edge.empty() || edge[b].empty() || processed_labels.contains(getPos(t, b)));
+		}
+
+		/** @return false if check(t, b) is false for all base relations b not in value, the current constraint of t */
+		inline bool mayCheck(const Tuple& t, const R& value) const {
+			return !watched_bits[getEdge(t)].isSubsetOf(value);
 		}
 
-		inline std::vector<Tuple> checkNogoods(const Tuple t, const size_t b, CoreCSPStack& csp, PriorityQueue& queue);
+		/** Q is the queue of the propagator (PriorityQueue or BucketQueue) */
+		template<class Q>
+		inline std::vector<Tuple> checkNogoods(const Tuple t, const size_t b, CoreCSPStack& csp, Q& queue);
 
         // statistics on usefulness of nogoods
         size_t nr_singleton_ng;
@@ -110,10 +198,20 @@ class NogoodDB {
         size_t nr_nogoods_notminimized;
     protected:
         size_t nr_reductions; // how often nogoods reduced the network
+        size_t nr_db_reductions; // how often the database was reduced
+        size_t nr_removed;
 
     public:
-        NogoodDB(const size_t nodes, const size_t base_relations) : network_size(nodes), calculus_size(base_relations) {
+        NogoodDB(const size_t nodes, const size_t base_relations, const size_t limit = 4096, const double g = 1.1, const double d = 0.95)
+            : network_size(nodes), calculus_size(base_relations),
+            watched_atoms((nodes*(nodes+1))/2), watched_bits((nodes*(nodes+1))/2), epoch(0),
+            processed_labels((nodes*(nodes+1))/2*base_relations),
+            maxNogoods(limit), growth(g), decay(d), activityInc(1.0), firstRecent(0) {
+            assert(growth >= 1.0);
+            assert(decay > 0.0 && decay <= 1.0);
             nr_reductions = 0;
+            nr_db_reductions = 0;
+            nr_removed = 0;
             nr_singleton_ng = 0;
             nr_nogoods_minimized = 0;
             nr_nogoods_notminimized = 0;
@@ -126,9 +224,8 @@ class NogoodDB {
         #ifndef NDEBUG
         friend std::ostream& operator<<(std::ostream& os, const NogoodDB& db) {
             os << "(s) NogoodDB (" << db.nogoods.size() << ")\n";
-            typename std::list<nogoodNode>::const_iterator it = db.nogoods.begin();
-            for (; it != db.nogoods.end(); it++)
-                os << *it;
+            for (size_t i = 0; i < db.nogoods.size(); i++)
+                db.printNogood(os, db.nogoods[i]);
             os << "(e) NogoodDB\n";
             return os;
         }
@@ -82,66 +82,119 @@ template<class R> void NogoodDB<R>::addNogood(const typename NogoodDB<R>::nogood
 	const watchedAtom a(v, value1);
 	const watchedAtom b(vp, value2);
 
-	nogoods.push_back(nogoodNode(ng, std::make_pair(a, b), 0, 1));
-	nogoods.back().used = 1.0;
+	const size_t index = nogoods.size();
+	nogoods.push_back(nogoodNode(arena.size(), ng.size(), std::make_pair(a, b), 0, 1, epoch));
+	nogoods.back().used = activityInc;
+	arena.insert(arena.end(), ng.begin(), ng.end());
 
-	watched_atoms.insert(getPos(v , value1)).first->push_back(&(nogoods.back()));
-	watched_atoms.insert(getPos(vp, value2)).first->push_back(&(nogoods.back()));
+	watchers(v, value1).push_back(index);
+	watchers(vp, value2).push_back(index);
 }
 
 
 template<class R> void NogoodDB<R>::manageNogoods() {
-	const size_t maxNogoods = 4096; // TODO make configurable
-
-	while(nogoods.size() > maxNogoods) {
-		double min = std::numeric_limits<double>::max();
-		typename std::list<nogoodNode>::iterator c = nogoods.end();
-		size_t i = 0;
-		for (typename std::list<nogoodNode>::iterator it = nogoods.begin(); it != nogoods.end(); ++it, ++i) {
-			if (i == maxNogoods) break;
-			if (it->used < min) {
-				c = it;
-				min = it->used;
-			}
+	// decay: later uses are bumped more; rescale before the activities overflow
+	activityInc /= decay;
+	if (activityInc > 1e100) {
+		for (size_t i = 0; i < nogoods.size(); i++)
+			nogoods[i].used *= 1e-100;
+		activityInc *= 1e-100;
+	}
+
+	if (nogoods.size() > maxNogoods) {
+		std::vector<size_t> candidates;
+		for (size_t i = 0; i < firstRecent; i++)
+			if (nogoods[i].size > 2)
+				candidates.push_back(i);
+
+		// remove the least active candidates until half of the limit is left
+		const size_t count = std::min(nogoods.size() - maxNogoods/2, candidates.size());
+		std::nth_element(candidates.begin(), candidates.begin()+count, candidates.end(), lessActive(nogoods));
+
+		std::vector<bool> removed(nogoods.size(), false);
+		for (size_t i = 0; i < count; i++)
+			removed[candidates[i]] = true;
+		removeNogoods(removed);
+
+		nr_db_reductions++;
+		nr_removed += count;
+		maxNogoods = std::max<size_t>(maxNogoods, (size_t) (maxNogoods * growth));
+	}
+
+	firstRecent = nogoods.size();
+}
+
+template<class R> void NogoodDB<R>::removeNogoods(const std::vector<bool>& removed) {
+	assert(removed.size() == nogoods.size());
+
+	// compact the arena and the nogoods, keeping their order
+	std::vector<size_t> newIndex(nogoods.size());
+	size_t kept = 0, atoms = 0;
+	for (size_t i = 0; i < nogoods.size(); i++) {
+		if (removed[i])
+			continue;
+		nogoodNode n = nogoods[i];
+		std::copy(arena.begin()+n.start, arena.begin()+n.start+n.size, arena.begin()+atoms);
+		n.start = atoms;
+		atoms += n.size;
+		nogoods[kept] = n;
+		newIndex[i] = kept++;
+	}
+	nogoods.erase(nogoods.begin()+kept, nogoods.end());
+	arena.erase(arena.begin()+atoms, arena.end());
+
+	// renumber the watch lists, drop the removed nogoods
+	for (size_t e = 0; e < watched_atoms.size(); e++) {
+		if (watched_atoms[e].empty())
+			continue;
+		watched_bits[e] = R();
+		for (size_t b = 0; b < calculus_size; b++) {
+			std::vector<size_t>& list = watched_atoms[e][b];
+			size_t j = 0;
+			for (size_t i = 0; i < list.size(); i++)
+				if (!removed[list[i]])
+					list[j++] = newIndex[list[i]];
+			list.resize(j);
+			if (j > 0)
+				watched_bits[e].set(b);
 		}
-		assert(c != nogoods.end());
-		watched_atoms[getPos(c->wa.first.tuple, c->wa.first.bit)].remove(&(*c));
-		watched_atoms[getPos(c->wa.second.tuple, c->wa.second.bit)].remove(&(*c));
-		nogoods.erase(c);
 	}
 }
 
 template<class R>
-std::vector<Tuple> NogoodDB<R>::checkNogoods(const Tuple v, const size_t d, CoreCSPStack& csp, PriorityQueue& queue) {
+template<class Q>
+std::vector<Tuple> NogoodDB<R>::checkNogoods(const Tuple v, const size_t d, CoreCSPStack& csp, Q& queue) {
 	assert(!csp.getValue(v)[d]);	// d was removed from dom(v)
 
-	assert(processed_labels[getPos(v,d)] == false);
+	assert(!processed_labels.contains(getPos(v,d)));
 
-	*(processed_labels.insert(getPos(v,d)).first) = true;
-	undo_processed.push_back(getPos(v,d));
+	processed_labels.insert(getPos(v,d));
 
-	std::list<nogoodNode*> list = watched_atoms[getPos(v, d)];
-	for (typename std::list<nogoodNode*>::iterator it_wa = list.begin(); it_wa != list.end();) {
-		typename std::list<nogoodNode*>::iterator current = it_wa;
-		it_wa++;
+	// the nogoods that keep watching (v,d) are moved to the front of the list;
+	// the loop only adds watchers of other labels
+	std::vector<size_t>& list = watchers(v, d);
+	size_t kept = 0;
+	for (size_t w = 0; w < list.size(); w++) {
+		nogoodNode& current = nogoods[list[w]];
+		reorder(current);
 
 		// identify watched atom and "the other" watched atom
-		watchedAtom* wa = &((*current)->wa.first);
-		watchedAtom* o_wa = &((*current)->wa.second);
-		size_t* index = &((*current)->idx_1);
-		size_t* o_index = &((*current)->idx_2);
+		watchedAtom* wa = &(current.wa.first);
+		watchedAtom* o_wa = &(current.wa.second);
+		size_t* index = &(current.idx_1);
+		size_t* o_index = &(current.idx_2);
 
-		if ((*current)->wa.second.tuple == v) {
-			assert((*current)->wa.second.bit == d);
+		if (current.wa.second.tuple == v) {
+			assert(current.wa.second.bit == d);
 
 			std::swap(wa, o_wa);
 			std::swap(index, o_index);
 		}
 		else {
-			assert((*current)->wa.first.tuple == v && (*current)->wa.first.bit == d);
+			assert(current.wa.first.tuple == v && current.wa.first.bit == d);
 		}
 
-		const nogood& ng = (*current)->ng;
+		const std::pair<Tuple, R>* ng = &arena[current.start];
 
 		// easy access
 		const Tuple& vp = o_wa->tuple;
@@ -149,8 +202,10 @@ std::vector<Tuple> NogoodDB<R>::checkNogoods(const Tuple v, const size_t d, Core
 
 		const R& dom_vp = csp.getValue(vp);
 
-		if ( (dom_vp & Dp).none() ) // CSP already avoids the Dp decision
+		if ( (dom_vp & Dp).none() ) { // CSP already avoids the Dp decision
+			list[kept++] = list[w];
 			continue;
+		}
 
 		// try updating on v before iterating rest of nogood
 		{
@@ -161,8 +216,8 @@ std::vector<Tuple> NogoodDB<R>::checkNogoods(const Tuple v, const size_t d, Core
 					if (!D[*it]) {
 						wa->bit = *it;
 
-						watched_atoms.insert(getPos(v, *it)).first->push_back(*current);
-						list.erase(current);
+						assert(*it != d);
+						watchers(v, *it).push_back(list[w]);
 						break;
 					}
 				continue;
@@ -170,7 +225,7 @@ std::vector<Tuple> NogoodDB<R>::checkNogoods(const Tuple v, const size_t d, Core
 		}
 
 		bool updated = false;
-		for (size_t l = std::max(*index, *o_index)+1; l < ng.size(); l++) {
+		for (size_t l = std::max(*index, *o_index)+1; l < current.size; l++) {
 			const Tuple& vpp = ng[l].first;
 			const R& Dpp = ng[l].second;
 
@@ -184,8 +239,8 @@ std::vector<Tuple> NogoodDB<R>::checkNogoods(const Tuple v, const size_t d, Core
 						wa->bit = *it;
 						*index = l;
 
-						watched_atoms.insert(getPos(vpp, *it)).first->push_back(*current);
-						list.erase(current);
+						assert(vpp != v || *it != d);
+						watchers(vpp, *it).push_back(list[w]);
 						break;
 					}
 
@@ -199,64 +254,56 @@ std::vector<Tuple> NogoodDB<R>::checkNogoods(const Tuple v, const size_t d, Core
 
 			assert( !(dom_vp & Dp).none() );
 			assert( !csp.getValue(wa->tuple).isSubsetOf(ng[*index].second) );
+			continue;
 		}
-		else {
+
 #ifndef NDEBUG
-			size_t sat = 0;
-			for (size_t i = 0; i < ng.size(); ++i)
-				if (csp.getValue(ng[i].first).isSubsetOf(ng[i].second))
-					sat++;
-
-			const size_t unsat = ng.size() - sat;
-			if (unsat > 1) {
-				std::cerr << "Wrong nogood application\n";
-				std::cerr << unsat << " unsat elements\n";
-				std::cerr << *index << ", " << *o_index << std::endl;
-				for (size_t i = 0; i < ng.size(); ++i) {
-					std::cerr << ng[i].first << "<-" << ng[i].second;
-					std::cerr << " is currently " << csp.getValue(ng[i].first);
-					std::cerr << std::endl;
-				}
+		size_t sat = 0;
+		for (size_t i = 0; i < current.size; ++i)
+			if (csp.getValue(ng[i].first).isSubsetOf(ng[i].second))
+				sat++;
+
+		const size_t unsat = current.size - sat;
+		if (unsat > 1) {
+			std::cerr << "Wrong nogood application\n";
+			std::cerr << unsat << " unsat elements\n";
+			std::cerr << *index << ", " << *o_index << std::endl;
+			for (size_t i = 0; i < current.size; ++i) {
+				std::cerr << ng[i].first << "<-" << ng[i].second;
+				std::cerr << " is currently " << csp.getValue(ng[i].first);
+				std::cerr << std::endl;
 			}
-			assert(unsat <= 1);
+		}
+		assert(unsat <= 1);
 #endif
-			nr_reductions++;
-			(*current)->used += 1.0;
-
-			const R Dp_excluded = csp.getCalculus().getNegation(Dp);
-			csp.setValue(vp, csp.getValue(vp) & Dp_excluded);
-			queue.insert(vp.x*csp.getSize()+vp.y, csp.getCalculus().getWeight(csp.getValue(vp)));
-			if (csp.getValue(vp).none()) {
-				std::swap(watched_atoms[getPos(v, d)],list); // update watched literals on v,d
-				std::vector<Tuple> failed_constraint;
-				for (size_t l = 0; l < ng.size(); l++)
-					failed_constraint.push_back(ng[l].first);
-				return failed_constraint;
-			}
+		list[kept++] = list[w];
+		nr_reductions++;
+		current.used += activityInc;
+
+		const R Dp_excluded = csp.getCalculus().getNegation(Dp);
+		csp.setValue(vp, csp.getValue(vp) & Dp_excluded);
+		queue.insert(vp.x*csp.getSize()+vp.y, csp.getCalculus().getWeight(csp.getValue(vp)));
+		if (csp.getValue(vp).none()) {
+			// keep the nogoods not checked yet
+			for (w++; w < list.size(); w++)
+				list[kept++] = list[w];
+			list.resize(kept);
+
+			std::vector<Tuple> failed_constraint;
+			for (size_t l = 0; l < current.size; l++)
+				failed_constraint.push_back(ng[l].first);
+			return failed_constraint;
 		}
 	}
 
-	std::swap(watched_atoms[getPos(v, d)],list); // update watched literals on v,d
+	list.resize(kept);
 	return std::vector<Tuple>();
 }
 
 template<class R>
 void NogoodDB<R>::startPropagation() {
-	for (size_t i = 0; i < undo_processed.size(); ++i) {
-		processed_labels[undo_processed[i]] = false;
-	}
-	undo_processed.clear();
-
-	// TODO: think about optimizing
-	for (typename std::list<nogoodNode>::iterator it = nogoods.begin(); it != nogoods.end(); ++it) {
-		if (it->idx_1 < 2 && it->idx_2 < 2)
-			continue;
-
-		std::swap(it->ng[0], it->ng[it->idx_1]);
-		it->idx_1 = 0;
-		std::swap(it->ng[1], it->ng[it->idx_2]);
-		it->idx_2 = 1;
-	}
+	processed_labels.clear();
+	epoch++;
 }
 
 template<class R>
@@ -271,14 +318,16 @@ void NogoodDB<R>::printStatistics() const {
 	std::cout << "\tNogoods propagation; ";
 	std::cout << "domain reductions=" << nr_reductions;
 	std::cout << ", singleton nogoods=" << nr_singleton_ng;
+	std::cout << "\n\tDatabase reductions=" << nr_db_reductions;
+	std::cout << ", removed nogoods=" << nr_removed << ", limit=" << maxNogoods;
 	std::cout << std::endl << std::flush;
 }
 
 #ifndef NDEBUG
 template<class R>
 bool NogoodDB<R>::allNogoodsApplied(const CoreCSPStack& csp) const {
-	for (typename std::list<nogoodNode>::const_iterator it = nogoods.begin(); it != nogoods.end(); it++) {
-		const nogood& ng = it->ng;
+	for (typename std::vector<nogoodNode>::const_iterator it = nogoods.begin(); it != nogoods.end(); it++) {
+		const nogood ng(arena.begin()+it->start, arena.begin()+it->start+it->size);
 
 		assert(ng[it->idx_1].first == it->wa.first.tuple);
 		assert(ng[it->idx_2].first == it->wa.second.tuple);
@@ -324,7 +373,8 @@ bool NogoodDB<R>::allNogoodsApplied(const CoreCSPStack& csp) const {
 				else
 					std::cerr << "\twatched atom 2 is not valid anymore\n";
 
-				std::cerr << *it << "\n";
+				printNogood(std::cerr, *it);
+				std::cerr << "\n";
 				return false;
 			}
 		}
@@ -0,0 +1,108 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef PARALLEL_TRIPLE_ITERATOR_H
+#define PARALLEL_TRIPLE_ITERATOR_H
+
+#include <vector>
+
+#include <pthread.h>
+
+#include "Tuple.h"
+#include "PriorityQueue.h"
+
+/**
+ * Algebraic closure computed by several threads (POSIX threads).
+ *
+ * The weighted queue of WeightedTripleIterator is processed in rounds: the
+ * lightest queued edges form a batch, whose triangles are revised by all threads
+ * on the network as it was at the start of the round. The refinements are then
+ * merged into the network, each edge by the one thread that owns it, by
+ * intersection; edges that changed are queued again. As algebraic closure is the
+ * unique largest closed subnetwork, the result is the same as the one of
+ * WeightedTripleIterator.
+ *
+ * The calculus must be safe for concurrent reads, i.e., a CalculusOperations
+ * object must not use a composition cache. N must not keep a trail (CSPStack).
+ * The queue Q is PriorityQueue or BucketQueue.
+ */
+
+namespace gqrtl {
+
+template<class R, class N, class Q = PriorityQueue> class ParallelTripleIterator {
+  private:
+    /** Refinement of edge (x,y), x <= y */
+    struct Update {
+	size_t x, y;
+	R r;
+	Update(const size_t a, const size_t b, const R& s) : x(a), y(b), r(s) {}
+    };
+
+    /** Requested and running threads */
+    const size_t threads;
+    size_t active;
+
+    /** Number of queued edges revised per thread and round */
+    static const size_t batchPerThread = 16;
+
+    Q queue;
+
+    /** State shared by the threads during enforce */
+    N* csp;
+    std::vector<Tuple> batch;
+    bool done;
+    /** updates[t][o]: refinements found by thread t of edges owned by thread o */
+    std::vector<std::vector<std::vector<Update> > > updates;
+    /** Edges changed by their owner in the current round */
+    std::vector<std::vector<Tuple> > changed;
+    /** An edge that became empty, per owner (InvalidTuple if none) */
+    std::vector<Tuple> failed;
+    pthread_barrier_t barrier;
+    pthread_mutex_t start;
+
+    struct Worker {
+	ParallelTripleIterator* self;
+	size_t thread;
+    };
+    static void* run(void* worker);
+    void work(const size_t thread);
+
+    inline size_t owner(const size_t x, const size_t y) const;
+    inline void addUpdate(const size_t thread, const size_t x, const size_t y, const R& r);
+    void revise(const size_t thread);
+    void merge(const size_t thread);
+    /** Queue changed edges and pick the next batch; run by thread 0 */
+    void schedule();
+
+    inline void add_to_queue(size_t i, size_t j);
+
+  public:
+    /** @param t number of threads (at least 1) */
+    ParallelTripleIterator(const size_t t);
+
+    /** Enforce algebraic closure to CSP. @return empty iff the network is closed, else an edge that became empty */
+    std::vector<Tuple> enforce(N& csp);
+};
+
+}
+
+#include "gqrtl/ParallelTripleIterator.tcc"
+
+#endif // PARALLEL_TRIPLE_ITERATOR_H
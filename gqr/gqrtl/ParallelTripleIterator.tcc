@@ -0,0 +1,208 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#include <cassert>
+#include <algorithm>
+
+namespace gqrtl {
+
+template<class R, class N, class Q>
+ParallelTripleIterator<R,N,Q>::ParallelTripleIterator(const size_t t) :
+    threads(t > 0 ? t : 1), active(1), csp(NULL), done(false),
+    updates(threads, std::vector<std::vector<Update> >(threads)),
+    changed(threads), failed(threads, InvalidTuple) {}
+
+template<class R, class N, class Q>
+inline
+size_t ParallelTripleIterator<R,N,Q>::owner(const size_t x, const size_t y) const {
+    return (x * csp->getSize() + y) % active;
+}
+
+template<class R, class N, class Q>
+inline
+void ParallelTripleIterator<R,N,Q>::addUpdate(const size_t thread, const size_t x, const size_t y, const R& r) {
+    if (x <= y)
+	updates[thread][owner(x, y)].push_back(Update(x, y, r));
+    else
+	updates[thread][owner(y, x)].push_back(Update(y, x, csp->getCalculus().getConverse(r)));
+}
+
+template<class R, class N, class Q>
+void ParallelTripleIterator<R,N,Q>::revise(const size_t thread) {
+    const size_t size = csp->getSize();
+
+    for (size_t b = thread; b < batch.size(); b += active) {
+	const size_t i = batch[b].x;
+	const size_t j = batch[b].y;
+	const R ij = csp->getConstraint(i, j);
+
+	for (size_t k = 0; k < size; ++k) {
+	    // R_{ik} = R_{ik} cap ( R_{ij} comp R_{jk} )
+	    const R ik = csp->getConstraint(i, k);
+	    const R newIk = ik & csp->getCalculus().getComposition(ij, csp->getConstraint(j, k));
+	    if (newIk != ik)
+		addUpdate(thread, i, k, newIk);
+
+	    // R_{kj} = R_{kj} cap ( R_{ki} comp R_{ij} )
+	    const R kj = csp->getConstraint(k, j);
+	    const R newKj = kj & csp->getCalculus().getComposition(csp->getConstraint(k, i), ij);
+	    if (newKj != kj)
+		addUpdate(thread, k, j, newKj);
+	}
+    }
+}
+
+template<class R, class N, class Q>
+void ParallelTripleIterator<R,N,Q>::merge(const size_t thread) {
+    changed[thread].clear();
+
+    for (size_t p = 0; p < active; p++) {
+	std::vector<Update>& u = updates[p][thread];
+	for (typename std::vector<Update>::const_iterator it = u.begin(); it != u.end(); ++it) {
+	    const R old = csp->getConstraint(it->x, it->y);
+	    const R r = old & it->r;
+	    if (r == old)
+		continue;
+
+	    csp->setConstraint(it->x, it->y, r);
+	    if (r.none())
+		failed[thread] = Tuple(it->x, it->y);
+	    else if (it->x != it->y)	// the identity relation can only become empty
+		changed[thread].push_back(Tuple(it->x, it->y));
+	}
+	u.clear();
+    }
+}
+
+template<class R, class N, class Q>
+inline
+void ParallelTripleIterator<R,N,Q>::add_to_queue(size_t i, size_t j) {
+    assert (i != j);
+    if (j < i)
+	std::swap(i, j);
+
+    const size_t nindex = i*csp->getSize()+j;
+    queue.insert(nindex, csp->getCalculus().getWeight(csp->getConstraint(i, j)));
+}
+
+template<class R, class N, class Q>
+void ParallelTripleIterator<R,N,Q>::schedule() {
+    for (size_t t = 0; t < active; t++) {
+	if (failed[t] != InvalidTuple)
+	    done = true;
+	for (std::vector<Tuple>::const_iterator it = changed[t].begin(); it != changed[t].end(); ++it)
+	    add_to_queue(it->x, it->y);
+	changed[t].clear();
+    }
+
+    batch.clear();
+    const size_t size = csp->getSize();
+    while (!done && !queue.empty() && batch.size() < batchPerThread * active) {
+	const size_t index = queue.peekMin().first;
+	queue.popMin();
+	batch.push_back(Tuple(index / size, index % size));
+    }
+
+    if (batch.empty())
+	done = true;
+}
+
+template<class R, class N, class Q>
+void ParallelTripleIterator<R,N,Q>::work(const size_t thread) {
+    while (true) {
+	if (thread == 0)
+	    schedule();
+	pthread_barrier_wait(&barrier);
+	if (done)
+	    break;
+
+	revise(thread);
+	pthread_barrier_wait(&barrier);
+
+	merge(thread);
+	pthread_barrier_wait(&barrier);
+    }
+}
+
+template<class R, class N, class Q>
+void* ParallelTripleIterator<R,N,Q>::run(void* w) {
+    Worker* worker = static_cast<Worker*>(w);
+    ParallelTripleIterator* self = worker->self;
+
+    // wait until all threads are created and the barrier is set up
+    pthread_mutex_lock(&self->start);
+    pthread_mutex_unlock(&self->start);
+
+    self->work(worker->thread);
+    return NULL;
+}
+
+template<class R, class N, class Q>
+std::vector<Tuple> ParallelTripleIterator<R,N,Q>::enforce(N& c) {
+    queue.clear();
+    csp = &c;
+    done = false;
+    active = 1;
+    std::fill(failed.begin(), failed.end(), InvalidTuple);
+
+    const size_t& size = csp->getSize();
+
+    if (size < 2) return std::vector<Tuple>();
+
+    if (csp->getConstraint(0, 1).none())
+	return std::vector<Tuple>(1, Tuple(0, 1));
+
+    for (size_t i = 0; i < size; i++) {
+	for (size_t j = i+1; j < size; j++) {
+	    if (csp->getCalculus().baseRelationsAreSerial() && csp->getConstraint(i, j) == csp->getCalculus().getUniversalRelation())
+		continue;
+	    add_to_queue(i, j);
+	}
+    }
+
+    // threads 1, ..., active-1 run work(); this thread is thread 0
+    std::vector<pthread_t> ids(threads);
+    std::vector<Worker> workers(threads);
+    pthread_mutex_init(&start, NULL);
+    pthread_mutex_lock(&start);
+    for (size_t t = 1; t < threads; t++) {
+	workers[t].self = this;
+	workers[t].thread = t;
+	if (pthread_create(&ids[t], NULL, run, &workers[t]) != 0)
+	    break;
+	active++;
+    }
+    pthread_barrier_init(&barrier, NULL, active);
+    pthread_mutex_unlock(&start);
+
+    work(0);
+
+    for (size_t t = 1; t < active; t++)
+	pthread_join(ids[t], NULL);
+    pthread_barrier_destroy(&barrier);
+    pthread_mutex_destroy(&start);
+
+    for (size_t t = 0; t < active; t++)
+	if (failed[t] != InvalidTuple)
+	    return std::vector<Tuple>(1, failed[t]);
+    return std::vector<Tuple>();
+}
+
+}
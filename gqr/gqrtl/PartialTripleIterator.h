@@ -0,0 +1,75 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef PARTIAL_TRIPLE_ITERATOR_H
+#define PARTIAL_TRIPLE_ITERATOR_H
+
+#include <vector>
+
+#include "Tuple.h"
+#include "ChordalGraph.h"
+#include "PriorityQueue.h"
+
+#include "gqrtl/ChordalCSP.h"
+#include "gqrtl/CSPStack.h"
+
+/**
+ * Partial path consistency: algebraic closure restricted to the triangles of
+ * the chordal graph of a ChordalCSP, with the weighted queue of
+ * WeightedTripleIterator. Dequeuing an edge only visits the common neighbours
+ * of its nodes, hence time and memory depend on the chordal graph and not on
+ * the square of the number of nodes.
+ *
+ * Refer to
+ * Assef Chmeiss, Jean-Francois Condotta:
+ * Consistency of Triangulated Temporal Qualitative Constraint Networks.
+ * ICTAI 2011, pages 799-802
+ *
+ * N is a ChordalCSP or a CSPStack of one. The queue Q is PriorityQueue or BucketQueue.
+ */
+
+namespace gqrtl {
+
+template<class R, class N, class Q = PriorityQueue> class PartialTripleIterator {
+  private:
+    Q queue;
+
+    /** Relation of edge id of the ChordalCSP (below the trail), see ChordalCSP::getEdgeConstraint */
+    static inline const R& getEdge(const N& csp, const size_t id, const bool converse);
+
+    inline void add_to_queue(const size_t id, const Tuple& t, const N& csp);
+
+    std::vector<Tuple> pc1(N& csp);
+
+    std::vector<Tuple> describeTriple(size_t i, size_t j, size_t k) const;
+
+  public:
+    /** Enforce partial path consistency to CSP. */
+    std::vector<Tuple> enforce(N& csp);
+
+    /** Enforce partial path consistency to CSP. Assume that csp \ R_{ij} is partially path consistent; (i,j) must be an edge of the graph. */
+    std::vector<Tuple> enforce(N& csp, const size_t i, const size_t j);
+};
+
+}
+
+#include "gqrtl/PartialTripleIterator.tcc"
+
+#endif // PARTIAL_TRIPLE_ITERATOR_H
@@ -0,0 +1,151 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#include <cassert>
+
+namespace gqrtl {
+
+/** The ChordalCSP itself or the one below a trail */
+template<class R, class C>
+inline const ChordalCSP<R, C>& getChordalCSP(const ChordalCSP<R, C>& csp) { return csp; }
+
+template<class R, class C>
+inline const ChordalCSP<R, C>& getChordalCSP(const CSPStack<R, C, ChordalCSP<R, C> >& csp) { return csp.getCSP(); }
+
+template<class R, class N, class Q>
+inline
+const R& PartialTripleIterator<R,N,Q>::getEdge(const N& csp, const size_t id, const bool converse) {
+    return getChordalCSP(csp).getEdgeConstraint(id, converse);
+}
+
+template<class R, class N, class Q>
+inline
+std::vector<Tuple> PartialTripleIterator<R,N,Q>::describeTriple(size_t i, size_t j, size_t k) const {
+	std::vector<Tuple> res;
+	res.reserve(3);
+	res.push_back(Tuple(i,j));
+	res.push_back(Tuple(i,k));
+	res.push_back(Tuple(j,k));
+	return res;
+}
+
+template<class R, class N, class Q>
+inline
+void PartialTripleIterator<R,N,Q>::add_to_queue(const size_t id, const Tuple& t, const N& csp) {
+    queue.insert(id, csp.getCalculus().getWeight(csp.getConstraint(t.x, t.y)));
+}
+
+template<class R, class N, class Q>
+std::vector<Tuple> PartialTripleIterator<R,N,Q>::pc1(N& csp) {
+    // read the edges by id, writes go through csp to keep the trail (if any)
+    const ChordalGraph& graph = getChordalCSP(csp).getGraph();
+
+    while (!queue.empty()) {
+        const size_t ij = queue.peekMin().first;
+        queue.popMin();
+
+        const size_t i = graph.getTuple(ij).x;
+        const size_t j = graph.getTuple(ij).y;
+        const std::vector<size_t>& ni = graph.getNeighbours(i);
+        const std::vector<size_t>& nj = graph.getNeighbours(j);
+
+        // the triangles of (i,j): merge the sorted neighbours of i and j
+        size_t a = 0, b = 0;
+        while (a < ni.size() && b < nj.size()) {
+            if (ni[a] < nj[b]) {
+                a++;
+                continue;
+            }
+            if (nj[b] < ni[a]) {
+                b++;
+                continue;
+            }
+
+            const size_t k = ni[a];
+            const size_t ik = graph.getEdgeIds(i)[a];
+            const size_t jk = graph.getEdgeIds(j)[b];
+
+            // R_{ik} = R_{ik} cap ( R_{ij} comp R_{jk} )
+            const R oldIk = getEdge(csp, ik, k < i);
+            const R newIk = oldIk & csp.getCalculus().getComposition(getEdge(csp, ij, false), getEdge(csp, jk, k < j));
+            if (newIk != oldIk) {
+                csp.setConstraint(i, k, newIk);
+                if (newIk.none())
+                    return describeTriple(i,j,k);
+                add_to_queue(ik, graph.getTuple(ik), csp);
+            }
+
+            // R_{kj} = R_{kj} cap ( R_{ki} comp R_{ij} )
+            const R oldKj = getEdge(csp, jk, j < k);
+            const R newKj = oldKj & csp.getCalculus().getComposition(getEdge(csp, ik, i < k), getEdge(csp, ij, false));
+            if (newKj != oldKj) {
+                csp.setConstraint(k, j, newKj);
+                if (newKj.none())
+                    return describeTriple(i,j,k);
+                add_to_queue(jk, graph.getTuple(jk), csp);
+            }
+            a++;
+            b++;
+        }
+    }
+
+    return std::vector<Tuple>();
+}
+
+template<class R, class N, class Q>
+std::vector<Tuple> PartialTripleIterator<R,N,Q>::enforce(N& csp) {
+    queue.clear();
+
+    const ChordalGraph& graph = getChordalCSP(csp).getGraph();
+
+    // no triangle involves the diagonal, hence check it here
+    for (size_t x = 0; x < graph.getSize(); x++)
+        if (csp.getConstraint(x, x).none())
+            return std::vector<Tuple>(1, Tuple(x, x));
+
+    for (size_t id = 0; id < graph.getEdges(); id++) {
+        const Tuple& t = graph.getTuple(id);
+        const R r = csp.getConstraint(t.x, t.y);
+        if (r.none())
+            return std::vector<Tuple>(1, t);
+        if (csp.getCalculus().baseRelationsAreSerial() && r == csp.getCalculus().getUniversalRelation())
+            continue;
+        add_to_queue(id, t, csp);
+    }
+
+    return pc1(csp);
+}
+
+template<class R, class N, class Q>
+std::vector<Tuple> PartialTripleIterator<R,N,Q>::enforce(N& csp, const size_t i, const size_t j) {
+    queue.clear();
+
+    if (csp.getConstraint(i, j).none())
+        return std::vector<Tuple>(1, Tuple(i, j));
+
+    const ChordalGraph& graph = getChordalCSP(csp).getGraph();
+    const size_t id = graph.getEdge(i, j);
+    assert(id != ChordalGraph::noEdge);
+    add_to_queue(id, graph.getTuple(id), csp);
+
+    return pc1(csp);
+}
+
+}
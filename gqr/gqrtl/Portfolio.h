@@ -0,0 +1,101 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include <vector>
+
+#include <pthread.h>
+
+#include "RestartsFramework.h"
+
+#include "gqrtl/CSP.h"
+#include "gqrtl/CalculusOperations.h"
+#include "gqrtl/DFS.h"
+#include "gqrtl/RestartingDFS.h"
+#include "gqrtl/StopFlag.h"
+
+/**
+ * Solves one network by several differently configured searches, each in a
+ * thread of its own (POSIX threads): 2-way DFS or RestartingDFS, with a seed
+ * for randomized value ordering and tie-breaking of the variables. The first
+ * search to answer wins; it raises a StopFlag, which the others poll.
+ *
+ * The calculus must be safe for concurrent reads, i.e., the CalculusOperations
+ * object must not use a composition cache.
+ */
+
+namespace gqrtl {
+
+template<class R>
+class Portfolio {
+	private:
+		typedef CSP<R, CalculusOperations<R> > CoreCSP;
+
+		const CoreCSP& csp;
+
+		struct Engine {
+			Portfolio* self;
+			/** Copy of the options; useRestarts selects RestartingDFS over DFS */
+			RestartsFramework* options;
+			size_t seed;
+			DFS<R>* dfs;
+			RestartingDFS<R>* restarting;
+		};
+		std::vector<Engine> engines;
+
+		StopFlag stop;
+
+		/** Guards winner and result */
+		pthread_mutex_t mutex;
+		size_t winner;
+		CoreCSP* result;
+
+		static void* run(void* engine);
+		void work(Engine& engine);
+
+		Portfolio(const Portfolio&);
+		Portfolio& operator=(const Portfolio&);
+
+	public:
+		Portfolio(const CoreCSP& csp);
+		~Portfolio();
+
+		/** Add a search; the options are copied, seed 0 keeps the deterministic orderings */
+		void addEngine(const RestartsFramework& options, const size_t seed);
+		size_t getNumberOfEngines() const { return engines.size(); }
+
+		/** Run all searches until the first answers. @return solution of the winner, NULL if the network is inconsistent */
+		CoreCSP* run();
+
+		/** @return index of the search which answered first; valid after run() */
+		size_t getWinner() const { return winner; }
+		/** @return true iff the winner restarts; valid after run() */
+		bool winnerRestarts() const { return engines[winner].restarting != NULL; }
+		/** @return the statistics of the winner; valid after run() */
+		const DFSReport& getWinnerReport() const;
+};
+
+}
+
+#include "gqrtl/Portfolio.tcc"
+
+#endif // PORTFOLIO_H
@@ -0,0 +1,121 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#include <cassert>
+
+namespace gqrtl {
+
+template<class R>
+Portfolio<R>::Portfolio(const CoreCSP& c) : csp(c), winner(0), result(NULL) {
+	pthread_mutex_init(&mutex, NULL);
+}
+
+template<class R>
+Portfolio<R>::~Portfolio() {
+	for (typename std::vector<Engine>::iterator it = engines.begin(); it != engines.end(); ++it) {
+		delete it->dfs;
+		delete it->restarting;
+		delete it->options;
+	}
+	pthread_mutex_destroy(&mutex);
+}
+
+template<class R>
+void Portfolio<R>::addEngine(const RestartsFramework& options, const size_t seed) {
+	Engine e;
+	e.self = this;
+	e.options = new RestartsFramework(options);
+	e.seed = seed;
+	e.dfs = NULL;
+	e.restarting = NULL;
+	engines.push_back(e);
+}
+
+template<class R>
+void* Portfolio<R>::run(void* e) {
+	Engine* engine = static_cast<Engine*>(e);
+	engine->self->work(*engine);
+	return NULL;
+}
+
+template<class R>
+void Portfolio<R>::work(Engine& engine) {
+	CoreCSP* res;
+	bool stopped;
+	if (engine.options->useRestarts) {
+		engine.restarting = new RestartingDFS<R>(csp, *engine.options, NULL);
+		engine.restarting->setSeed(engine.seed);
+		engine.restarting->setStopFlag(&stop);
+		res = engine.restarting->run();
+		stopped = engine.restarting->isStopped();
+	}
+	else {
+		engine.dfs = new DFS<R>(csp, NULL);
+		engine.dfs->setSeed(engine.seed);
+		engine.dfs->setStopFlag(&stop);
+		res = engine.dfs->run();
+		stopped = engine.dfs->isStopped();
+	}
+
+	if (stopped) {
+		assert(res == NULL);
+		return;
+	}
+
+	pthread_mutex_lock(&mutex);
+	if (!stop.isRaised()) {
+		winner = &engine - &engines[0];
+		result = res;
+		stop.raise();
+		res = NULL;
+	}
+	pthread_mutex_unlock(&mutex);
+	delete res; // answered too late
+}
+
+template<class R>
+typename Portfolio<R>::CoreCSP* Portfolio<R>::run() {
+	assert(!engines.empty());
+
+	// engine 0 runs in this thread
+	std::vector<pthread_t> ids(engines.size());
+	std::vector<bool> created(engines.size(), false);
+	for (size_t e = 1; e < engines.size(); e++)
+		created[e] = (pthread_create(&ids[e], NULL, run, &engines[e]) == 0);
+
+	work(engines[0]);
+
+	for (size_t e = 1; e < engines.size(); e++)
+		if (created[e])
+			pthread_join(ids[e], NULL);
+
+	assert(stop.isRaised());
+	return result;
+}
+
+template<class R>
+const DFSReport& Portfolio<R>::getWinnerReport() const {
+	const Engine& e = engines[winner];
+	if (e.restarting)
+		return *e.restarting;
+	return *e.dfs;
+}
+
+}
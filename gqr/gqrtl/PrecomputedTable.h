@@ -0,0 +1,89 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef PRECOMPUTED_TABLE_H
+#define PRECOMPUTED_TABLE_H
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace gqrtl {
+
+/**
+ * Array of precomputed values that is either computed (and owned) or
+ * refers to memory owned by someone else, e.g. a memory-mapped calculus cache.
+ * Only owned tables can be modified.
+ */
+template<class T>
+class PrecomputedTable {
+	private:
+		std::vector<T> owned;
+		const T* data;
+		size_t length;
+
+	public:
+		PrecomputedTable() : data(NULL), length(0) {}
+
+		PrecomputedTable(const PrecomputedTable& t) : owned(t.owned), data(t.data), length(t.length) {
+			if (!owned.empty())
+				data = &owned[0];
+		}
+
+		PrecomputedTable& operator=(const PrecomputedTable& t) {
+			owned = t.owned;
+			data = owned.empty() ? t.data : &owned[0];
+			length = t.length;
+			return *this;
+		}
+
+		/** Allocate an owned table of n default constructed values */
+		void resize(const size_t n) {
+			owned.assign(n, T());
+			data = owned.empty() ? NULL : &owned[0];
+			length = n;
+		}
+
+		/** Refer to n values at p, which must outlive the table */
+		void assign(const T* p, const size_t n) {
+			std::vector<T>().swap(owned);
+			data = p;
+			length = n;
+		}
+
+		inline T& operator[](const size_t i) {
+			assert(i < owned.size());
+			return owned[i];
+		}
+
+		inline const T& operator[](const size_t i) const {
+			assert(i < length);
+			return data[i];
+		}
+
+		inline size_t size() const { return length; }
+		inline bool empty() const { return length == 0; }
+
+		inline const T* begin() const { return data; }
+};
+
+}
+
+#endif // PRECOMPUTED_TABLE_H
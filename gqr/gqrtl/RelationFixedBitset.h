@@ -27,6 +27,7 @@
 #include <stdint.h>
 
 #include "Relation.h"
+#include "gqrtl/RelationFixedBitsetKernels.h"
 
 namespace gqrtl {
 
@@ -41,6 +42,7 @@ namespace gqrtl {
  * the lowest block of type T regardless of the status of higher bits. In contrast (std::bitset::to_ulong() operator only
  * returns lower bits when higher bits are not set).
  * It is further important to have T as a *UNSIGNED integer type* since otherwise the bitshift operators do not work properly.
+ * T must not be wider than unsigned long, since count() and the iterators use the compiler's popcount and ctz builtins.
  */
 
 template<class T, size_t nWords>
@@ -53,11 +55,6 @@ class RelationFixedBitset
     /** clear data words */
     void zeroData();
 
-    /** table containing the number of set bits for all 16 bit unsigned integers @see count */
-    static uint16_t* cardinality_16_bit;
-    /** Precompute the table used to accelerate the count() function @see count @see cardinality_16_bit */
-    static void precompute_cardinality_16_bit();
-
   public:
     /** Default Constructor, sets all bits to 0 */
     inline RelationFixedBitset<T, nWords>();
@@ -72,9 +69,8 @@ class RelationFixedBitset
     Relation getRelation() const { // TODO: can we get rid of this?
         Relation res;
 
-	for (size_t i = 0; i < maxSize(); i++)
-		if ((*this)[i])
-			res.set(i);
+	for (const_iterator it = begin(); it != end(); ++it)
+		res.set(*it);
 	return res;
     }
 
@@ -85,10 +81,7 @@ class RelationFixedBitset
 
         public:
             const_iterator& operator++() { // infix ++ operator
-                for (bit++; bit < RelationFixedBitset<T, nWords>::maxSize(); bit++)
-                    if ((*bitset)[bit])
-                        break;
-
+                bit = bitset->nextSetBit(bit+1);
                 return *this;
             }
             size_t operator*() const { return bit; }
@@ -99,26 +92,15 @@ class RelationFixedBitset
             const_iterator(const RelationFixedBitset<T, nWords>* r, const size_t b) : bitset(r), bit(b) {}
     };
 
-    inline const_iterator begin() const {
-        for (size_t i = 0; i < maxSize(); i++)
-            if ((*this)[i])
-                return const_iterator(this, i);
-        return end();
-    }
+    inline const_iterator begin() const { return const_iterator(this, nextSetBit(0)); }
     inline const_iterator end() const { return const_iterator(this, RelationFixedBitset<T, nWords>::maxSize()); }
 
     /** Converts size_t to a relation. The lowest size_t bits are used to store the number. All other bits are set to 0 */
     inline RelationFixedBitset<T, nWords>(const size_t l);
 
-    /** Initialize static data of the class. @see clean_up*/
-    static void init() {
-        precompute_cardinality_16_bit();
-    }
-    /** Get rid of the static data once the data type is not needed any more. @see init */
-    static void clean_up() {
-	delete[] cardinality_16_bit;
-	cardinality_16_bit = NULL;
-    }
+    // Compatibility with Relation; the class has no static data
+    static void init() {}
+    static void clean_up() {}
 
     /** Return specified word of bitset representation */
     T getWord(const size_t i) const {
@@ -138,6 +120,8 @@ class RelationFixedBitset
     inline RelationFixedBitset<T, nWords>& flip();
     /** Read one bit */
     inline bool operator[](const size_t p) const;
+    /** Position of the lowest set bit at or above p, maxSize() if there is none */
+    inline size_t nextSetBit(const size_t p) const;
     /** &= operator */
     inline RelationFixedBitset<T, nWords>& operator&=(const RelationFixedBitset<T, nWords>& b);
     /** AND operator, calculates logical AND for all bits */
@@ -182,10 +166,9 @@ class RelationFixedBitset
     /** hash function for relations @return hash value of this instance */
     inline size_t hash(void) const;
 
+    /** Returns true iff all bits set in this relation are also set in b */
     inline bool isSubsetOf(const RelationFixedBitset<T, nWords>& b) const {
-        RelationFixedBitset<T, nWords> temp = b;
-        temp.flip();
-        return (*this & temp).none();
+        return BitsetKernels<T, nWords>::isSubsetOf(data, b.data);
     }
 
     /** Output stream operator. Print the relation as a sequence of 0, 1 starting with the highest bit. */
@@ -50,12 +50,7 @@ inline const size_t RelationFixedBitset<T, nWords>::lowestWord(void) const {
 
 template<class T, size_t nWords>
 inline bool RelationFixedBitset<T, nWords>::none(void) const {
-    for (size_t i = 0; i < nWords; ++i) {
-        if (data[i] != 0) {
-            return false;
-        }
-    }
-    return true;
+    return BitsetKernels<T, nWords>::none(data);
 }
 
 template<class T, size_t nWords>
@@ -90,9 +85,7 @@ inline void RelationFixedBitset<T, nWords>::unset(const size_t p) {
 
 template<class T, size_t nWords>
 inline RelationFixedBitset<T, nWords>& RelationFixedBitset<T, nWords>::flip() {
-    for (size_t i = 0; i < nWords; ++i) {
-        data[i] = ~data[i];
-    }
+    BitsetKernels<T, nWords>::flip(data);
     return *this;
 }
 
@@ -111,13 +104,27 @@ inline bool RelationFixedBitset<T, nWords>::operator[](const size_t p) const {
 }
 
 template<class T, size_t nWords>
-inline bool operator==(const RelationFixedBitset<T, nWords>& a, const RelationFixedBitset<T, nWords>& b) {
-    for (size_t i = 0; i < nWords; ++i) {
-        if (a.data[i] != b.data[i]) {
-            return false;
+inline size_t RelationFixedBitset<T, nWords>::nextSetBit(const size_t p) const {
+    const size_t bits = sizeof(T)*8;
+    size_t pos = p / bits;
+    if (pos >= nWords) {
+        return maxSize();
+    }
+
+    // mask out the bits below p in the first word
+    T word = data[pos] & (T) ((T) ~(T) 0 << (p % bits));
+    while (word == 0) {
+        if (++pos == nWords) {
+            return maxSize();
         }
+        word = data[pos];
     }
-    return true;
+    return pos * bits + __builtin_ctzl((unsigned long) word);
+}
+
+template<class T, size_t nWords>
+inline bool operator==(const RelationFixedBitset<T, nWords>& a, const RelationFixedBitset<T, nWords>& b) {
+    return BitsetKernels<T, nWords>::equal(a.data, b.data);
 }
 
 template<class T, size_t nWords>
@@ -127,9 +134,7 @@ inline bool operator!=(const RelationFixedBitset<T, nWords>& a, const RelationFi
 
 template<class T, size_t nWords>
 inline RelationFixedBitset<T, nWords>& RelationFixedBitset<T, nWords>::operator&=(const RelationFixedBitset<T, nWords>& b) {
-    for (size_t i = 0; i < nWords; ++i) {
-        data[i] &= b.data[i];
-    }
+    BitsetKernels<T, nWords>::andAssign(data, b.data);
     return *this;
 }
 
@@ -142,9 +147,7 @@ inline RelationFixedBitset<T, nWords> RelationFixedBitset<T, nWords>::operator&(
 
 template<class T, size_t nWords>
 inline RelationFixedBitset<T, nWords>& RelationFixedBitset<T, nWords>::operator|=(const RelationFixedBitset<T, nWords>& b) {
-    for(size_t i = 0; i < nWords; ++i) {
-        data[i] |= b.data[i];
-    }
+    BitsetKernels<T, nWords>::orAssign(data, b.data);
     return *this;
 }
 
@@ -301,40 +304,14 @@ inline size_t RelationFixedBitset<T, nWords>::hash(void) const {
     return hash;
 }
 
-/**
- * Precompute 16 method
- *
- * See http://www-db.stanford.edu/~manku/bitcount/bitcount.html
- */
 template<class T, size_t nWords>
 inline size_t RelationFixedBitset<T, nWords>::count() const {
     size_t numberOfBits = 0;
 
     for (size_t i = 0; i < nWords; ++i) {
-        T rdata = data[i];
-	for (size_t j = 0; j <= ((sizeof(T)*8-1) / 16); j++) {
-            numberOfBits += cardinality_16_bit [ (int) (rdata & (T) 0x0000ffffU)];
-	    rdata = rdata >> 16;
-	}
+        numberOfBits += __builtin_popcountl((unsigned long) data[i]);
     }
     return numberOfBits;
 }
 
-template<class T, size_t nWords>
-uint16_t* RelationFixedBitset<T, nWords>::cardinality_16_bit = 0;
-
-template<class T, size_t nWords>
-void RelationFixedBitset<T, nWords>::precompute_cardinality_16_bit() {
-    RelationFixedBitset<T, nWords>::cardinality_16_bit = new uint16_t[1U << 16]; // deleted in clean_up()
-
-    for (size_t i = 0; i < (1U << 16); ++i) {
-        cardinality_16_bit[i] = 0;
-        uint16_t n = (uint16_t) i;
-        while (n) {
-            cardinality_16_bit[i] += n & 1U;
-            n >>= 1;
-        }
-    }
-}
-
 }
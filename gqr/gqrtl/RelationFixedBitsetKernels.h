@@ -0,0 +1,216 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef RELATIONFIXEDBITSET_KERNELS_H
+#define RELATIONFIXEDBITSET_KERNELS_H
+
+#include <cstddef>
+
+#if !defined(GQR_NO_SIMD) && defined(__SSE2__)
+#define GQR_SIMD_SSE2 1
+#include <emmintrin.h>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+#ifdef __AVX2__
+#define GQR_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+namespace gqrtl {
+
+/**
+ * Word-wise operations on the data array of a RelationFixedBitset.
+ * This is the plain reference implementation which works for every word type.
+ */
+template<class T, size_t nWords>
+struct ScalarBitsetKernels {
+	static inline void andAssign(T* a, const T* b) {
+		for (size_t i = 0; i < nWords; ++i)
+			a[i] &= b[i];
+	}
+
+	static inline void orAssign(T* a, const T* b) {
+		for (size_t i = 0; i < nWords; ++i)
+			a[i] |= b[i];
+	}
+
+	static inline void flip(T* a) {
+		for (size_t i = 0; i < nWords; ++i)
+			a[i] = ~a[i];
+	}
+
+	static inline bool none(const T* a) {
+		for (size_t i = 0; i < nWords; ++i)
+			if (a[i] != 0)
+				return false;
+		return true;
+	}
+
+	static inline bool equal(const T* a, const T* b) {
+		for (size_t i = 0; i < nWords; ++i)
+			if (a[i] != b[i])
+				return false;
+		return true;
+	}
+
+	/** @return true iff every bit set in a is also set in b */
+	static inline bool isSubsetOf(const T* a, const T* b) {
+		for (size_t i = 0; i < nWords; ++i)
+			if ((a[i] & ~b[i]) != 0)
+				return false;
+		return true;
+	}
+};
+
+#ifdef GQR_SIMD_SSE2
+/**
+ * SSE2/AVX2 versions of the kernels for bitsets made of (64 bit) size_t words.
+ * Blocks of four words are handled with AVX2 (if enabled at compile time),
+ * blocks of two words with SSE2; a possibly remaining word is done in scalar code.
+ * All operations have to use vector loads and stores: mixing 64 bit stores with 128/256 bit
+ * loads of the same relation (e.g., |= followed by == in computeComposition) stalls on
+ * store forwarding and made composition slower than the scalar code.
+ */
+template<size_t nWords>
+struct SIMDBitsetKernels {
+	private:
+		typedef ScalarBitsetKernels<size_t, 1> Tail;
+
+#ifdef GQR_SIMD_AVX2
+		static const size_t avxEnd = nWords - nWords % 4;
+#else
+		static const size_t avxEnd = 0;
+#endif
+		static const size_t sseEnd = nWords - nWords % 2;
+
+		static inline __m128i load(const size_t* p) { return _mm_loadu_si128((const __m128i*) p); }
+		static inline void store(size_t* p, const __m128i v) { _mm_storeu_si128((__m128i*) p, v); }
+
+		static inline bool zero(const __m128i v) {
+#ifdef __SSE4_1__
+			return _mm_testz_si128(v, v);
+#else
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF;
+#endif
+		}
+
+#ifdef GQR_SIMD_AVX2
+		static inline __m256i load256(const size_t* p) { return _mm256_loadu_si256((const __m256i*) p); }
+		static inline void store256(size_t* p, const __m256i v) { _mm256_storeu_si256((__m256i*) p, v); }
+#endif
+
+	public:
+		static inline void andAssign(size_t* a, const size_t* b) {
+#ifdef GQR_SIMD_AVX2
+			for (size_t i = 0; i < avxEnd; i += 4)
+				store256(a+i, _mm256_and_si256(load256(a+i), load256(b+i)));
+#endif
+			for (size_t i = avxEnd; i < sseEnd; i += 2)
+				store(a+i, _mm_and_si128(load(a+i), load(b+i)));
+			if (sseEnd != nWords)
+				Tail::andAssign(a+sseEnd, b+sseEnd);
+		}
+
+		static inline void orAssign(size_t* a, const size_t* b) {
+#ifdef GQR_SIMD_AVX2
+			for (size_t i = 0; i < avxEnd; i += 4)
+				store256(a+i, _mm256_or_si256(load256(a+i), load256(b+i)));
+#endif
+			for (size_t i = avxEnd; i < sseEnd; i += 2)
+				store(a+i, _mm_or_si128(load(a+i), load(b+i)));
+			if (sseEnd != nWords)
+				Tail::orAssign(a+sseEnd, b+sseEnd);
+		}
+
+		static inline void flip(size_t* a) {
+#ifdef GQR_SIMD_AVX2
+			const __m256i ones256 = _mm256_set1_epi32(-1);
+			for (size_t i = 0; i < avxEnd; i += 4)
+				store256(a+i, _mm256_xor_si256(load256(a+i), ones256));
+#endif
+			const __m128i ones = _mm_set1_epi32(-1);
+			for (size_t i = avxEnd; i < sseEnd; i += 2)
+				store(a+i, _mm_xor_si128(load(a+i), ones));
+			if (sseEnd != nWords)
+				Tail::flip(a+sseEnd);
+		}
+
+		static inline bool none(const size_t* a) {
+#ifdef GQR_SIMD_AVX2
+			for (size_t i = 0; i < avxEnd; i += 4) {
+				const __m256i v = load256(a+i);
+				if (!_mm256_testz_si256(v, v))
+					return false;
+			}
+#endif
+			for (size_t i = avxEnd; i < sseEnd; i += 2)
+				if (!zero(load(a+i)))
+					return false;
+			return sseEnd == nWords || Tail::none(a+sseEnd);
+		}
+
+		static inline bool equal(const size_t* a, const size_t* b) {
+#ifdef GQR_SIMD_AVX2
+			for (size_t i = 0; i < avxEnd; i += 4) {
+				const __m256i v = _mm256_xor_si256(load256(a+i), load256(b+i));
+				if (!_mm256_testz_si256(v, v))
+					return false;
+			}
+#endif
+			for (size_t i = avxEnd; i < sseEnd; i += 2)
+				if (!zero(_mm_xor_si128(load(a+i), load(b+i))))
+					return false;
+			return sseEnd == nWords || Tail::equal(a+sseEnd, b+sseEnd);
+		}
+
+		static inline bool isSubsetOf(const size_t* a, const size_t* b) {
+#ifdef GQR_SIMD_AVX2
+			for (size_t i = 0; i < avxEnd; i += 4)
+				if (!_mm256_testc_si256(load256(b+i), load256(a+i))) // (~b & a) == 0
+					return false;
+#endif
+			for (size_t i = avxEnd; i < sseEnd; i += 2)
+				if (!zero(_mm_andnot_si128(load(b+i), load(a+i))))
+					return false;
+			return sseEnd == nWords || Tail::isSubsetOf(a+sseEnd, b+sseEnd);
+		}
+};
+#endif // GQR_SIMD_SSE2
+
+/**
+ * Kernels used by RelationFixedBitset. Defaults to the scalar implementation;
+ * multi-word bitsets over size_t use the SIMD kernels if these are available.
+ */
+template<class T, size_t nWords>
+struct BitsetKernels : public ScalarBitsetKernels<T, nWords> {};
+
+#ifdef GQR_SIMD_SSE2
+template<size_t nWords>
+struct BitsetKernels<size_t, nWords> : public SIMDBitsetKernels<nWords> {};
+
+template<>
+struct BitsetKernels<size_t, 1> : public ScalarBitsetKernels<size_t, 1> {};
+#endif
+
+}
+
+#endif // RELATIONFIXEDBITSET_KERNELS_H
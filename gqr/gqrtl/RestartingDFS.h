@@ -30,6 +30,7 @@
 #include "gqrtl/CSPStack.h"
 #include "gqrtl/VariableHeuristic.h"
 #include "gqrtl/DFSReport.h"
+#include "gqrtl/StopFlag.h"
 
 #include "gqrtl/NogoodDB.h"
 
@@ -40,7 +41,9 @@ class Logger;
 class RestartsFramework;
 
 /**
- * Implements a 2-way dfs
+ * Implements a 2-way dfs with restarts and nogood learning. The search is a
+ * loop over the explicit stack of decisions, hence its depth is not limited by
+ * the call stack.
  */
 
 namespace gqrtl {
@@ -67,13 +70,25 @@ class RestartingDFS : public DFSReport {
 		Tuple lastConflict;
 
 		const Tuple decideVariable();
+		/** Append var to the variables */
+		inline void addVariable(const Tuple& var);
+		/** Remove variables[pos], the last variable takes its place */
+		inline const Tuple removeVariable(const size_t pos);
 		const R decideValue(const R& values);
 		bool decide();
 		bool enforceConsistency();
 
 		enum Status { satisfiable, unsatisfiable, indeterminate };
+		/** Refute the latest positive decision. @return false if there is none, i.e., the network is inconsistent */
+		bool backtrack();
+		/** Search iteratively with the explicit stack of decisions until the next restart */
 		Status dfs();
 
+		#ifndef NDEBUG
+		/** Network before each positive decision on the stack */
+		std::vector<CoreCSP> debugStates;
+		#endif
+
 		std::vector<Tuple> variables;
 
 		/** print statistics if log interval exceeded */
@@ -88,7 +103,32 @@ class RestartingDFS : public DFSReport {
 		size_t nextRestart;
 
 		bool extractNogoods();
-		bool minimizeNogood(typename NogoodDB<R>::nogood&);
+		/** Reduce the nogood to a minimal subset that still propagates to a conflict from the (closed) root */
+		void minimizeNogood(typename NogoodDB<R>::nogood&);
+		/** Intersect the constraints with the atoms ng[atoms[from]], ..., ng[atoms[to-1]] and propagate. @return false on a conflict */
+		bool applyAtoms(const typename NogoodDB<R>::nogood& ng, const std::vector<size_t>& atoms, const size_t from, const size_t to);
+		/**
+		 * QuickXplain: append to result the indices of a minimal subset of the
+		 * atoms ng[atoms[from]], ..., ng[atoms[to-1]] that propagates to a
+		 * conflict together with the current state (if consistent)
+		 */
+		void explain(const typename NogoodDB<R>::nogood& ng, const std::vector<size_t>& atoms, const size_t from, const size_t to, const bool consistent, std::vector<size_t>& result);
+
+		// buffers of minimizeNogood
+		std::vector<size_t> minimization_atoms;
+		std::vector<size_t> minimization_result;
+		std::vector<Tuple> minimization_edges;
+
+		long int minimization_msec;
+		size_t minimization_calls;
+
+		/** Polled once per node; the search is abandoned once it is raised */
+		const StopFlag* stop;
+		bool stopped;
+
+		/** Randomized value ordering and tie-breaking of the variables unless 0 */
+		size_t seed;
+		size_t random;
 
 		NogoodDB<R> nogoodDB;
 
@@ -98,6 +138,17 @@ class RestartingDFS : public DFSReport {
 		RestartingDFS(const CoreCSP& csp, RestartsFramework& r, Logger* log);
 		~RestartingDFS();
 
+		/**
+		 * Pick the values at random and break ties between the variables by the
+		 * seed; 0 (the default) keeps the deterministic orderings. Call before run().
+		 */
+		void setSeed(const size_t s);
+
+		/** Stop the search once the flag is raised; run() then returns NULL */
+		void setStopFlag(const StopFlag* flag) { stop = flag; }
+		/** @return true iff run() was abandoned due to the stop flag */
+		bool isStopped() const { return stopped; }
+
 		// Run search
 		CoreCSP* run();
 };
@@ -22,6 +22,7 @@
 #include <algorithm>
 
 #include "utils/Logger.h"
+#include "utils/Timer.h"
 
 #include "RestartsFramework.h"
 
@@ -31,14 +32,24 @@ template<class R>
 RestartingDFS<R>::RestartingDFS(const RestartingDFS::CoreCSP& csp, RestartsFramework& r, ::Logger* l)
 	: DFSReport(), current_state(csp),
 	lastConflict(InvalidTuple),
-	variableHeuristic(csp.getSize()), log(l),
+	variableHeuristic(csp.getEdgePositions()), log(l),
 	restartsFramework(r),
-	nogoodDB(csp.getSize(), csp.getCalculus().getNumberOfBaseRelations()),
+	minimization_msec(0), minimization_calls(0),
+	stop(NULL), stopped(false), seed(0), random(0),
+	nogoodDB(csp.getSize(), csp.getCalculus().getNumberOfBaseRelations(),
+		r.nogoodLimit, r.nogoodGrowth, r.nogoodDecay),
 	propagate(nogoodDB) { }
 
 template<class R>
 RestartingDFS<R>::~RestartingDFS() { }
 
+template<class R>
+void RestartingDFS<R>::setSeed(const size_t s) {
+	seed = s;
+	random = s;
+	variableHeuristic.setSeed(s);
+}
+
 template<class R>
 const Tuple RestartingDFS<R>::decideVariable() {
 	assert(!variables.empty());
@@ -47,15 +58,33 @@ const Tuple RestartingDFS<R>::decideVariable() {
 	if (lastConflict != InvalidTuple) {
 		assert(std::find(variables.begin(), variables.end(), lastConflict) != variables.end());
 
-		for (pos = variables.size()-1; variables[pos] != lastConflict; --pos);
+		pos = variableHeuristic.getIndex(lastConflict, current_state.getCSP());
 		assert(variables[pos] == lastConflict);
 	}
 	else {
+		variableHeuristic.update(current_state.getChanges(), current_state.getCSP());
+		current_state.clearChanges();
 		pos = variableHeuristic.decide(variables, current_state.getCSP());
 	}
 
-	std::swap(variables[pos], variables.back());
-	Tuple res = variables.back();
+	return removeVariable(pos);
+}
+
+template<class R>
+inline void RestartingDFS<R>::addVariable(const Tuple& var) {
+	variables.push_back(var);
+	variableHeuristic.insert(var, variables.size()-1, current_state.getCSP());
+}
+
+template<class R>
+inline const Tuple RestartingDFS<R>::removeVariable(const size_t pos) {
+	const Tuple res = variables[pos];
+	variableHeuristic.remove(res, current_state.getCSP());
+
+	if (pos != variables.size()-1) {
+		variables[pos] = variables.back();
+		variableHeuristic.move(variables[pos], pos, current_state.getCSP());
+	}
 	variables.pop_back();
 
 	return res;
@@ -65,8 +94,13 @@ template<class R>
 const R RestartingDFS<R>::decideValue(const R& values) {
 	assert(!values.none());
 
-	const R value = current_state.getCalculus().getFirstSplit(values);
-	assert(!value.none());
+	if (seed == 0)
+		return current_state.getCalculus().getFirstSplit(values);
+
+	// the first split without a random number of the lowest base relations
+	random = random * 1103515245 + 12345;
+	const R value = current_state.getCalculus().getFirstSplit(values, (random >> 16) % values.count());
+	assert(!value.none() && value.isSubsetOf(values));
 
 	return value;
 }
@@ -83,7 +117,7 @@ bool RestartingDFS<R>::decide() {
 		return false;	// no need to assign a new value
 	}
 
-	const R value = current_state.getCalculus().getFirstSplit(values);
+	const R value = decideValue(values);
 	assert(!value.none());
 	assert(value != current_state.getValue(var));
 
@@ -111,7 +145,7 @@ bool RestartingDFS<R>::enforceConsistency() {
 		propagation_calls++;
 		std::vector<Tuple> t = propagate.enforce(current_state, var.x, var.y);
 		if (!t.empty()) {
-			variableHeuristic.reportFailure(t, decisions.size());
+			variableHeuristic.reportFailure(t, decisions.size(), current_state.getCSP());
 			return false;
 		}
 	}
@@ -124,89 +158,112 @@ bool RestartingDFS<R>::enforceConsistency() {
 }
 
 template<class R>
-typename RestartingDFS<R>::Status RestartingDFS<R>::dfs() {
-	if (number_negative_decisions == nextRestart)
-		return RestartingDFS<R>::indeterminate;
+bool RestartingDFS<R>::backtrack() {
+	// the latest positive decision, if any, is the one to refute
+	size_t last = decisions.size();
+	while (last > 0 && decisions[last-1].type != Decision::positive)
+		last--;
+	if (last == 0)
+		return false;
 
-	if (log) {
-		visited_depth_min = std::min<size_t>(visited_depth_min, decisions.size());
-		visited_depth_max = std::max<size_t>(visited_depth_max, decisions.size());
-		if (log->logDue())
-			generateLogReport();
+	assert(number_negative_decisions < nextRestart);
+
+	number_negative_decisions++; // cutoff might be reached, but we put negative decision on stack anyway
+
+	const bool direct_deadend = (decisions.back().type == Decision::positive);
+
+	while(decisions.back().type != Decision::positive) {
+		if (decisions.back().type == Decision::implied)
+			addVariable(decisions.back().variable);
+		decisions.pop_back();
 	}
 
-	if (!enforceConsistency())	// inconsistent
-		return RestartingDFS<R>::unsatisfiable;
+	const Tuple var = decisions.back().variable;
+	if (lastConflict == InvalidTuple)
+		lastConflict = var;
+
+	addVariable(var);
+
+	current_state.resetToLastState();
 
 	#ifndef NDEBUG
-	const CoreCSP DEBUG = current_state.getCSP();
+	assert(current_state.getCSP() == debugStates.back());
+	debugStates.pop_back();
 	#endif
 
-	// make new decision
-	if (!decisions.empty() && lastConflict != InvalidTuple
-		&& (decisions.back().type == Decision::positive || decisions.back().type == Decision::implied)) {
-		assert(decisions.back().variable == lastConflict);	// positve/implied decision may only happen on lastConflict
-		lastConflict = InvalidTuple;
-	}
+	const R nvalue = current_state.getCalculus().getNegation(decisions.back().value);
 
-	if (variables.empty())
-		return RestartingDFS<R>::satisfiable;
+	current_state.setValue(var, nvalue & current_state.getValue(var));
+	assert(!nvalue.none());
 
-	if (!decide())	// implied decisions
-		return dfs();
+	// replace positive decision with negative one
+	decisions.pop_back();
+	if (direct_deadend)
+		decisions.push_back(Decision(var, nvalue, Decision::negative_direct));
+	else
+		decisions.push_back(Decision(var, nvalue, Decision::negative));
 
-	// Made a positive decision:
-	// test the outcome
-	const Status status = dfs();
-	if (status == RestartingDFS<R>::satisfiable || status == RestartingDFS<R>::indeterminate) {
-		return status;
-	}
-	else {
-		assert(status == unsatisfiable);
+	return true;
+}
 
-		assert(number_negative_decisions < nextRestart);
+template<class R>
+typename RestartingDFS<R>::Status RestartingDFS<R>::dfs() {
+	#ifndef NDEBUG
+	debugStates.clear();
+	#endif
 
-		number_negative_decisions++; // cutoff might be reached, but we put negative decision on stack anyway
+	// every iteration visits one node of the search tree
+	while (true) {
+		if (stop && stop->isRaised()) {
+			stopped = true;
+			return RestartingDFS<R>::indeterminate;
+		}
 
-		const bool direct_deadend = (decisions.back().type == Decision::positive);
+		if (number_negative_decisions == nextRestart)
+			return RestartingDFS<R>::indeterminate;
 
-		while(decisions.back().type != Decision::positive) {
-			if (decisions.back().type == Decision::implied)
-				variables.push_back(decisions.back().variable);
-			decisions.pop_back();
+		if (log) {
+			visited_depth_min = std::min<size_t>(visited_depth_min, decisions.size());
+			visited_depth_max = std::max<size_t>(visited_depth_max, decisions.size());
+			if (log->logDue())
+				generateLogReport();
 		}
 
-		const Tuple var = decisions.back().variable;
-		if (lastConflict == InvalidTuple)
-			lastConflict = var;
+		if (!enforceConsistency()) {	// inconsistent
+			if (!backtrack())
+				return RestartingDFS<R>::unsatisfiable;
+			continue;
+		}
 
-		variables.push_back(var);
+		// make new decision
+		if (!decisions.empty() && lastConflict != InvalidTuple
+			&& (decisions.back().type == Decision::positive || decisions.back().type == Decision::implied)) {
+			assert(decisions.back().variable == lastConflict);	// positve/implied decision may only happen on lastConflict
+			lastConflict = InvalidTuple;
+		}
 
-		current_state.resetToLastState();
+		if (variables.empty())
+			return RestartingDFS<R>::satisfiable;
 
 		#ifndef NDEBUG
-		assert(current_state == DEBUG);
+		debugStates.push_back(current_state.getCSP());
+		if (!decide())	// implied decision
+			debugStates.pop_back();
+		#else
+		decide();
 		#endif
-
-		const R nvalue = current_state.getCalculus().getNegation(decisions.back().value);
-
-		current_state.setValue(var, nvalue & current_state.getValue(var));
-//		std::cout << "Negative decision: " << var.x << ", " << var.y << " set to " << nvalue << "\n";;
-		assert(!nvalue.none());
-
-		// replace positive decision with negative one
-		decisions.pop_back();
-		if (direct_deadend)
-			decisions.push_back(Decision(var, nvalue, Decision::negative_direct));
-		else
-			decisions.push_back(Decision(var, nvalue, Decision::negative));
-
-		return dfs();
 	}
 }
 
 template<class R>
 bool RestartingDFS<R>::extractNogoods() {
+	if (restartsFramework.minimizeNogoods) {
+		// minimization propagates incrementally from the root, close it once
+		propagation_calls++;
+		if (!propagate.enforce(current_state).empty())
+			return false;
+	}
+
 	typename NogoodDB<R>::nogood next_ng;
 	for (size_t i = 0; i < decisions.size(); i++) {
 		if (decisions[i].type == Decision::positive) {
@@ -221,8 +278,8 @@ bool RestartingDFS<R>::extractNogoods() {
 			if (restartsFramework.minimizeNogoods &&
 				decisions[i].type == Decision::negative_direct) {
 
-				if (a > 1 && !minimizeNogood(im_ng))
-					return false;
+				if (a > 1)
+					minimizeNogood(im_ng);
 			}
 			const size_t b = im_ng.size();
 
@@ -236,6 +293,11 @@ bool RestartingDFS<R>::extractNogoods() {
 				const Tuple& var = im_ng[0].first;
 				const R negation = current_state.getCalculus().getNegation(im_ng[0].second);
 				current_state.setValue(var, negation & current_state.getValue(var));
+				if (restartsFramework.minimizeNogoods) {
+					propagation_calls++;
+					if (!propagate.enforce(current_state, var.x, var.y).empty())
+						return false;
+				}
 			}
 			else {
 				nogoodDB.addNogood(im_ng, current_state);
@@ -248,65 +310,86 @@ bool RestartingDFS<R>::extractNogoods() {
 }
 
 template<class R>
-bool RestartingDFS<R>::minimizeNogood(typename NogoodDB<R>::nogood& ng) {
+bool RestartingDFS<R>::applyAtoms(const typename NogoodDB<R>::nogood& ng, const std::vector<size_t>& atoms, const size_t from, const size_t to) {
+	minimization_edges.clear();
+	for (size_t i = from; i < to; i++) {
+		const Tuple& var = ng[atoms[i]].first;
+		const R& value = current_state.getValue(var);
+		const R refinement = ng[atoms[i]].second & value;
+		if (refinement != value) {
+			current_state.setValue(var, refinement);
+			minimization_edges.push_back(var);
+		}
+	}
+	if (minimization_edges.empty())
+		return true;
+
+	propagation_calls++;
+	minimization_calls++;
+	return propagate.enforce(current_state, minimization_edges).empty();
+}
+
+template<class R>
+void RestartingDFS<R>::explain(const typename NogoodDB<R>::nogood& ng, const std::vector<size_t>& atoms, const size_t from, const size_t to, const bool consistent, std::vector<size_t>& result) {
+	if (!consistent)
+		return;		// the atoms added last suffice
+	assert(from < to);
+	if (to - from == 1) {
+		result.push_back(atoms[from]);
+		return;
+	}
+
+	const size_t middle = from + (to - from)/2;
+
+	// atoms of the second half needed together with the first half
+	const size_t first = result.size();
+	current_state.backupState();
+	explain(ng, atoms, middle, to, applyAtoms(ng, atoms, from, middle), result);
+	current_state.resetToLastState();
+
+	// atoms of the first half needed together with those
+	current_state.backupState();
+	explain(ng, atoms, from, middle, applyAtoms(ng, result, first, result.size()), result);
+	current_state.resetToLastState();
+}
+
+template<class R>
+void RestartingDFS<R>::minimizeNogood(typename NogoodDB<R>::nogood& ng) {
 	assert(ng.size() > 1);
 
 #ifndef NDEBUG
 std::cout << "Minimize a nogood of size " << ng.size() << ": ";
 #endif
 
-	typename NogoodDB<R>::nogood result;
-	result.reserve(ng.size());
+	const Timer start;
 
-	// TODO: optimize; put somewhere higher up
-	WeightedTripleIteratorNogoods<R, CoreCSPStack> propagate(nogoodDB);
-	propagation_calls++;
-	if (!propagate.enforce(current_state).empty())
-		return false;	// probably never happens
+	minimization_atoms.clear();
+	for (size_t i = 0; i < ng.size(); i++)
+		minimization_atoms.push_back(i);
 
+	// the atoms propagate to a conflict on direct dead ends; otherwise keep the nogood
 	current_state.backupState();
-	// find transition constraint (note: must exist, since we only run on direct dead ends)
-	bool done = false;
-	while (!done) {
-		current_state.backupState();
-		#ifndef NDEBUG
-		bool loop_finished = true;
-		#endif
-		for (size_t i = 0; i < ng.size(); ++i) {
-			const Tuple& var = ng[i].first;
-			const R refinement = ng[i].second & current_state.getValue(var);
-			current_state.setValue(var, refinement);
-			propagation_calls++;
-			if (!propagate.enforce(current_state, var.x, var.y).empty()) {
-				#ifndef NDEBUG
-				loop_finished = false;
-				#endif
-				result.push_back(ng[i]);
-				current_state.resetToLastState();
-
-				const R new_refinement = ng[i].second & current_state.getValue(var);
-				current_state.setValue(var, new_refinement);
-
-				while (ng.size() - i > 0) ng.pop_back();
-
-				propagation_calls++;
-				if (!propagate.enforce(current_state, var.x, var.y).empty())
-					done = true;
-				break;
-			}
-		}
-		#ifndef NDEBUG
-		assert(!loop_finished);
-		#endif
-	}
+	const bool consistent = applyAtoms(ng, minimization_atoms, 0, ng.size());
 	current_state.resetToLastState();
+	assert(!consistent);
+
+	if (!consistent) {
+		minimization_result.clear();
+		explain(ng, minimization_atoms, 0, ng.size(), true, minimization_result);
+		assert(!minimization_result.empty());
+
+		// keep the order of the decisions
+		std::sort(minimization_result.begin(), minimization_result.end());
+		for (size_t i = 0; i < minimization_result.size(); i++)
+			ng[i] = ng[minimization_result[i]];
+		ng.erase(ng.begin()+minimization_result.size(), ng.end());
+	}
+
+	minimization_msec += Timer().msec_passed(start);
 
-	ng = result;
 #ifndef NDEBUG
-	assert(!ng.empty());
 std::cout << "result of size " << ng.size() << "\n";
 #endif
-	return true;
 }
 
 template<class R>
@@ -316,6 +399,7 @@ typename RestartingDFS<R>::CoreCSP* RestartingDFS<R>::run() {
 
 	const size_t& size = current_state.getSize();
 
+	current_state.trackChanges();
 	variables.clear();
 	variables.reserve((size*size)/2);
 	for (size_t i = 0; i < size; i++)
@@ -323,7 +407,7 @@ typename RestartingDFS<R>::CoreCSP* RestartingDFS<R>::run() {
 			const Tuple current = Tuple(i,j);
 			const R& value = current_state.getValue(current);
 			if (!current_state.getCalculus().isSplit(value))
-				variables.push_back(current);
+				addVariable(current);
 			else
 				number_implied_decisions++;
 		}
@@ -332,7 +416,7 @@ std::cout << "Ignoring " << number_implied_decisions << " variables which are al
 #endif
 
 	Status consistency = RestartingDFS<R>::indeterminate;
-	while(consistency == RestartingDFS<R>::indeterminate) {
+	while(consistency == RestartingDFS<R>::indeterminate && !stopped) {
 		current_state.resetToInitialState();
 		nextRestart = restartsFramework.getNextCutoff();
 
@@ -351,7 +435,7 @@ std::cout << "Ignoring " << number_implied_decisions << " variables which are al
 					if (current_state.getCalculus().isSplit(value))
 						number_implied_decisions++;
 					else
-						variables.push_back(decisions[i].variable);
+						addVariable(decisions[i].variable);
 				}
 			decisions.clear();
 		}
@@ -360,6 +444,9 @@ std::cout << "Ignoring " << number_implied_decisions << " variables which are al
 		consistency = dfs();
 	}
 
+	if (stopped)
+		return NULL;
+
 	if (log) {
 		log->end();
 		generateLogReport();
@@ -399,6 +486,8 @@ void RestartingDFS<R>::generateLogReport(void) {
 
 	log->postDFSLog(*this);
 	nogoodDB.printStatistics();
+	if (restartsFramework.minimizeNogoods)
+		std::cout << "\tNogood minimization; time=" << minimization_msec << " msec, propagation calls=" << minimization_calls << std::endl;
 
 //	current_state.getCalculus().printStatistics();
 //	std::cout << "/* Collected statistics:";
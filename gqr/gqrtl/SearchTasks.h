@@ -0,0 +1,159 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef SEARCH_TASKS_H
+#define SEARCH_TASKS_H
+
+#include <deque>
+#include <vector>
+#include <utility>
+
+#include <pthread.h>
+
+#include "Tuple.h"
+
+namespace gqrtl {
+
+/**
+ * Open subtrees of a search tree shared by several threads (POSIX threads),
+ * one work-stealing deque per thread.
+ *
+ * A search offers the refutation of each of its positive decisions near the
+ * root at the bottom of its deque, as the path of decisions from the root
+ * together with the learned weights of its variable ordering.
+ * When it backtracks to such a decision, it takes the task back from the
+ * bottom unless another thread has stolen it from the top, i.e., close to
+ * the root. The search then skips that subtree. All deques share one mutex,
+ * as tasks are offered and taken back near the root only.
+ */
+template<class R>
+class SearchTasks {
+	public:
+		/** Decisions (edge, value) leading from the root to an open subtree */
+		typedef std::vector<std::pair<Tuple, R> > Path;
+
+	private:
+		struct Task {
+			size_t level;
+			Path path;
+			/** Learned weights of the variable ordering of the search that offered the task */
+			std::vector<size_t> weights;
+			Task(const size_t l, const Path& p, const std::vector<size_t>& w) : level(l), path(p), weights(w) {}
+		};
+
+		std::vector<std::deque<Task> > deques;
+
+		pthread_mutex_t mutex;
+		/** Signaled when a task is offered or the search is done */
+		pthread_cond_t wake;
+
+		/** Threads searching a task, and whether a thread does */
+		size_t busy;
+		std::vector<bool> holding;
+		bool done;
+		size_t stolen;
+
+		SearchTasks(const SearchTasks&);
+		SearchTasks& operator=(const SearchTasks&);
+
+	public:
+		/** Thread 0 holds the initial task, i.e., the whole search tree */
+		SearchTasks(const size_t threads) : deques(threads), busy(1), holding(threads, false), done(false), stolen(0) {
+			holding[0] = true;
+			pthread_mutex_init(&mutex, NULL);
+			pthread_cond_init(&wake, NULL);
+		}
+		~SearchTasks() {
+			pthread_cond_destroy(&wake);
+			pthread_mutex_destroy(&mutex);
+		}
+
+		/** Offer the refutation of the positive decision at level, reached by path */
+		void offer(const size_t thread, const size_t level, const Path& path, const std::vector<size_t>& weights) {
+			pthread_mutex_lock(&mutex);
+			deques[thread].push_back(Task(level, path, weights));
+			pthread_cond_signal(&wake);
+			pthread_mutex_unlock(&mutex);
+		}
+
+		/** Take back the task of level. @return false if it was stolen */
+		bool reclaim(const size_t thread, const size_t level) {
+			pthread_mutex_lock(&mutex);
+			std::deque<Task>& own = deques[thread];
+			const bool res = !own.empty() && own.back().level == level;
+			if (res)
+				own.pop_back();
+			pthread_mutex_unlock(&mutex);
+			return res;
+		}
+
+		/**
+		 * The calling thread has finished its task, if any; wait for the task
+		 * closest to the root of another thread.
+		 * @return false if there is none left, i.e., all threads are idle, or finish() was called
+		 */
+		bool steal(const size_t thread, Path& path, std::vector<size_t>& weights) {
+			pthread_mutex_lock(&mutex);
+			if (holding[thread]) {
+				holding[thread] = false;
+				busy--;
+			}
+			while (!done) {
+				for (size_t i = 1; i < deques.size(); i++) {
+					std::deque<Task>& victim = deques[(thread + i) % deques.size()];
+					if (victim.empty())
+						continue;
+
+					path.swap(victim.front().path);
+					weights.swap(victim.front().weights);
+					victim.pop_front();
+					holding[thread] = true;
+					busy++;
+					stolen++;
+					pthread_mutex_unlock(&mutex);
+					return true;
+				}
+
+				// idle threads have offered nothing, so all tasks are finished
+				if (busy == 0) {
+					done = true;
+					pthread_cond_broadcast(&wake);
+					break;
+				}
+				pthread_cond_wait(&wake, &mutex);
+			}
+			pthread_mutex_unlock(&mutex);
+			return false;
+		}
+
+		/** Stop handing out tasks, e.g., once a solution is found */
+		void finish() {
+			pthread_mutex_lock(&mutex);
+			done = true;
+			pthread_cond_broadcast(&wake);
+			pthread_mutex_unlock(&mutex);
+		}
+
+		size_t getStolen() const { return stolen; }
+};
+
+}
+
+#endif // SEARCH_TASKS_H
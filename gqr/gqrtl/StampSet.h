@@ -0,0 +1,66 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef STAMP_SET_H
+#define STAMP_SET_H
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <cstddef>
+
+namespace gqrtl {
+
+/**
+ * Set of the keys 0, ..., n-1 with O(1) clear. Every key has a stamp; a key
+ * is in the set iff its stamp equals the current generation, and clear()
+ * starts a new generation. The stamps are only reset when the generation
+ * counter wraps around.
+ */
+class StampSet {
+	private:
+		std::vector<unsigned int> stamps;
+		unsigned int generation;
+
+	public:
+		StampSet(const size_t n) : stamps(n, 0), generation(1) {}
+
+		inline bool contains(const size_t key) const {
+			assert(key < stamps.size());
+			return stamps[key] == generation;
+		}
+
+		inline void insert(const size_t key) {
+			assert(key < stamps.size());
+			stamps[key] = generation;
+		}
+
+		inline void clear() {
+			if (++generation == 0) {
+				std::fill(stamps.begin(), stamps.end(), 0);
+				generation = 1;
+			}
+		}
+};
+
+}
+
+#endif // STAMP_SET_H
@@ -0,0 +1,60 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef STOP_FLAG_H
+#define STOP_FLAG_H
+
+#include <pthread.h>
+
+namespace gqrtl {
+
+/**
+ * Flag by which one thread asks searches running in other threads to stop
+ * (POSIX threads). The searches poll it once per node of the search tree.
+ */
+class StopFlag {
+	private:
+		mutable pthread_mutex_t mutex;
+		bool raised;
+
+		StopFlag(const StopFlag&);
+		StopFlag& operator=(const StopFlag&);
+
+	public:
+		StopFlag() : raised(false) { pthread_mutex_init(&mutex, NULL); }
+		~StopFlag() { pthread_mutex_destroy(&mutex); }
+
+		void raise() {
+			pthread_mutex_lock(&mutex);
+			raised = true;
+			pthread_mutex_unlock(&mutex);
+		}
+
+		bool isRaised() const {
+			pthread_mutex_lock(&mutex);
+			const bool res = raised;
+			pthread_mutex_unlock(&mutex);
+			return res;
+		}
+};
+
+}
+
+#endif // STOP_FLAG_H
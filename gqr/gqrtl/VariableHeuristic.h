@@ -31,84 +31,233 @@
 
 #include "gqrtl/CSP.h"
 #include "gqrtl/CalculusOperations.h"
-#include "gqrtl/HashMap.h"
 
 namespace gqrtl {
 
 /**
  * variable ordering according to the weight heuristic taking into account learned weights.
  * It is essentially domwdeg with weights instead of domain size.
+ * The edges are indexed by the network's getEdgePosition.
+ *
+ * The variables (edges (x,y), x < y) are kept in an indexed binary heap:
+ * variables that are split already first, then by weight divided by learned
+ * weight, ties broken by the position in the search's vector of variables.
+ * Hence decide() picks the same variable as a scan of that vector, unless a
+ * seed is set: then ties are broken by a hash of the edge and the seed. The search
+ * reports every change of the vector, of the network and of the learned
+ * weights, so a decision takes logarithmic instead of linear time.
  */
 template<class R>
 class WeightWDeg {
 	private:
-		HashMap<size_t> learnedWeights;
+		/** Learned weight of each edge at its edge position; 1 if the edge never failed */
+		std::vector<size_t> learnedWeights;
 		/** maximal encountered depth */
 		size_t maxDepth;
 
-		size_t size;
+		/** Order of a variable; split variables have weight -1 */
+		struct Key {
+			double weight;
+			size_t index;
+		};
+		/** Key of each variable at its edge position */
+		std::vector<Key> keys;
+		/** Heap of the edge positions of the variables */
+		std::vector<size_t> heap;
+		/** Heap position of each edge position; notQueued if the edge is no variable */
+		std::vector<size_t> heapPos;
+		static const size_t notQueued = (size_t) -1;
 
-		inline size_t getPos(const size_t i, const size_t j) const {
-			assert(i <= j);
-			return j+i*size - (i*(i+1))/2;
+		void updateWeight(const size_t pos, const size_t importance) {
+			size_t& value = learnedWeights[pos];
+			const size_t val = value + maxDepth - importance + 1;
+
+			if (val < value) {	// overflow
+				value = std::numeric_limits<size_t>::max();
+			}
+			else {
+				value = val;
+			}
+		}
+
+		template<class N>
+		inline double getWeight(const Tuple& var, const size_t pos, const N& csp) const {
+			const R& value = csp.getConstraint(var.x, var.y);
+			if (csp.getCalculus().isSplit(value))
+				return -1;
+			return ((double) csp.getCalculus().getWeight(value)) / (double) learnedWeights[pos];
 		}
 
-		void updateWeight(size_t i, size_t j, const size_t importance) {
-			if (i > j)
-				std::swap(i,j);
+		/** Tie-breaking of the variables, 0 for their position in the vector */
+		size_t seed;
 
-			std::pair<size_t*, bool> value = learnedWeights.insert(getPos(i,j));
-			if (value.second)
-				*(value.first) = 1;
-			const size_t val = *(value.first) + maxDepth - importance + 1;
+		inline size_t tieBreak(const size_t pos) const {
+			size_t h = (pos + 1) * 2654435761u ^ seed;
+			h ^= h >> 15;
+			h *= 0x5bd1e995;
+			return h ^ (h >> 13);
+		}
 
-			if (val < (*value.first)) {	// overflow
-				*(value.first) = std::numeric_limits<size_t>::max();
+		inline bool less(const size_t a, const size_t b) const {
+			if (keys[a].weight != keys[b].weight)
+				return keys[a].weight < keys[b].weight;
+			if (seed != 0) {
+				const size_t ta = tieBreak(a), tb = tieBreak(b);
+				if (ta != tb)
+					return ta < tb;
 			}
-			else {
-				*(value.first) = val;
+			return keys[a].index < keys[b].index;
+		}
+
+		inline void place(const size_t pos, const size_t i) {
+			heap[i] = pos;
+			heapPos[pos] = i;
+		}
+
+		/** Restore the heap property for the entry at heap position i */
+		void fix(size_t i) {
+			const size_t pos = heap[i];
+			for (; i > 0 && less(pos, heap[(i-1)/2]); i = (i-1)/2)
+				place(heap[(i-1)/2], i);
+			while (2*i+1 < heap.size()) {
+				size_t child = 2*i+1;
+				if (child+1 < heap.size() && less(heap[child+1], heap[child]))
+					child++;
+				if (!less(heap[child], pos))
+					break;
+				place(heap[child], i);
+				i = child;
+			}
+			place(pos, i);
+		}
+
+		/** Recompute the key of the edge, if it is a variable */
+		template<class N>
+		inline void update(const Tuple& t, const N& csp) {
+			const size_t pos = csp.getEdgePosition(t.x, t.y);
+			if (heapPos[pos] == notQueued)
+				return;
+
+			const double weight = getWeight(t.x < t.y ? t : Tuple(t.y, t.x), pos, csp);
+			if (weight != keys[pos].weight) {
+				keys[pos].weight = weight;
+				fix(heapPos[pos]);
 			}
 		}
 
 	public:
-		WeightWDeg(const size_t nodes) : maxDepth(1), size(nodes) {}
+		/** @param positions the number of edge positions of the network */
+		WeightWDeg(const size_t positions) : learnedWeights(positions, 1), maxDepth(1),
+			keys(positions), heapPos(positions, (size_t) notQueued), seed(0) {}
+
+		/** Break ties by the seed; must be called before the first variable is inserted */
+		void setSeed(const size_t s) {
+			assert(heap.empty());
+			seed = s;
+		}
+
+		const std::vector<size_t>& getLearnedWeights() const { return learnedWeights; }
+		/** Continue with the learned weights of another search on the same network */
+		void setLearnedWeights(const std::vector<size_t>& weights) {
+			assert(weights.size() == learnedWeights.size());
+			learnedWeights = weights;
+		}
 
-		size_t decide(const std::vector<Tuple>& variables, const CSP<R, gqrtl::CalculusOperations<R> >& csp) const {
+		/** Variable var was stored at variables[index] */
+		template<class N>
+		void insert(const Tuple& var, const size_t index, const N& csp) {
+			assert(var.x < var.y);
+			const size_t pos = csp.getEdgePosition(var.x, var.y);
+			assert(heapPos[pos] == notQueued);
+
+			keys[pos].weight = getWeight(var, pos, csp);
+			keys[pos].index = index;
+			heap.push_back(pos);
+			fix(heap.size()-1);
+		}
+
+		/** Variable var was removed from the variables */
+		template<class N>
+		void remove(const Tuple& var, const N& csp) {
+			const size_t pos = csp.getEdgePosition(var.x, var.y);
+			const size_t i = heapPos[pos];
+			assert(i != notQueued);
+
+			heapPos[pos] = notQueued;
+			const size_t last = heap.back();
+			heap.pop_back();
+			if (i < heap.size()) {
+				place(last, i);
+				fix(i);
+			}
+		}
+
+		/** Variable var was moved to variables[index] */
+		template<class N>
+		void move(const Tuple& var, const size_t index, const N& csp) {
+			const size_t pos = csp.getEdgePosition(var.x, var.y);
+			assert(heapPos[pos] != notQueued);
+
+			keys[pos].index = index;
+			fix(heapPos[pos]);
+		}
+
+		/** @return the position of variable var in the variables */
+		template<class N>
+		size_t getIndex(const Tuple& var, const N& csp) const {
+			const size_t pos = csp.getEdgePosition(var.x, var.y);
+			assert(heapPos[pos] != notQueued);
+			return keys[pos].index;
+		}
+
+		/** The constraints of the edges changed */
+		template<class N>
+		void update(const std::vector<Tuple>& edges, const N& csp) {
+			for (size_t i = 0; i < edges.size(); i++)
+				update(edges[i], csp);
+		}
+
+		/**
+		 * @return the position of the variable to decide in variables, i.e., the first
+		 * variable that is split already or else the first one of minimal weight
+		 */
+		template<class N>
+		size_t decide(const std::vector<Tuple>& variables, const N& csp) const {
 			assert(!variables.empty());
+			assert(heap.size() == variables.size());
 
+			#ifndef NDEBUG
 			size_t pos = 0;
 			double min = std::numeric_limits<double>::max();
-
 			for (size_t i = 0; i < variables.size(); i++) {
-				const Tuple& current = variables[i];
-				const R& value = csp.getConstraint(current.x, current.y);
-				if (csp.getCalculus().isSplit(value)) {
-					return i;
-				}
-
-				size_t learned_value = 1;
-				if (learnedWeights.exists(getPos(current.x,current.y)))
-					learned_value = learnedWeights[getPos(current.x,current.y)];
-
-				const double weight = ((double) csp.getCalculus().getWeight(value)) /
-				                                        (double) learned_value;
+				const size_t p = csp.getEdgePosition(variables[i].x, variables[i].y);
+				const double weight = getWeight(variables[i], p, csp);
+				assert(keys[p].weight == weight && keys[p].index == i);
 				if (weight < min) {
 					min = weight;
 					pos = i;
 				}
 			}
-			return pos;
+			assert(keys[heap[0]].index == pos || (seed != 0 && keys[heap[0]].weight == min));
+			#else
+			(void) csp;
+			#endif
+
+			return keys[heap[0]].index;
 		}
 
-		void reportFailure(const std::vector<Tuple>& violated_constraint, const size_t importance) {
+		template<class N>
+		void reportFailure(const std::vector<Tuple>& violated_constraint, const size_t importance, const N& csp) {
 			if (importance > maxDepth) {
 				maxDepth = importance;
 			}
 
 			assert(maxDepth >= importance);
 
-			for (size_t i = 0; i < violated_constraint.size(); ++i)
-				updateWeight(violated_constraint[i].x, violated_constraint[i].y, importance);
+			for (size_t i = 0; i < violated_constraint.size(); ++i) {
+				updateWeight(csp.getEdgePosition(violated_constraint[i].x, violated_constraint[i].y), importance);
+				update(violated_constraint[i], csp);
+			}
 		}
 };
 
@@ -32,28 +32,64 @@
  * Peter van Beek, Dennis W. Manchak:
  * The Design and an Experimental Analysis of Algorithms for Temporal Reasoning.
  * Journal of Artificial Intelligence Research, volume 4, pages 1-18, 1996
+ *
+ * The queue Q is PriorityQueue or BucketQueue.
+ *
+ * Optionally, revisions that were already performed with the current relations
+ * are skipped (setRevisionSkipping): every edge has the time of its last change
+ * and the time at which it was last processed from the queue. Dequeuing (i,j)
+ * revises R_{ik} by R_{ij} comp R_{jk}, which is exactly what processing (j,k)
+ * does to R_{ik}; if (j,k) was processed after both edges changed last, the
+ * revision cannot refine R_{ik} and is skipped. R_{kj} is handled alike by (k,i).
+ * Compositions with the universal relation are skipped if the base relations are
+ * serial. The times are only trusted within one call of enforce(), so the network
+ * may be changed (or restored by backtracking) between calls.
  */
 
 namespace gqrtl {
 
-template<class R, class N> class WeightedTripleIterator {
+template<class R, class N, class Q = PriorityQueue> class WeightedTripleIterator {
   private:
     /** The revise function. Performs R_{ik} = R_{ik} cap ( R_{ij} comp R_{jk} ). @returns true iff R_{ik} changed. */
     static inline bool revise(N& csp, const size_t i, const size_t j, const size_t k);
 
   protected:
-    PriorityQueue queue;
+    Q queue;
 
     inline void add_to_queue(size_t i, size_t j, const N& csp);
 
     /** pc1 based on a priority queue */
     std::vector<Tuple> pc1(N& csp);
 
+    /** pc1 that skips revisions as described above */
+    std::vector<Tuple> pc1Skipping(N& csp);
+
+    /** Revision skipping enabled */
+    bool skipRevisions;
+    /** Current time and time at which enforce() was called */
+    size_t now, epoch;
+    /** Per edge (i,j), i < j, at i*size+j: time of its last change and time it was last processed */
+    std::vector<size_t> changed, processed;
+    /** Number of performed and skipped revisions */
+    size_t revisions, skippedRevisions;
+
+    inline size_t edge(const size_t i, const size_t j, const size_t size) const { return i < j ? i*size+j : j*size+i; }
+    /** @return true iff the revision of the third edge by (i,j) and the processed edge (x,y) is redundant */
+    inline bool upToDate(const size_t ij, const size_t xy) const;
+    void startEpoch(const size_t size);
+
     std::vector<Tuple> describeTriple(size_t i, size_t j, size_t k) const;
 
   public:
     /** Empty constructor */
-    WeightedTripleIterator() {}
+    WeightedTripleIterator() : skipRevisions(false), now(0), epoch(0), revisions(0), skippedRevisions(0) {}
+
+    /** Enable or disable revision skipping; disabled by default */
+    void setRevisionSkipping(const bool enable) { skipRevisions = enable; }
+
+    /** Number of revisions performed and skipped so far (only counted if revision skipping is enabled) */
+    size_t getRevisions() const { return revisions; }
+    size_t getSkippedRevisions() const { return skippedRevisions; }
 
     /** Enforce algebraic closure to CSP. */
     std::vector<Tuple> enforce(N& csp);
@@ -24,9 +24,9 @@
 
 namespace gqrtl {
 
-template<class R, class N>
+template<class R, class N, class Q>
 inline
-bool WeightedTripleIterator<R,N>::revise(N& csp, const size_t i, const size_t j, const size_t k) {
+bool WeightedTripleIterator<R,N,Q>::revise(N& csp, const size_t i, const size_t j, const size_t k) {
     const R& oldEdge = csp.getConstraint(i, k);
     const R newEdge = oldEdge & csp.getCalculus().getComposition(csp.getConstraint(i, j), csp.getConstraint(j, k));
 
@@ -38,9 +38,9 @@ bool WeightedTripleIterator<R,N>::revise(N& csp, const size_t i, const size_t j,
     return false;
 }
 
-template<class R, class N>
+template<class R, class N, class Q>
 inline
-std::vector<Tuple> WeightedTripleIterator<R,N>::describeTriple(size_t i, size_t j, size_t k) const {
+std::vector<Tuple> WeightedTripleIterator<R,N,Q>::describeTriple(size_t i, size_t j, size_t k) const {
 	std::vector<Tuple> res;
 	res.reserve(3);
 	res.push_back(Tuple(i,j));
@@ -49,9 +49,9 @@ std::vector<Tuple> WeightedTripleIterator<R,N>::describeTriple(size_t i, size_t
 	return res;
 }
 
-template<class R, class N>
+template<class R, class N, class Q>
 inline
-void WeightedTripleIterator<R,N>::add_to_queue(size_t i, size_t j, const N& csp) {
+void WeightedTripleIterator<R,N,Q>::add_to_queue(size_t i, size_t j, const N& csp) {
     assert (i != j); // adding i,i would imply a change happened to ( = ); which could only be R(0U)
     if (j < i)
         std::swap(i, j);
@@ -60,9 +60,9 @@ void WeightedTripleIterator<R,N>::add_to_queue(size_t i, size_t j, const N& csp)
     queue.insert(nindex, csp.getCalculus().getWeight(csp.getConstraint(i, j)));
 }
 
-template<class R, class N>
+template<class R, class N, class Q>
 inline
-std::vector<Tuple> WeightedTripleIterator<R,N>::pc1(N& csp) {
+std::vector<Tuple> WeightedTripleIterator<R,N,Q>::pc1(N& csp) {
     const size_t& size = csp.getSize();
 
     while (!queue.empty()) {
@@ -94,9 +94,80 @@ std::vector<Tuple> WeightedTripleIterator<R,N>::pc1(N& csp) {
     return std::vector<Tuple>();
 }
 
-template<class R, class N>
+template<class R, class N, class Q>
 inline
-std::vector<Tuple> WeightedTripleIterator<R,N>::enforce(N& csp) {
+bool WeightedTripleIterator<R,N,Q>::upToDate(const size_t ij, const size_t xy) const {
+    // processing (x,y) happens after epoch, hence times of earlier calls do not count
+    const size_t p = processed[xy];
+    return p > epoch && p > changed[ij] && p > changed[xy];
+}
+
+template<class R, class N, class Q>
+void WeightedTripleIterator<R,N,Q>::startEpoch(const size_t size) {
+    if (changed.size() != size*size) {
+        changed.assign(size*size, 0);
+        processed.assign(size*size, 0);
+    }
+    epoch = now;
+}
+
+template<class R, class N, class Q>
+std::vector<Tuple> WeightedTripleIterator<R,N,Q>::pc1Skipping(N& csp) {
+    const size_t& size = csp.getSize();
+    const bool serial = csp.getCalculus().baseRelationsAreSerial();
+    const R& universal = csp.getCalculus().getUniversalRelation();
+
+    while (!queue.empty()) {
+        const size_t index = queue.peekMin().first;
+        queue.popMin();
+
+        const size_t i = index / size;
+        const size_t j = index % size;
+
+        assert(i < j);
+
+        for (size_t k = 0; k < size; ++k) {
+            // triangles with the diagonal are cheap and always revised
+            const bool diagonal = k == i || k == j;
+
+            // R_{ik} = R_{ik} cap ( R_{ij} comp R_{jk} ), also done by processing (j,k)
+            if (!diagonal && (upToDate(index, edge(j, k, size)) || (serial && csp.getConstraint(j, k) == universal))) {
+                skippedRevisions++;
+            } else {
+                revisions++;
+                if (revise(csp, i, j, k)) {
+                    if (csp.getConstraint(i, k).none()) {
+                        return describeTriple(i,j,k);
+                    }
+                    changed[edge(i, k, size)] = ++now;
+                    add_to_queue(i, k, csp);
+                }
+            }
+
+            // R_{kj} = R_{kj} cap ( R_{ki} comp R_{ij} ), also done by processing (k,i)
+            if (!diagonal && (upToDate(index, edge(k, i, size)) || (serial && csp.getConstraint(k, i) == universal))) {
+                skippedRevisions++;
+            } else {
+                revisions++;
+                if (revise(csp, k, i, j)) {
+                    if (csp.getConstraint(k, j).none()) {
+                        return describeTriple(i,j,k);
+                    }
+                    changed[edge(k, j, size)] = ++now;
+                    add_to_queue(k, j, csp);
+                }
+            }
+        }
+
+        processed[index] = ++now;
+    }
+
+    return std::vector<Tuple>();
+}
+
+template<class R, class N, class Q>
+inline
+std::vector<Tuple> WeightedTripleIterator<R,N,Q>::enforce(N& csp) {
     queue.clear();
 
     const size_t& size = csp.getSize();
@@ -108,7 +179,6 @@ std::vector<Tuple> WeightedTripleIterator<R,N>::enforce(N& csp) {
 
     // At least one edge is non-zero, hence revision will fail at some point even if empty relation is present in the input CSP
 
-    PriorityQueue queue;
     for (size_t i = 0; i < size; i++) {
         for (size_t j = i+1; j < size; j++) {
             if (csp.getCalculus().baseRelationsAreSerial() && csp.getConstraint(i, j) == csp.getCalculus().getUniversalRelation())
@@ -117,12 +187,16 @@ std::vector<Tuple> WeightedTripleIterator<R,N>::enforce(N& csp) {
         }
     }
 
+    if (skipRevisions) {
+        startEpoch(size);
+        return pc1Skipping(csp);
+    }
     return pc1(csp);
 }
 
-template<class R, class N>
+template<class R, class N, class Q>
 inline
-std::vector<Tuple> WeightedTripleIterator<R,N>::enforce(N& csp, const size_t i, const size_t j) {
+std::vector<Tuple> WeightedTripleIterator<R,N,Q>::enforce(N& csp, const size_t i, const size_t j) {
     queue.clear();
 
     const size_t& size = csp.getSize();
@@ -134,6 +208,10 @@ std::vector<Tuple> WeightedTripleIterator<R,N>::enforce(N& csp, const size_t i,
 
     add_to_queue(i, j, csp);
 
+    if (skipRevisions) {
+        startEpoch(size);
+        return pc1Skipping(csp);
+    }
     return pc1(csp);
 }
 
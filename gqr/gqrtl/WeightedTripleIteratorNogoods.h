@@ -31,8 +31,8 @@ namespace gqrtl {
 template<class R>
 class NogoodDB;
 
-template<class R, class N>
-class WeightedTripleIteratorNogoods : public WeightedTripleIterator<R, N> {
+template<class R, class N, class Q = PriorityQueue>
+class WeightedTripleIteratorNogoods : public WeightedTripleIterator<R, N, Q> {
 	private:
 		/** The revise function. Performs R_{ik} = R_{ik} cap ( R_{ij} comp R_{jk} ). @returns true iff R_{ik} changed. */
 		static inline bool revise(N& csp, const size_t i, const size_t j, const size_t k);
@@ -44,13 +44,16 @@ class WeightedTripleIteratorNogoods : public WeightedTripleIterator<R, N> {
 
 	public:
 		/** Empty constructor */
-		WeightedTripleIteratorNogoods(NogoodDB<R>& ng) : WeightedTripleIterator<R,N>(), nogoodDB(ng) {}
+		WeightedTripleIteratorNogoods(NogoodDB<R>& ng) : WeightedTripleIterator<R,N,Q>(), nogoodDB(ng) {}
 
 		/** Enforce algebraic closure to CSP. */
 		std::vector<Tuple> enforce(N& csp);
 
 		/** Enforce algebraic closure to CSP. Assume that csp \ R_{ij} is algebraically closed. */
 		std::vector<Tuple> enforce(N& csp, const size_t i, const size_t j);
+
+		/** Enforce algebraic closure to CSP. Assume that csp is algebraically closed except for the given edges. */
+		std::vector<Tuple> enforce(N& csp, const std::vector<Tuple>& edges);
 };
 
 }
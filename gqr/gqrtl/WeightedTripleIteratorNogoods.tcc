@@ -24,9 +24,9 @@
 
 namespace gqrtl {
 
-template<class R, class N>
+template<class R, class N, class Q>
 inline
-bool WeightedTripleIteratorNogoods<R,N>::revise(N& csp, const size_t i, const size_t j, const size_t k) {
+bool WeightedTripleIteratorNogoods<R,N,Q>::revise(N& csp, const size_t i, const size_t j, const size_t k) {
     const R& oldEdge = csp.getConstraint(i, k);
     const R newEdge = oldEdge & csp.getCalculus().getComposition(csp.getConstraint(i, j), csp.getConstraint(j, k));
 
@@ -38,9 +38,9 @@ bool WeightedTripleIteratorNogoods<R,N>::revise(N& csp, const size_t i, const si
     return false;
 }
 
-template<class R, class N>
+template<class R, class N, class Q>
 inline
-std::vector<Tuple> WeightedTripleIteratorNogoods<R,N>::pc1(N& csp) {
+std::vector<Tuple> WeightedTripleIteratorNogoods<R,N,Q>::pc1(N& csp) {
     const size_t& size = csp.getSize();
 
     while (!this->queue.empty()) {
@@ -67,7 +67,7 @@ std::vector<Tuple> WeightedTripleIteratorNogoods<R,N>::pc1(N& csp) {
 
 	// Nogood propagator
 
-	{
+	if (nogoodDB.mayCheck(t, csp.getValue(t))) {
 	for (size_t b = 0; b < csp.getCalculus().getNumberOfBaseRelations(); b++)
 		if (!csp.getValue(t)[b] && nogoodDB.check(t, b)) {
 			std::vector<Tuple> f = nogoodDB.checkNogoods(t, b, csp, this->queue);
@@ -79,9 +79,9 @@ std::vector<Tuple> WeightedTripleIteratorNogoods<R,N>::pc1(N& csp) {
     return std::vector<Tuple>();
 }
 
-template<class R, class N>
+template<class R, class N, class Q>
 inline
-std::vector<Tuple> WeightedTripleIteratorNogoods<R,N>::enforce(N& csp) {
+std::vector<Tuple> WeightedTripleIteratorNogoods<R,N,Q>::enforce(N& csp) {
     const size_t& size = csp.getSize();
 
     if (size < 2) return std::vector<Tuple>();
@@ -104,9 +104,9 @@ std::vector<Tuple> WeightedTripleIteratorNogoods<R,N>::enforce(N& csp) {
     return pc1(csp);
 }
 
-template<class R, class N>
+template<class R, class N, class Q>
 inline
-std::vector<Tuple> WeightedTripleIteratorNogoods<R,N>::enforce(N& csp, const size_t i, const size_t j) {
+std::vector<Tuple> WeightedTripleIteratorNogoods<R,N,Q>::enforce(N& csp, const size_t i, const size_t j) {
     const size_t& size = csp.getSize();
 
     if (size > 0 && csp.getConstraint(i, j).none())
@@ -122,4 +122,20 @@ std::vector<Tuple> WeightedTripleIteratorNogoods<R,N>::enforce(N& csp, const siz
     return pc1(csp);
 }
 
+template<class R, class N, class Q>
+inline
+std::vector<Tuple> WeightedTripleIteratorNogoods<R,N,Q>::enforce(N& csp, const std::vector<Tuple>& edges) {
+    this->queue.clear();
+
+    for (size_t e = 0; e < edges.size(); e++) {
+        const Tuple& t = edges[e];
+        if (csp.getConstraint(t.x, t.y).none())
+            return this->describeTriple(0, t.x, t.y);
+        this->add_to_queue(t.x, t.y, csp);
+    }
+
+    nogoodDB.startPropagation();
+    return pc1(csp);
+}
+
 }
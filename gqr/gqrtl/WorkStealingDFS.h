@@ -0,0 +1,105 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#ifndef WORK_STEALING_DFS_H
+#define WORK_STEALING_DFS_H
+
+#include <vector>
+
+#include <pthread.h>
+
+#include "gqrtl/CSP.h"
+#include "gqrtl/CalculusOperations.h"
+#include "gqrtl/DFS.h"
+#include "gqrtl/DFSReport.h"
+#include "gqrtl/SearchTasks.h"
+#include "gqrtl/StopFlag.h"
+
+class Logger;
+
+/**
+ * 2-way DFS on one network by several threads (POSIX threads) that steal
+ * open subtrees from each other.
+ *
+ * Every thread runs a DFS on its own CSPStack and offers the refutations of
+ * its positive decisions up to a given level in its deque (SearchTasks). An
+ * idle thread steals the task closest to the root, applies its path of
+ * decisions to the input network and searches that subtree with a DFS of its
+ * own, which continues with the learned weights of the search that offered
+ * the task. The first solution wins and stops the other threads; the network is
+ * inconsistent once all threads are idle.
+ *
+ * The calculus must be safe for concurrent reads, i.e., the CalculusOperations
+ * object must not use a composition cache.
+ */
+
+namespace gqrtl {
+
+template<class R>
+class WorkStealingDFS : public DFSReport {
+	private:
+		typedef CSP<R, CalculusOperations<R> > CoreCSP;
+
+		const CoreCSP& csp;
+
+		const size_t threads;
+		const size_t shareDepth;
+
+		SearchTasks<R> tasks;
+		StopFlag stop;
+
+		/** Guards result and the statistics */
+		pthread_mutex_t mutex;
+		CoreCSP* result;
+
+		::Logger* log;
+
+		struct Worker {
+			WorkStealingDFS* self;
+			size_t thread;
+		};
+		static void* run(void* worker);
+		void work(const size_t thread);
+		/** Search the subtree below path. @return true iff the search is over, i.e., solved or stopped */
+		bool search(const size_t thread, const typename SearchTasks<R>::Path& path, const std::vector<size_t>& weights);
+
+		WorkStealingDFS(const WorkStealingDFS&);
+		WorkStealingDFS& operator=(const WorkStealingDFS&);
+
+	public:
+		/**
+		 * @param t number of threads (at least 1)
+		 * @param depth the refutations of the positive decisions up to this level may be stolen
+		 */
+		WorkStealingDFS(const CoreCSP& csp, const size_t t, Logger* log, const size_t depth = 8);
+		~WorkStealingDFS();
+
+		/** @return a solution, NULL if the network is inconsistent */
+		CoreCSP* run();
+
+		/** Number of subtrees searched by a thread other than the one that opened it */
+		size_t getStolen() const { return tasks.getStolen(); }
+};
+
+}
+
+#include "gqrtl/WorkStealingDFS.tcc"
+
+#endif // WORK_STEALING_DFS_H
@@ -0,0 +1,114 @@
+// -*- C++ -*-
+
+// Copyright (C) 2012 Matthias Westphal
+//
+// This file is part of the Generic Qualitative Reasoner GQR.
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along
+// with this program; see the file COPYING.  If not, write to the Free
+// Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+// USA.
+
+#include <cassert>
+
+#include "utils/Logger.h"
+
+namespace gqrtl {
+
+template<class R>
+WorkStealingDFS<R>::WorkStealingDFS(const CoreCSP& c, const size_t t, ::Logger* l, const size_t depth) :
+	DFSReport(), csp(c), threads(t > 0 ? t : 1), shareDepth(depth),
+	tasks(threads), result(NULL), log(l) {
+	pthread_mutex_init(&mutex, NULL);
+}
+
+template<class R>
+WorkStealingDFS<R>::~WorkStealingDFS() {
+	pthread_mutex_destroy(&mutex);
+}
+
+template<class R>
+bool WorkStealingDFS<R>::search(const size_t thread, const typename SearchTasks<R>::Path& path, const std::vector<size_t>& weights) {
+	CoreCSP sub(csp);
+	for (typename SearchTasks<R>::Path::const_iterator it = path.begin(); it != path.end(); ++it)
+		sub.setConstraint(it->first.x, it->first.y, sub.getConstraint(it->first.x, it->first.y) & it->second);
+
+	DFS<R> dfs(sub, NULL);
+	dfs.setStopFlag(&stop);
+	dfs.setTasks(&tasks, thread, shareDepth, path);
+	if (!weights.empty())
+		dfs.setLearnedWeights(weights);
+	CoreCSP* res = dfs.run();
+
+	pthread_mutex_lock(&mutex);
+	addDecisions(dfs);
+	if (res && !stop.isRaised()) {
+		result = res;
+		res = NULL;
+		stop.raise();
+		tasks.finish();
+	}
+	pthread_mutex_unlock(&mutex);
+	delete res; // found too late
+
+	return stop.isRaised();
+}
+
+template<class R>
+void* WorkStealingDFS<R>::run(void* w) {
+	Worker* worker = static_cast<Worker*>(w);
+	worker->self->work(worker->thread);
+	return NULL;
+}
+
+template<class R>
+void WorkStealingDFS<R>::work(const size_t thread) {
+	typename SearchTasks<R>::Path path;
+	std::vector<size_t> weights;
+
+	// thread 0 searches the whole tree, the others start by stealing
+	if (thread == 0 && search(0, path, weights))
+		return;
+
+	while (tasks.steal(thread, path, weights))
+		if (search(thread, path, weights))
+			return;
+}
+
+template<class R>
+typename WorkStealingDFS<R>::CoreCSP* WorkStealingDFS<R>::run() {
+	if (log)
+		log->start();
+
+	// threads 1, ..., threads-1 run work(); this thread is thread 0
+	std::vector<pthread_t> ids(threads);
+	std::vector<Worker> workers(threads);
+	std::vector<bool> created(threads, false);
+	for (size_t t = 1; t < threads; t++) {
+		workers[t].self = this;
+		workers[t].thread = t;
+		created[t] = (pthread_create(&ids[t], NULL, run, &workers[t]) == 0);
+	}
+
+	work(0);
+
+	for (size_t t = 1; t < threads; t++)
+		if (created[t])
+			pthread_join(ids[t], NULL);
+
+	if (log)
+		log->end();
+
+	return result;
+}
+
+}
@@ -12,5 +12,6 @@
 #include "gobject/gqrcalculus.h"
 #include "gobject/gqrcsp.h"
 #include "gobject/gqrsolver.h"
+#include "gobject/gqrclosure.h"
 
 #endif /* LIBGQR_H_ */
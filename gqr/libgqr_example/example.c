@@ -58,7 +58,19 @@ int main(void) {
 	printf("One scenario is:\n");
 	print_csp(res);
 
+	/* refine an a-closed copy one constraint at a time, and undo */
+	GqrClosure* closure = gqr_solver_new_closure(solver, csp);
+	assert(closure != NULL);
+
+	int checkpoint = gqr_closure_checkpoint(closure);
+	gqr_closure_add_constraint(closure, 1, 2, "( < )");
+	if (!gqr_closure_add_constraint(closure, 0, 2, "( > )"))
+		printf("0 > 2 contradicts 0 < 1 < 2\n");
+	gqr_closure_rollback(closure, checkpoint);
+	assert(gqr_closure_is_consistent(closure));
+
 	/* clean up */
+	gqr_closure_unref(closure);
 	gqr_solver_unref(solver);
 	gqr_csp_unref(res);
 	gqr_csp_unref(csp);
@@ -34,9 +34,12 @@ class _CSP(Structure):
     pass
 class _Solver(Structure):
     pass
+class _Closure(Structure):
+    pass
 PCalculus = POINTER(_Calculus)
 PCSP = POINTER(_CSP)
 PSolver = POINTER(_Solver)
+PClosure = POINTER(_Closure)
 
 gqr_calculus_new = _libraries['libgqr.so'].gqr_calculus_new
 gqr_calculus_new.restype = PCalculus
@@ -98,6 +101,37 @@ gqr_solver_get_scenario.argtypes = [PSolver, PCSP]
 gqr_solver_set_tractable_subclass = _libraries['libgqr.so'].gqr_solver_set_tractable_subclass
 gqr_solver_set_tractable_subclass.restype = c_bool
 gqr_solver_set_tractable_subclass.argtypes = [PSolver, c_char_p]
+gqr_solver_set_threads = _libraries['libgqr.so'].gqr_solver_set_threads
+gqr_solver_set_threads.restype = None
+gqr_solver_set_threads.argtypes = [PSolver, c_uint]
+gqr_solver_new_closure = _libraries['libgqr.so'].gqr_solver_new_closure
+gqr_solver_new_closure.restype = PClosure
+gqr_solver_new_closure.argtypes = [PSolver, PCSP]
+
+gqr_closure_unref = _libraries['libgqr.so'].gqr_closure_unref
+gqr_closure_unref.restype = None
+gqr_closure_unref.argtypes = [PClosure]
+gqr_closure_get_size = _libraries['libgqr.so'].gqr_closure_get_size
+gqr_closure_get_size.restype = c_int
+gqr_closure_get_size.argtypes = [PClosure]
+gqr_closure_is_consistent = _libraries['libgqr.so'].gqr_closure_is_consistent
+gqr_closure_is_consistent.restype = c_bool
+gqr_closure_is_consistent.argtypes = [PClosure]
+gqr_closure_add_constraint = _libraries['libgqr.so'].gqr_closure_add_constraint
+gqr_closure_add_constraint.restype = c_bool
+gqr_closure_add_constraint.argtypes = [PClosure, c_int, c_int, c_char_p]
+gqr_closure_checkpoint = _libraries['libgqr.so'].gqr_closure_checkpoint
+gqr_closure_checkpoint.restype = c_int
+gqr_closure_checkpoint.argtypes = [PClosure]
+gqr_closure_rollback = _libraries['libgqr.so'].gqr_closure_rollback
+gqr_closure_rollback.restype = c_bool
+gqr_closure_rollback.argtypes = [PClosure, c_int]
+gqr_closure_get_constraint = _libraries['libgqr.so'].gqr_closure_get_constraint
+gqr_closure_get_constraint.restype = POINTER(c_char)
+gqr_closure_get_constraint.argtypes = [PClosure, c_int, c_int]
+gqr_closure_get_csp = _libraries['libgqr.so'].gqr_closure_get_csp
+gqr_closure_get_csp.restype = PCSP
+gqr_closure_get_csp.argtypes = [PClosure]
 
 def _pystring(ptr):
     res = cast(ptr, c_char_p).value
@@ -156,6 +190,33 @@ class Solver(object):
         return CSP(gqr_solver_get_scenario(self._solver, csp_._csp))
     def set_tractable_subclass(self, algFilename):
         return gqr_solver_set_tractable_subclass(self._solver, algFilename)
+    def set_threads(self, threads):
+        gqr_solver_set_threads(self._solver, threads)
+    def new_closure(self, csp_):
+        return Closure(self, gqr_solver_new_closure(self._solver, csp_._csp))
+
+class Closure(object):
+    def __init__(self, solver, closure):
+        '''a-closed network refined one constraint at a time; use Solver.new_closure'''
+        super(Closure, self).__init__()
+        self._solver = solver # must outlive the closure
+        self._closure = closure
+    def __del__(self):
+        gqr_closure_unref(self._closure)
+    def get_size(self):
+        return gqr_closure_get_size(self._closure)
+    def is_consistent(self):
+        return gqr_closure_is_consistent(self._closure)
+    def add_constraint(self, i, j, relation):
+        return gqr_closure_add_constraint(self._closure, i, j, relation)
+    def checkpoint(self):
+        return gqr_closure_checkpoint(self._closure)
+    def rollback(self, checkpoint):
+        return gqr_closure_rollback(self._closure, checkpoint)
+    def get_constraint(self, i, j):
+        return _pystring(gqr_closure_get_constraint(self._closure, i, j))
+    def get_csp(self):
+        return CSP(gqr_closure_get_csp(self._closure))
 
 
 # initialization
@@ -177,4 +238,4 @@ else:
     _gobject.g_type_init()
 
 
-__all__ = ["Calculus", "CSP", "Solver"]
+__all__ = ["Calculus", "CSP", "Solver", "Closure"]
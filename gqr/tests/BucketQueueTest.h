@@ -0,0 +1,89 @@
+// -*- C++ -*-
+#ifndef BUCKET_QUEUE_TEST_H
+#define BUCKET_QUEUE_TEST_H
+
+#include <stdlib.h>
+
+#include <map>
+#include <set>
+
+#include "BucketQueue.h"
+#include "TestSuite.h"
+
+class BucketQueueTest:public CxxTest::TestSuite {
+ private:
+    BucketQueue queue;
+    size_t n;
+
+ public:
+    BucketQueueTest() : n(200) { /* NOCODE */ }
+
+    void testDecreaseKeyAuto() {
+        srand(0);
+        for (size_t i = 1; i <= n; ++i) {
+            queue.insert(i, 10 * (i % 17) + 5);
+            queue.insert(i, rand() % (10 * (i % 17) + 6));
+        }
+
+        TS_ASSERT_EQUALS(queue.getSize(), n);
+
+        std::pair < size_t, size_t > prev = std::make_pair(0, 0);
+        std::set < size_t > popped;
+        while (!queue.empty()) {
+            std::pair < size_t, size_t > elm = queue.peekMin();
+            queue.popMin();
+
+            TS_ASSERT(elm.second >= prev.second);
+            TS_ASSERT(popped.insert(elm.first).second);
+            prev = elm;
+        }
+
+        TS_ASSERT_EQUALS(popped.size(), n);
+    }
+
+    void testClear() {
+        queue.insert(3, 7);
+        queue.insert(4, 2);
+        queue.clear();
+        TS_ASSERT(queue.empty());
+
+        // indices are no longer queued after clear
+        queue.insert(3, 9);
+        queue.insert(1, 8);
+        TS_ASSERT_EQUALS(queue.getSize(), 2);
+        TS_ASSERT_EQUALS(queue.peekMin().first, 1);
+        queue.popMin();
+        TS_ASSERT_EQUALS(queue.peekMin().first, 3);
+        TS_ASSERT_EQUALS(queue.peekMin().second, 9);
+        queue.popMin();
+        TS_ASSERT(queue.empty());
+    }
+
+    void testRandomOperations() {
+        // compare to a map of the queued indices and their keys
+        std::map < size_t, size_t > queued;
+        srand(1);
+        for (size_t round = 0; round < 2000; ++round) {
+            const size_t index = rand() % 50;
+            size_t key = rand() % 30;
+            if (queued.find(index) != queued.end() && queued[index] < key)
+                key = queued[index];    // keys can only decrease
+            queue.insert(index, key);
+            queued[index] = key;
+
+            if (rand() % 3 == 0) {
+                const std::pair < size_t, size_t > elm = queue.peekMin();
+                queue.popMin();
+
+                TS_ASSERT(queued.find(elm.first) != queued.end());
+                TS_ASSERT_EQUALS(queued[elm.first], elm.second);
+                for (std::map < size_t, size_t >::const_iterator it = queued.begin(); it != queued.end(); ++it)
+                    TS_ASSERT(it->second >= elm.second);
+                queued.erase(elm.first);
+            }
+            TS_ASSERT_EQUALS(queue.getSize(), queued.size());
+        }
+    }
+};
+
+#endif                          // BUCKET_QUEUE_TEST_H
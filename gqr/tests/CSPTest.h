@@ -7,6 +7,7 @@
 
 #include "Relation.h"
 #include "gqrtl/CSP.h"
+#include "gqrtl/CSPStack.h"
 #include "Tuple.h"
 
 #include "TestSuite.h"
@@ -30,6 +31,19 @@ class FakeCalculus {
 		}
 };
 
+/** Calculus whose converse swaps base relations 2 and 3 */
+class FakeAsymmetricCalculus : public FakeCalculus {
+	public:
+		static Relation getConverse(const Relation& c) {
+			Relation r(c);
+			r.unset(2);
+			r.unset(3);
+			if (c[2]) r.set(3);
+			if (c[3]) r.set(2);
+			return r;
+		}
+};
+
 class CSPTest : public CxxTest::TestSuite {
 	public:
 		void setUp() {}
@@ -118,5 +132,101 @@ class CSPTest : public CxxTest::TestSuite {
 					TS_ASSERT_EQUALS(csp.getConstraint(i,j), clone.getConstraint(i,j));
 		}
 
+		void testTriangularMatrix( void ) {
+			FakeAsymmetricCalculus f;
+			gqrtl::CSP<Relation, FakeAsymmetricCalculus, gqrtl::FullMatrix<Relation> > full(7, f, "full");
+			gqrtl::CSP<Relation, FakeAsymmetricCalculus, gqrtl::TriangularMatrix<Relation> > triangular(7, f, "triangular");
+
+			Relation a;
+			a.set(2);
+			Relation b;
+			b.set(1);
+			b.set(3);
+
+			full.setConstraint(0, 1, a);
+			triangular.setConstraint(0, 1, a);
+			full.setConstraint(5, 2, b);
+			triangular.setConstraint(5, 2, b);
+
+			TS_ASSERT_EQUALS(triangular.getConstraint(1, 0), f.getConverse(a));
+			TS_ASSERT_EQUALS(triangular.getConstraint(5, 2), b);
+			for (size_t i = 0; i < 7; ++i)
+				for (size_t j = 0; j < 7; ++j)
+					TS_ASSERT_EQUALS(full.getConstraint(i,j), triangular.getConstraint(i,j));
+		}
+
+		template<class M>
+		void checkLayout( void ) {
+			FakeAsymmetricCalculus f;
+			gqrtl::CSP<Relation, FakeAsymmetricCalculus, gqrtl::FullMatrix<Relation> > full(21, f, "full");
+			gqrtl::CSP<Relation, FakeAsymmetricCalculus, M> other(21, f, "other");
+
+			for (size_t i = 0; i < 21; ++i)
+				for (size_t j = 0; j < 21; ++j)
+					if ((i*7 + j*3) % 5 == 0 && i != j) {
+						Relation r;
+						r.set(1 + (i+j) % 3);
+						full.setConstraint(i, j, r);
+						other.setConstraint(i, j, r);
+					}
+
+			for (size_t i = 0; i < 21; ++i)
+				for (size_t j = 0; j < 21; ++j)
+					TS_ASSERT_EQUALS(full.getConstraint(i,j), other.getConstraint(i,j));
+		}
+
+		void testLayouts( void ) {
+			checkLayout<gqrtl::FullMatrix<Relation, gqrtl::TiledIndex<2> > >();
+			checkLayout<gqrtl::FullMatrix<Relation, gqrtl::TiledIndex<> > >();
+			checkLayout<gqrtl::FullMatrix<Relation, gqrtl::MortonIndex> >();
+			checkLayout<gqrtl::TriangularMatrix<Relation> >();
+		}
+
+		template<class N>
+		void checkEqual(const N& a, const N& b) {
+			TS_ASSERT_EQUALS(a.getSize(), b.getSize());
+			for (size_t i = 0; i < a.getSize(); ++i)
+				for (size_t j = 0; j < a.getSize(); ++j)
+					TS_ASSERT_EQUALS(a.getConstraint(i,j), b.getConstraint(i,j));
+		}
+
+		void testStack( void ) {
+			FakeAsymmetricCalculus f;
+			Relation a, b, c;
+			a.set(2);
+			b.set(3);
+			c.set(1);
+			c.set(2);
+
+			const gqrtl::CSP<Relation, FakeAsymmetricCalculus> initial(4, f, "stack");
+			gqrtl::CSPStack<Relation, FakeAsymmetricCalculus> stack(initial);
+			stack.setValue(Tuple(0, 1), c);	// not trailed without a level
+			const gqrtl::CSP<Relation, FakeAsymmetricCalculus> first = stack.getCSP();
+
+			stack.backupState();
+			stack.setValue(Tuple(0, 1), a);
+			stack.setValue(Tuple(1, 0), b);	// trailed at this level already
+			stack.setValue(Tuple(2, 3), a);
+			const gqrtl::CSP<Relation, FakeAsymmetricCalculus> second = stack.getCSP();
+
+			stack.backupState();
+			stack.setValue(Tuple(2, 3), b);
+			stack.setValue(Tuple(3, 1), c);
+			stack.resetToLastState();
+			checkEqual(stack.getCSP(), second);
+
+			// edges changed by the reset level are trailed again
+			stack.setValue(Tuple(3, 2), a);
+			stack.setValue(Tuple(1, 3), a);
+			TS_ASSERT_EQUALS(stack.getConstraint(2, 3), b);
+
+			stack.backupState();
+			stack.setValue(Tuple(0, 2), a);
+			stack.resetToInitialState();
+			checkEqual(stack.getCSP(), first);
+			TS_ASSERT_EQUALS(stack.getConstraint(0, 1), c);
+			TS_ASSERT_EQUALS(stack.getConstraint(2, 3), f.getUniversalRelation());
+		}
+
 };
 #endif // CSP_TEST_H
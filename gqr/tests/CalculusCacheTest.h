@@ -0,0 +1,216 @@
+// -*- C++ -*-
+#ifndef CALCULUS_CACHE_TEST_H
+#define CALCULUS_CACHE_TEST_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "Calculus.h"
+#include "CalculusCache.h"
+#include "CalculusReader.h"
+#include "TestSuite.h"
+
+#include "gqrtl/CalculusOperations.h"
+
+/**
+ * Write a calculus, a set of relations and precomputed tables to a cache file
+ * in a temporary directory, read them back and check that changing a source
+ * file invalidates the cache.
+ */
+class CalculusCacheTest : public CxxTest::TestSuite
+{
+    private:
+	std::string dir;
+
+	Calculus* readCalculus(const std::string& name) {
+	    const std::string data_dir = "./data";
+	    const std::string filename = data_dir + "/" + name + ".spec";
+
+	    std::ifstream input;
+	    input.open(filename.c_str());
+	    TS_ASSERT(input.is_open());
+
+	    CalculusReader reader(name, data_dir, &input);
+	    return reader.makeCalculus();
+	}
+
+	void writeSource(const std::string& content) {
+	    const std::string filename = dir + "/source";
+	    std::ofstream out(filename.c_str());
+	    out << content;
+	}
+
+	void assertEqualCalculi(const Calculus& a, const Calculus& b) {
+	    TS_ASSERT_EQUALS(a.getName(), b.getName());
+	    TS_ASSERT_EQUALS(a.getNumberOfBaseRelations(), b.getNumberOfBaseRelations());
+	    TS_ASSERT_EQUALS(a.getIdentityBaseRelation(), b.getIdentityBaseRelation());
+	    TS_ASSERT_EQUALS(a.baseRelationsAreSerial(), b.baseRelationsAreSerial());
+	    for (size_t i = 0; i < a.getNumberOfBaseRelations(); i++) {
+		TS_ASSERT_EQUALS(a.getBaseRelationName(i), b.getBaseRelationName(i));
+		TS_ASSERT_EQUALS(a.getBaseRelationConverse(i), b.getBaseRelationConverse(i));
+		TS_ASSERT_EQUALS(a.getWeightBaseRelation(i), b.getWeightBaseRelation(i));
+		for (size_t j = 0; j < a.getNumberOfBaseRelations(); j++)
+		    TS_ASSERT_EQUALS(a.getBaseRelationComposition(i, j), b.getBaseRelationComposition(i, j));
+	    }
+	}
+
+	/** Tables computed with the cache attached are stored, and later read from the mapped file */
+	template<class R>
+	void checkTables(const std::string& name) {
+	    Calculus* c = readCalculus(name);
+	    TS_ASSERT(c);
+	    if (!c)
+		return;
+
+	    c->setCache(new CalculusCache(dir, name));
+	    c->getCache()->reset(std::vector<std::string>(1, "source"));
+	    TS_ASSERT(c->getCache()->writeCalculus(*c));
+	    const gqrtl::CalculusOperations<R> computed(*c);
+
+	    Calculus* cached = CalculusCache(dir, name).readCalculus(name);
+	    TS_ASSERT(cached);
+	    if (!cached) {
+		delete c;
+		return;
+	    }
+	    cached->setCache(new CalculusCache(dir, name));
+	    TS_ASSERT(cached->getCache()->isValid());
+	    size_t length;
+	    TS_ASSERT(cached->getCache()->getSection("tables/" + toString(R::maxSize()) + "x" + toString(sizeof(R)), length));
+	    const gqrtl::CalculusOperations<R> mapped(*cached);
+
+	    R universal = computed.getUniversalRelation();
+	    for (size_t i = 0; i < c->getNumberOfBaseRelations(); i++) {
+		R a;
+		a.set(i);
+		TS_ASSERT_EQUALS(mapped.getConverse(a), computed.getConverse(a));
+		TS_ASSERT_EQUALS(mapped.getWeight(a), computed.getWeight(a));
+		TS_ASSERT_EQUALS(mapped.getFirstSplit(a), computed.getFirstSplit(a));
+		for (size_t j = 0; j < c->getNumberOfBaseRelations(); j++) {
+		    R b;
+		    b.set(j);
+		    b |= a;
+		    TS_ASSERT_EQUALS(mapped.getComposition(a, b), computed.computeComposition(a, b));
+		}
+		universal.unset(i);
+		TS_ASSERT_EQUALS(mapped.getComposition(universal, a), computed.computeComposition(universal, a));
+		TS_ASSERT_EQUALS(mapped.getConverse(universal), computed.computeConverse(universal));
+		TS_ASSERT_EQUALS(mapped.getWeight(universal), computed.computeWeight(universal));
+	    }
+
+	    delete cached;
+	    delete c;
+	}
+
+	static std::string toString(const size_t n) {
+	    std::stringstream s;
+	    s << n;
+	    return s.str();
+	}
+
+    public:
+	void setUp() {
+	    char tmpl[] = "/tmp/gqrCalculusCacheTestXXXXXX";
+	    const char* d = mkdtemp(tmpl);
+	    TS_ASSERT(d);
+	    dir = d ? d : ".";
+	    writeSource("first version\n");
+	}
+
+	void tearDown() {
+	    const char* files[] = { "source", "rcc8.cache", "allen.cache", "opra2.cache" };
+	    for (size_t i = 0; i < sizeof(files)/sizeof(char*); i++)
+		std::remove((dir + "/" + files[i]).c_str());
+	    rmdir(dir.c_str());
+	}
+
+	void testCalculus() {
+	    Calculus* c = readCalculus("rcc8");
+	    TS_ASSERT(c);
+	    if (!c)
+		return;
+
+	    {
+		CalculusCache cache(dir, "rcc8");
+		TS_ASSERT(!cache.isValid());
+		cache.reset(std::vector<std::string>(1, "source"));
+		TS_ASSERT(cache.writeCalculus(*c));
+	    }
+
+	    CalculusCache cache(dir, "rcc8");
+	    TS_ASSERT(cache.isValid());
+	    TS_ASSERT(cache.readCalculus("allen") == NULL);
+	    Calculus* cached = cache.readCalculus("rcc8");
+	    TS_ASSERT(cached);
+	    if (cached)
+		assertEqualCalculi(*c, *cached);
+
+	    delete cached;
+	    delete c;
+	}
+
+	void testRelations() {
+	    Calculus* c = readCalculus("allen");
+	    TS_ASSERT(c);
+	    if (!c)
+		return;
+
+	    std::vector<Relation> relations;
+	    relations.push_back(c->getUniversalRelation());
+	    relations.push_back(c->getIdentityRelation());
+	    relations.push_back(c->encodeRelation("< m"));
+	    {
+		CalculusCache cache(dir, "allen");
+		cache.reset(std::vector<std::string>(1, "source"));
+		TS_ASSERT(cache.writeCalculus(*c));
+		TS_ASSERT(cache.writeRelations("split/test", *c, relations));
+	    }
+
+	    CalculusCache cache(dir, "allen");
+	    TS_ASSERT(cache.isValid());
+	    std::vector<Relation> read;
+	    TS_ASSERT(!cache.readRelations("split/none", *c, read));
+	    TS_ASSERT(cache.readRelations("split/test", *c, read));
+	    TS_ASSERT_EQUALS(read.size(), relations.size());
+	    for (size_t i = 0; i < read.size() && i < relations.size(); i++)
+		TS_ASSERT_EQUALS(read[i], relations[i]);
+
+	    delete c;
+	}
+
+	void testTables() {
+	    checkTables<gqrtl::Relation16>("rcc8");
+	    checkTables<gqrtl::Relation16>("allen");
+	    checkTables<gqrtl::RelationFixedBitset<size_t, 2> >("opra2");
+	}
+
+	void testInvalidation() {
+	    Calculus* c = readCalculus("rcc8");
+	    TS_ASSERT(c);
+	    if (!c)
+		return;
+
+	    {
+		CalculusCache cache(dir, "rcc8");
+		cache.reset(std::vector<std::string>(1, "source"));
+		TS_ASSERT(cache.writeCalculus(*c));
+	    }
+	    TS_ASSERT(CalculusCache(dir, "rcc8").isValid());
+
+	    writeSource("second, longer version\n");
+	    CalculusCache cache(dir, "rcc8");
+	    TS_ASSERT(!cache.isValid());
+	    size_t length;
+	    TS_ASSERT(cache.getSection("calculus", length) == NULL);
+
+	    delete c;
+	}
+};
+
+#endif // CALCULUS_CACHE_TEST_H
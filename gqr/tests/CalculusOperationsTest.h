@@ -0,0 +1,153 @@
+// -*- C++ -*-
+#ifndef CALCULUS_OPERATIONS_TEST_H
+#define CALCULUS_OPERATIONS_TEST_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Calculus.h"
+#include "CalculusReader.h"
+#include "TestSuite.h"
+
+#include "gqrtl/CalculusOperations.h"
+
+/**
+ * Compare the precomputed (table based) operations of gqrtl::CalculusOperations
+ * with the plain computations over base relations.
+ */
+class CalculusOperationsTest : public CxxTest::TestSuite
+{
+    private:
+	size_t seed;
+
+	size_t nextRandom() {
+	    seed = seed * 1103515245U + 12345U;
+	    return (seed >> 8) ^ (seed << 23);
+	}
+
+	Calculus* readCalculus(const std::string& name) {
+	    const std::string data_dir = "./data";
+	    const std::string filename = data_dir + "/" + name + ".spec";
+
+	    std::ifstream input;
+	    input.open(filename.c_str());
+	    TS_ASSERT(input.is_open());
+
+	    CalculusReader reader(name, data_dir, &input);
+	    return reader.makeCalculus();
+	}
+
+	/** random relation of the calculus, with roughly one in 'density' base relations set */
+	template<class R>
+	R randomRelation(const Calculus& c, const size_t density) {
+	    R r;
+	    for (size_t i = 0; i < c.getNumberOfBaseRelations(); i++)
+		if (nextRandom() % density == 0)
+		    r.set(i);
+	    return r;
+	}
+
+	template<class R>
+	void checkOperations(const std::string& name) {
+	    Calculus* c = readCalculus(name);
+	    if (!c)
+		return;
+	    gqrtl::CalculusOperations<R> ops(*c);
+	    const R& universal = ops.getUniversalRelation();
+	    const R& identity = ops.getIdentityRelation();
+
+	    // base relations
+	    for (size_t i = 0; i < c->getNumberOfBaseRelations(); i++) {
+		R a;
+		a.set(i);
+		TS_ASSERT_EQUALS(ops.getConverse(a), ops.computeConverse(a));
+		TS_ASSERT_EQUALS(ops.getWeight(a), ops.computeWeight(a));
+		for (size_t j = 0; j < c->getNumberOfBaseRelations(); j++) {
+		    R b;
+		    b.set(j);
+		    TS_ASSERT_EQUALS(ops.getComposition(a, b), ops.computeComposition(a, b));
+		}
+		TS_ASSERT_EQUALS(ops.getComposition(a, identity), a);
+		TS_ASSERT_EQUALS(ops.getComposition(identity, a), a);
+	    }
+
+	    // random relations of different sizes
+	    for (size_t density = 1; density <= 8; density *= 2)
+		for (size_t i = 0; i < 500; i++) {
+		    const R a = randomRelation<R>(*c, density);
+		    const R b = randomRelation<R>(*c, density);
+
+		    TS_ASSERT_EQUALS(ops.getComposition(a, b), ops.computeComposition(a, b));
+		    TS_ASSERT_EQUALS(ops.getConverse(a), ops.computeConverse(a));
+		    TS_ASSERT_EQUALS(ops.getWeight(a), ops.computeWeight(a));
+		}
+
+	    TS_ASSERT(ops.getComposition(R(), universal).none());
+	    TS_ASSERT_EQUALS(ops.getConverse(universal), universal);
+
+	    delete c;
+	}
+
+    public:
+	void setUp() {
+	    seed = 4711;
+	}
+
+	void testRelation8() {
+	    checkOperations<gqrtl::Relation8>("rcc8");
+	}
+
+	void testRelation16() {
+	    checkOperations<gqrtl::Relation16>("allen");
+	    checkOperations<gqrtl::Relation16>("rcc8");
+	}
+
+	void testRelation32() {
+	    checkOperations<gqrtl::Relation32>("rcc23");
+	    checkOperations<gqrtl::Relation32>("opra1");
+	    checkOperations<gqrtl::Relation32>("allen");
+	}
+
+	void testRelation64() {
+	    checkOperations<gqrtl::RelationFixedBitset<size_t, 1> >("rcc23");
+	    checkOperations<gqrtl::RelationFixedBitset<size_t, 1> >("opra1");
+	    checkOperations<gqrtl::RelationFixedBitset<size_t, 1> >("rcc8");
+	}
+
+	void testMultiWord() {
+	    checkOperations<gqrtl::RelationFixedBitset<size_t, 2> >("opra2");
+	    checkOperations<gqrtl::RelationFixedBitset<size_t, 2> >("rcc23");
+	    checkOperations<gqrtl::RelationFixedBitset<size_t, 4> >("opra2");
+	    checkOperations<gqrtl::RelationFixedBitset<size_t, 5> >("allen");
+	    checkOperations<gqrtl::RelationFixedBitset<size_t, 10> >("opra2");
+	}
+
+	void testCompositionCache() {
+	    typedef gqrtl::RelationFixedBitset<size_t, 2> R;
+	    Calculus* c = readCalculus("opra2");
+	    if (!c)
+		return;
+	    gqrtl::CalculusOperations<R> ops(*c);
+	    ops.setCompositionCacheSize(100);
+	    TS_ASSERT_EQUALS(ops.getCompositionCacheSize(), 128U);
+
+	    // small pool, so that both hits and collisions occur
+	    std::vector<R> pool;
+	    for (size_t i = 0; i < 64; i++)
+		pool.push_back(randomRelation<R>(*c, 4));
+	    for (size_t i = 0; i < 4000; i++) {
+		const R& a = pool[nextRandom() % pool.size()];
+		const R& b = pool[nextRandom() % pool.size()];
+		TS_ASSERT_EQUALS(ops.getComposition(a, b), ops.computeComposition(a, b));
+	    }
+
+	    ops.setCompositionCacheSize(0);
+	    TS_ASSERT_EQUALS(ops.getCompositionCacheSize(), 0U);
+	    TS_ASSERT_EQUALS(ops.getComposition(pool[0], pool[1]), ops.computeComposition(pool[0], pool[1]));
+
+	    delete c;
+	}
+};
+
+#endif // CALCULUS_OPERATIONS_TEST_H
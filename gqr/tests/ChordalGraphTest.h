@@ -0,0 +1,106 @@
+// -*- C++ -*-
+#ifndef CHORDAL_GRAPH_TEST_H
+#define CHORDAL_GRAPH_TEST_H
+
+#include <vector>
+
+#include "ChordalGraph.h"
+#include "TestSuite.h"
+
+class ChordalGraphTest:public CxxTest::TestSuite {
+ private:
+    /** Every cycle of length > 3 has a chord, i.e., eliminating a node whose neighbours form a clique succeeds until none is left */
+    bool isChordal(const ChordalGraph& g) {
+        std::vector<bool> eliminated(g.getSize(), false);
+        for (size_t step = 0; step < g.getSize(); step++) {
+            bool found = false;
+            for (size_t v = 0; v < g.getSize() && !found; v++) {
+                if (eliminated[v])
+                    continue;
+                std::vector<size_t> n;
+                for (size_t i = 0; i < g.getNeighbours(v).size(); i++)
+                    if (!eliminated[g.getNeighbours(v)[i]])
+                        n.push_back(g.getNeighbours(v)[i]);
+                bool clique = true;
+                for (size_t a = 0; a < n.size() && clique; a++)
+                    for (size_t b = a+1; b < n.size() && clique; b++)
+                        clique = (g.getEdge(n[a], n[b]) != ChordalGraph::noEdge);
+                if (clique) {
+                    eliminated[v] = true;
+                    found = true;
+                }
+            }
+            if (!found)
+                return false;
+        }
+        return true;
+    }
+
+ public:
+    void testCycle() {
+        // a cycle of length 4 needs one chord
+        std::vector<Tuple> edges;
+        edges.push_back(Tuple(0, 1));
+        edges.push_back(Tuple(1, 2));
+        edges.push_back(Tuple(2, 3));
+        edges.push_back(Tuple(3, 0));
+        const ChordalGraph g(4, edges);
+
+        TS_ASSERT_EQUALS(g.getEdges(), 5u);
+        TS_ASSERT_EQUALS(g.getFillEdges(), 1u);
+        TS_ASSERT(g.getEdge(0, 2) != ChordalGraph::noEdge || g.getEdge(1, 3) != ChordalGraph::noEdge);
+        TS_ASSERT(isChordal(g));
+    }
+
+    void testTree() {
+        // trees, loops and duplicate edges need no fill
+        std::vector<Tuple> edges;
+        for (size_t i = 1; i < 20; i++) {
+            edges.push_back(Tuple(i/2, i));
+            edges.push_back(Tuple(i, i/2));
+            edges.push_back(Tuple(i, i));
+        }
+        const ChordalGraph g(20, edges);
+
+        TS_ASSERT_EQUALS(g.getEdges(), 19u);
+        TS_ASSERT_EQUALS(g.getFillEdges(), 0u);
+        TS_ASSERT_EQUALS(g.getEdge(3, 7), g.getEdge(7, 3));
+        TS_ASSERT_EQUALS(g.getEdge(3, 8), ChordalGraph::noEdge);
+    }
+
+    void testEdgeIds() {
+        // ids in lexicographic order, neighbours sorted
+        std::vector<Tuple> edges;
+        size_t seed = 17;
+        for (size_t i = 0; i < 60; i++) {
+            seed = seed * 1103515245 + 12345;
+            const size_t x = (seed >> 16) % 25;
+            seed = seed * 1103515245 + 12345;
+            const size_t y = (seed >> 16) % 25;
+            edges.push_back(Tuple(x, y));
+        }
+        const ChordalGraph g(25, edges);
+        TS_ASSERT(isChordal(g));
+
+        for (size_t i = 0; i < edges.size(); i++)
+            if (edges[i].x != edges[i].y)
+                TS_ASSERT(g.getEdge(edges[i].x, edges[i].y) != ChordalGraph::noEdge);
+
+        for (size_t id = 0; id < g.getEdges(); id++) {
+            const Tuple& t = g.getTuple(id);
+            TS_ASSERT(t.x < t.y);
+            TS_ASSERT_EQUALS(g.getEdge(t.x, t.y), id);
+            if (id > 0)
+                TS_ASSERT(g.getTuple(id-1).x < t.x || (g.getTuple(id-1).x == t.x && g.getTuple(id-1).y < t.y));
+        }
+
+        for (size_t x = 0; x < g.getSize(); x++)
+            for (size_t i = 0; i < g.getNeighbours(x).size(); i++) {
+                if (i > 0)
+                    TS_ASSERT(g.getNeighbours(x)[i-1] < g.getNeighbours(x)[i]);
+                TS_ASSERT_EQUALS(g.getEdge(x, g.getNeighbours(x)[i]), g.getEdgeIds(x)[i]);
+            }
+    }
+};
+
+#endif                          // CHORDAL_GRAPH_TEST_H
@@ -12,11 +12,17 @@
 #include "CalculusReader.h"
 
 #include "RestartsFramework.h"
+#include "CSPSparse.h"
+#include "ChordalGraph.h"
 #include "gqrtl/CSP.h"
 #include "gqrtl/CalculusOperations.h"
 #include "gqrtl/WeightedTripleIterator.h"
 #include "gqrtl/DFS.h"
 #include "gqrtl/RestartingDFS.h"
+#include "gqrtl/Portfolio.h"
+#include "gqrtl/WorkStealingDFS.h"
+#include "gqrtl/ChordalCSP.h"
+#include "gqrtl/PartialTripleIterator.h"
 
 #include "TestSuite.h"
 #include "WorldFixture.h"
@@ -213,5 +219,274 @@ class ReasoningTest : public CxxTest::TestSuite
     TS_ASSERT(!search_r.run());
   }
 
+  void testSparseConsistency( void ) {
+    // search on the chordal graph with partial path consistency agrees with the
+    // full search: both branch down to base relations, which partial path
+    // consistency decides for Allen and RCC8
+    typedef gqrtl::CalculusOperations<Relation> Ops;
+    typedef gqrtl::ChordalCSP<Relation, Ops> Chordal;
+    typedef gqrtl::PartialTripleIterator<Relation, gqrtl::CSPStack<Relation, Ops, Chordal> > Propagator;
+    const size_t size = 12;
+    size_t seed = 42;
+
+    for (size_t n = 0; n < 40; n++) {
+	const Calculus& c = (n % 2 == 0) ? *allen : *rcc8;
+	const Ops& ops = (n % 2 == 0) ? *allen_op : *rcc8_op;
+	CSPSparse input(size, c, "sparse");
+	std::vector<Tuple> constrained;
+	for (size_t x = 0; x < size; x++)
+	    for (size_t y = x+1; y < size; y++) {
+		seed = seed * 1103515245 + 12345;
+		if ((seed >> 16) % 3 != 0)
+		    continue;
+		Relation r;
+		for (size_t b = 0; b < c.getNumberOfBaseRelations(); b++) {
+		    seed = seed * 1103515245 + 12345;
+		    if ((seed >> 16) % 2 == 0)
+			r.set(b);
+		}
+		if (r.none())
+		    r.set(x % c.getNumberOfBaseRelations());
+		input.addConstraint(x, y, r);
+		constrained.push_back(Tuple(x, y));
+	    }
+
+	CSPSimple csp(input, ops);
+	gqrtl::DFS<Relation> search(csp, NULL);
+	CSPSimple* res = search.run();
+
+	const ChordalGraph graph(size, constrained);
+	Chordal chordal(input, ops, graph);
+	gqrtl::DFS<Relation, Chordal, Propagator> sparse(chordal, NULL);
+	Chordal* sparseRes = sparse.run();
+
+	TS_ASSERT_EQUALS(res != NULL, sparseRes != NULL);
+	if (sparseRes) {
+	    // a refinement of the input on the chordal edges
+	    for (CSPSparse::const_iterator it = input.begin(); it != input.end(); ++it) {
+		const Relation r = sparseRes->getConstraint(it->first.first, it->first.second);
+		TS_ASSERT((r & it->second) == r);
+		TS_ASSERT(!r.none());
+	    }
+	}
+	delete res;
+	delete sparseRes;
+    }
+  }
+
+  void testMinimizedNogoods( void ) {
+    // restarting after every failure with minimized nogoods agrees with the
+    // plain search on random Allen networks
+    const size_t size = 14;
+    size_t seed = 7;
+
+    restarts.strategy = RestartsFramework::Luby;
+    restarts.cutoff = 1;
+    restarts.minimizeNogoods = true;
+    for (size_t n = 0; n < 30; n++) {
+	CSPSimple csp(size, *allen_op, "minimize");
+	for (size_t x = 0; x < size; x++)
+	    for (size_t y = x+1; y < size; y++) {
+		seed = seed * 1103515245 + 12345;
+		if ((seed >> 16) % 2 != 0)
+		    continue;
+		Relation r;
+		for (size_t b = 0; b < allen->getNumberOfBaseRelations(); b++) {
+		    seed = seed * 1103515245 + 12345;
+		    if ((seed >> 16) % 2 == 0)
+			r.set(b);
+		}
+		if (r.none())
+		    r.set(y % allen->getNumberOfBaseRelations());
+		csp.setConstraint(x, y, r);
+	    }
+
+	gqrtl::DFS<Relation> search(csp, NULL);
+	CSPSimple* res = search.run();
+
+	restarts.initialize();
+	gqrtl::RestartingDFS<Relation> search_r(csp, restarts, NULL);
+	CSPSimple* res_r = search_r.run();
+
+	TS_ASSERT_EQUALS(res != NULL, res_r != NULL);
+	delete res;
+	delete res_r;
+    }
+    restarts.strategy = RestartsFramework::Geometric;
+    restarts.cutoff = 10;
+    restarts.minimizeNogoods = false;
+  }
+
+  void testPortfolio( void ) {
+    // seeded searches and the portfolio of 2-way DFS, Luby and geometric
+    // restarts with seeds agree with the plain search on random Allen networks
+    const size_t size = 14;
+    size_t seed = 11;
+
+    for (size_t n = 0; n < 20; n++) {
+	CSPSimple csp(size, *allen_op, "portfolio");
+	for (size_t x = 0; x < size; x++)
+	    for (size_t y = x+1; y < size; y++) {
+		seed = seed * 1103515245 + 12345;
+		if ((seed >> 16) % 2 != 0)
+		    continue;
+		Relation r;
+		for (size_t b = 0; b < allen->getNumberOfBaseRelations(); b++) {
+		    seed = seed * 1103515245 + 12345;
+		    if ((seed >> 16) % 2 == 0)
+			r.set(b);
+		}
+		if (r.none())
+		    r.set(y % allen->getNumberOfBaseRelations());
+		csp.setConstraint(x, y, r);
+	    }
+
+	gqrtl::DFS<Relation> search(csp, NULL);
+	CSPSimple* res = search.run();
+
+	gqrtl::DFS<Relation> search_s(csp, NULL);
+	search_s.setSeed(n+1);
+	CSPSimple* res_s = search_s.run();
+
+	restarts.initialize();
+	gqrtl::RestartingDFS<Relation> search_r(csp, restarts, NULL);
+	search_r.setSeed(n+1);
+	CSPSimple* res_r = search_r.run();
+
+	RestartsFramework dfs(restarts), luby(restarts);
+	dfs.useRestarts = false;
+	luby.strategy = RestartsFramework::Luby;
+	gqrtl::Portfolio<Relation> portfolio(csp);
+	portfolio.addEngine(dfs, 0);
+	portfolio.addEngine(luby, 0);
+	portfolio.addEngine(restarts, 0);
+	portfolio.addEngine(dfs, n+1);
+	portfolio.addEngine(luby, n+1);
+	portfolio.addEngine(restarts, n+1);
+	CSPSimple* res_p = portfolio.run();
+
+	TS_ASSERT_EQUALS(res != NULL, res_s != NULL);
+	TS_ASSERT_EQUALS(res != NULL, res_r != NULL);
+	TS_ASSERT_EQUALS(res != NULL, res_p != NULL);
+	TS_ASSERT(portfolio.getWinner() < portfolio.getNumberOfEngines());
+	if (res_p)
+	    for (size_t x = 0; x < size; x++)
+		for (size_t y = x+1; y < size; y++)
+		    TS_ASSERT(((res_p->getConstraint(x, y) | csp.getConstraint(x, y)) == csp.getConstraint(x, y)));
+	delete res;
+	delete res_s;
+	delete res_r;
+	delete res_p;
+    }
+  }
+
+  void testWorkStealing( void ) {
+    // several threads stealing subtrees agree with the sequential search on
+    // random Allen networks, also when every subtree may be stolen
+    const size_t size = 16;
+    size_t seed = 5;
+
+    for (size_t n = 0; n < 30; n++) {
+	CSPSimple csp(size, *allen_op, "stealing");
+	for (size_t x = 0; x < size; x++)
+	    for (size_t y = x+1; y < size; y++) {
+		seed = seed * 1103515245 + 12345;
+		if ((seed >> 16) % 2 != 0)
+		    continue;
+		Relation r;
+		for (size_t b = 0; b < allen->getNumberOfBaseRelations(); b++) {
+		    seed = seed * 1103515245 + 12345;
+		    if ((seed >> 16) % 2 == 0)
+			r.set(b);
+		}
+		if (r.none())
+		    r.set(y % allen->getNumberOfBaseRelations());
+		csp.setConstraint(x, y, r);
+	    }
+
+	gqrtl::DFS<Relation> search(csp, NULL);
+	CSPSimple* res = search.run();
+
+	gqrtl::WorkStealingDFS<Relation> search_w(csp, 4, NULL);
+	CSPSimple* res_w = search_w.run();
+
+	gqrtl::WorkStealingDFS<Relation> search_a(csp, 3, NULL, size*size);
+	CSPSimple* res_a = search_a.run();
+
+	TS_ASSERT_EQUALS(res != NULL, res_w != NULL);
+	TS_ASSERT_EQUALS(res != NULL, res_a != NULL);
+	if (res_a)
+	    for (size_t x = 0; x < size; x++)
+		for (size_t y = x+1; y < size; y++) {
+		    TS_ASSERT(((res_a->getConstraint(x, y) | csp.getConstraint(x, y)) == csp.getConstraint(x, y)));
+		    TS_ASSERT(allen_op->isSplit(res_a->getConstraint(x, y)));
+		}
+	delete res;
+	delete res_w;
+	delete res_a;
+    }
+  }
+
+  void testNogoodDatabase( void ) {
+    // nogoods of three atoms on fresh edges; the first 20 are used once, the
+    // database is then reduced to half its limit: the unused old nogoods go
+    // first, the oldest of them first, and neither the nogood of two atoms nor
+    // the nogoods learned at the latest restart are removed
+    typedef gqrtl::CSPStack<Relation, gqrtl::CalculusOperations<Relation> > Stack;
+    typedef gqrtl::NogoodDB<Relation>::nogood Nogood;
+    const size_t size = 30;
+    const size_t limit = 64;
+    const Relation before = allen->encodeRelation("<");
+
+    CSPSimple csp(size, *allen_op, "nogoods");
+    Stack stack(csp);
+    std::vector<Tuple> edges;
+    for (size_t x = 0; x < size; x++)
+	for (size_t y = x+1; y < size; y++)
+	    edges.push_back(Tuple(x, y));
+
+    gqrtl::NogoodDB<Relation> db(size, allen->getNumberOfBaseRelations(), limit, 1.0, 0.5);
+    std::vector<Nogood> nogoods;
+    for (size_t k = 0; k < 110; k++) {
+	Nogood ng;
+	for (size_t a = 0; a < 3; a++)
+	    ng.push_back(std::make_pair(edges[3*k+a], before));
+	nogoods.push_back(ng);
+    }
+    Nogood binary;
+    binary.push_back(std::make_pair(edges[330], before));
+    binary.push_back(std::make_pair(edges[331], before));
+    nogoods.push_back(binary);
+
+    db.addNogood(binary, stack);
+    for (size_t k = 0; k < 100; k++)
+	db.addNogood(nogoods[k], stack);
+    db.manageNogoods();	// all nogoods learned at this restart, none removed
+
+    gqrtl::WeightedTripleIteratorNogoods<Relation, Stack> propagator(db);
+    std::vector<bool> applies(nogoods.size());
+    for (size_t k = 0; k < nogoods.size(); k++) {
+	// the nogood excludes "<" from its last edge once the others are "<"
+	const Nogood& ng = nogoods[k];
+	stack.backupState();
+	for (size_t a = 0; a+1 < ng.size(); a++)
+	    stack.setValue(ng[a].first, before);
+	TS_ASSERT(propagator.enforce(stack).empty());
+	applies[k] = (stack.getValue(ng.back().first) & before).none();
+	stack.resetToLastState();
+
+	if (k == 20-1) {
+	    for (size_t j = 100; j < 110; j++)
+		db.addNogood(nogoods[j], stack);
+	    db.manageNogoods();
+	}
+    }
+
+    for (size_t k = 0; k < nogoods.size(); k++) {
+	// 111 nogoods reduced to 32: the binary one, the 20 used, the 10 recent and nogood 99
+	const bool kept = k < 20 || k >= 99;
+	TS_ASSERT_EQUALS((bool) applies[k], kept);
+    }
+  }
 };
 #endif // CONSISTENCYTEST_H
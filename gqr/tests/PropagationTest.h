@@ -6,15 +6,25 @@
 #include <fstream>
 #include <string>
 #include <map>
+#include <vector>
 
 #include "Relation.h"
+#include "BucketQueue.h"
 #include "Calculus.h"
 #include "CalculusReader.h"
+#include "CSPSparse.h"
+#include "ChordalGraph.h"
 #include "TestSuite.h"
 #include "WorldFixture.h"
 
 #include "gqrtl/CSP.h"
 #include "gqrtl/WeightedTripleIterator.h"
+#include "gqrtl/ParallelTripleIterator.h"
+#include "gqrtl/IncrementalClosure.h"
+#include "gqrtl/ChordalCSP.h"
+#include "gqrtl/PartialTripleIterator.h"
+#include "gqrtl/RelationFixedBitset.h"
+#include "gqrtl/CalculusOperations.h"
 
 bool isNormalizedCSP(gqrtl::CSP<Relation, Calculus>& csp) {
     for (size_t i = 0; i < csp.getSize(); i++)
@@ -48,11 +58,80 @@ class ReasoningTest : public CxxTest::TestSuite
   Calculus* allen;
 
   gqrtl::WeightedTripleIterator<Relation, gqrtl::CSP<Relation, Calculus> > ac;
+  gqrtl::WeightedTripleIterator<Relation, gqrtl::CSP<Relation, Calculus> > skipping;
+
+  size_t seed;
+
+  size_t nextRandom() {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) & 0x7fff;
+  }
+
+  // compare the parallel closure, the closure with BucketQueue and the one with revision skipping to the sequential one on n random networks
+  void checkParallel(const Calculus& c, const size_t n, const size_t size) {
+    for (size_t i = 0; i < n; i++) {
+	gqrtl::CSP<Relation, Calculus> sequential(size, c, "random");
+	for (size_t x = 0; x < size; x++)
+	    for (size_t y = x+1; y < size; y++) {
+		if (nextRandom() % 3 != 0)
+		    continue;
+		Relation r;
+		for (size_t b = 0; b < c.getNumberOfBaseRelations(); b++)
+		    if (nextRandom() % 2 == 0)
+			r.set(b);
+		if (r.none())
+		    r.set(nextRandom() % c.getNumberOfBaseRelations());
+		sequential.setConstraint(x, y, r);
+	    }
+
+	const gqrtl::CSP<Relation, Calculus> input = sequential;
+	const bool consistent = ac.enforce(sequential).empty();
+
+	for (size_t t = 1; t <= 4; t++) {
+	    gqrtl::CSP<Relation, Calculus> parallel = input;
+	    gqrtl::ParallelTripleIterator<Relation, gqrtl::CSP<Relation, Calculus> > pac(t);
+	    TS_ASSERT_EQUALS(pac.enforce(parallel).empty(), consistent);
+	    if (consistent)
+		TS_ASSERT(parallel == sequential);
+	}
+
+	gqrtl::CSP<Relation, Calculus> buckets = input;
+	gqrtl::WeightedTripleIterator<Relation, gqrtl::CSP<Relation, Calculus>, BucketQueue> bac;
+	TS_ASSERT_EQUALS(bac.enforce(buckets).empty(), consistent);
+	if (consistent)
+	    TS_ASSERT(buckets == sequential);
+
+	// revision skipping, reused for all networks; also refine an edge of a closed network
+	gqrtl::CSP<Relation, Calculus> skipped = input;
+	TS_ASSERT_EQUALS(skipping.enforce(skipped).empty(), consistent);
+	if (!consistent)
+	    continue;
+	TS_ASSERT(skipped == sequential);
+
+	const size_t x = nextRandom() % (size-1);
+	const size_t y = x + 1 + nextRandom() % (size-x-1);
+	const Relation r = sequential.getConstraint(x, y);
+	for (size_t b = 0; b < c.getNumberOfBaseRelations(); b++)
+	    if (r[b]) {
+		Relation base;
+		base.set(b);
+		sequential.setConstraint(x, y, base);
+		skipped.setConstraint(x, y, base);
+		break;
+	    }
+	const bool refinedConsistent = ac.enforce(sequential, x, y).empty();
+	TS_ASSERT_EQUALS(skipping.enforce(skipped, x, y).empty(), refinedConsistent);
+	if (refinedConsistent)
+	    TS_ASSERT(skipped == sequential);
+    }
+  }
 
  public:
   void setUp() {
     Relation::init();
 
+    skipping.setRevisionSkipping(true);
+
     const std::string data_dir = "./data";
 
     std::ifstream input;
@@ -63,6 +142,13 @@ class ReasoningTest : public CxxTest::TestSuite
 
     CalculusReader reader("allen", data_dir, &input);
     allen = reader.makeCalculus();
+    input.close();
+
+    input.open((data_dir + "/rcc8.spec").c_str());
+    TS_ASSERT(input.is_open());
+
+    CalculusReader rcc8Reader("rcc8", data_dir, &input);
+    rcc8 = rcc8Reader.makeCalculus();
   }
 
   void tearDown()
@@ -135,6 +221,120 @@ class ReasoningTest : public CxxTest::TestSuite
     TS_ASSERT(isNormalizedCSP(csp));
   }
 
+  void testPartialClosure( void ) {
+    // partial path consistency on sparse random networks is implied by algebraic
+    // closure and closes every triangle of the chordal graph
+    typedef gqrtl::ChordalCSP<Relation, Calculus> Chordal;
+    gqrtl::PartialTripleIterator<Relation, Chordal> ppc;
+    gqrtl::PartialTripleIterator<Relation, Chordal, BucketQueue> bppc;
+    const size_t size = 30;
+    seed = 1234;
+
+    for (size_t n = 0; n < 40; n++) {
+	const Calculus& c = (n % 2 == 0) ? *allen : *rcc8;
+	CSPSparse input(size, c, "sparse");
+	std::vector<Tuple> constrained;
+	for (size_t x = 0; x < size; x++)
+	    for (size_t y = x+1; y < size; y++) {
+		if (nextRandom() % 8 != 0)
+		    continue;
+		Relation r;
+		for (size_t b = 0; b < c.getNumberOfBaseRelations(); b++)
+		    if (nextRandom() % 3 != 0)
+			r.set(b);
+		if (r.none())
+		    r.set(nextRandom() % c.getNumberOfBaseRelations());
+		input.addConstraint(x, y, r);
+		constrained.push_back(Tuple(x, y));
+	    }
+
+	const ChordalGraph graph(size, constrained);
+	gqrtl::CSP<Relation, Calculus> full(input, c);
+	Chordal partial(input, c, graph);
+	Chordal buckets = partial;
+	const bool consistent = ac.enforce(full).empty();
+	const bool partialConsistent = ppc.enforce(partial).empty();
+	TS_ASSERT_EQUALS(bppc.enforce(buckets).empty(), partialConsistent);
+	if (consistent)
+	    TS_ASSERT(partialConsistent);
+	if (!partialConsistent)
+	    continue;
+	TS_ASSERT(buckets == partial);
+
+	for (size_t id = 0; id < graph.getEdges(); id++) {
+	    const size_t i = graph.getTuple(id).x;
+	    const size_t j = graph.getTuple(id).y;
+	    const Relation ij = partial.getConstraint(i, j);
+	    if (consistent)
+		TS_ASSERT((full.getConstraint(i, j) & ij) == full.getConstraint(i, j));
+	    for (size_t k = 0; k < size; k++) {
+		if (k == i || k == j || graph.getEdge(i, k) == ChordalGraph::noEdge || graph.getEdge(j, k) == ChordalGraph::noEdge)
+		    continue;
+		const Relation composition = c.getComposition(partial.getConstraint(i, k), partial.getConstraint(k, j));
+		TS_ASSERT((ij & composition) == ij);
+	    }
+	}
+    }
+  }
+
+  void testParallelClosure( void ) {
+    // same closure as WeightedTripleIterator for any number of threads and queue
+    seed = 4711;
+    checkParallel(*rcc8, 200, 10);
+    checkParallel(*allen, 20, 40);
+  }
+
+  void testIncrementalClosure( void ) {
+    // adding constraints one at a time yields the closure of all of them,
+    // rollback restores the network of a checkpoint
+    typedef gqrtl::CalculusOperations<gqrtl::Relation16> Operations;
+    typedef gqrtl::CSP<gqrtl::Relation16, Operations> GroundCSP;
+    const Operations ops(*allen);
+    const size_t size = 12;
+    seed = 815;
+
+    for (size_t n = 0; n < 20; n++) {
+	GroundCSP constraints(size, ops, "incremental");
+	gqrtl::IncrementalClosure<gqrtl::Relation16, Operations> closure(constraints);
+	gqrtl::WeightedTripleIterator<gqrtl::Relation16, GroundCSP> full;
+	TS_ASSERT(closure.isConsistent());
+
+	std::vector<GroundCSP> states;
+	std::vector<size_t> ids;
+	for (size_t step = 0; step < 30; step++) {
+	    if (nextRandom() % 5 == 0) {
+		states.push_back(closure.getCSP());
+		ids.push_back(closure.checkpoint());
+	    }
+
+	    const size_t x = nextRandom() % (size-1);
+	    const size_t y = x + 1 + nextRandom() % (size-x-1);
+	    gqrtl::Relation16 r;
+	    for (size_t b = 0; b < allen->getNumberOfBaseRelations(); b++)
+		if (nextRandom() % 3 != 0)
+		    r.set(b);
+	    constraints.setConstraint(x, y, constraints.getConstraint(x, y) & r);
+
+	    GroundCSP expected = constraints;
+	    const bool consistent = full.enforce(expected).empty();
+	    TS_ASSERT_EQUALS(closure.addConstraint(x, y, r), consistent);
+	    TS_ASSERT_EQUALS(closure.isConsistent(), consistent);
+	    if (!consistent)
+		break;
+	    TS_ASSERT(closure.getCSP() == expected);
+	}
+
+	if (ids.empty())
+	    continue;
+	const size_t k = nextRandom() % ids.size();
+	TS_ASSERT(closure.rollback(ids[k]));
+	TS_ASSERT(closure.isConsistent());
+	TS_ASSERT(closure.getCSP() == states[k]);
+	TS_ASSERT_EQUALS(closure.getCheckpoints(), k);
+	TS_ASSERT(!closure.rollback(ids[k]));
+    }
+  }
+
 
 };
 #endif // PROPAGATION_TEST_H
@@ -27,6 +27,7 @@ class RelationTesterAbstract
 	virtual void testDecrement( void ) = 0;
 	virtual void testConstIterator( void ) = 0;
 	virtual void testSubset( void ) = 0;
+	virtual void testKernels( void ) = 0;
         virtual ~RelationTesterAbstract() {} ;
 };
 
@@ -389,6 +390,30 @@ class RelationTester: public RelationTesterAbstract
 		TS_ASSERT_DIFFERS(it, r.end()); TS_ASSERT_EQUALS(*it, 7); ++it;
 		TS_ASSERT_EQUALS(it, r.end());
 		}
+
+		{
+		// bits around word boundaries and the highest bit
+		const size_t bits = sizeof(typename R::getType) * 8;
+		R r;
+		for (size_t i = bits - 1; i < R::maxSize(); i += bits) {
+			r.set(i);
+			if (i + 1 < R::maxSize())
+				r.set(i + 1);
+		}
+		r.set(R::maxSize() - 1);
+
+		it = r.begin();
+		for (size_t i = 0; i < R::maxSize(); i++) {
+			TS_ASSERT_EQUALS(r.nextSetBit(i) == i, r[i]);
+			if (r[i]) {
+				TS_ASSERT_DIFFERS(it, r.end());
+				TS_ASSERT_EQUALS(*it, i);
+				++it;
+			}
+		}
+		TS_ASSERT_EQUALS(it, r.end());
+		TS_ASSERT_EQUALS(r.nextSetBit(R::maxSize()), R::maxSize());
+		}
 	}
 
 	void testSubset( void ) {
@@ -406,6 +431,56 @@ class RelationTester: public RelationTesterAbstract
 		a.set(2);
 		TS_ASSERT(!a.isSubsetOf(b));
 		TS_ASSERT(b.isSubsetOf(a));
+
+		const size_t high = R::maxSize() - 1;
+		b.set(high);
+		TS_ASSERT(!b.isSubsetOf(a));
+		a.set(high);
+		TS_ASSERT(b.isSubsetOf(a));
+		a.unset(1);
+		TS_ASSERT(!b.isSubsetOf(a));
+	}
+
+	/** compare the (possibly vectorized) word kernels to the plain scalar loops */
+	void testKernels( void ) {
+		typedef typename R::getType T;
+		const size_t n = R::getNWords();
+		typedef gqrtl::ScalarBitsetKernels<T, 1> Scalar;
+
+		for (size_t i = 0; i < R::maxSize(); i += 3) {
+			R a = R(i) << i;
+			a.set(R::maxSize() - 1 - i);
+			R b = R(~i) << (R::maxSize() - 1 - i);
+			b.set(i);
+
+			R c = a & b;
+			R d = a | b;
+			R e = a;
+			e.flip();
+			bool subset = true;
+			bool equal = true;
+			for (size_t w = 0; w < n; w++) {
+				const T aw = a.getWord(w);
+				const T bw = b.getWord(w);
+				T x = aw;
+				Scalar::andAssign(&x, &bw);
+				TS_ASSERT_EQUALS(c.getWord(w), x);
+				x = aw;
+				Scalar::orAssign(&x, &bw);
+				TS_ASSERT_EQUALS(d.getWord(w), x);
+				x = aw;
+				Scalar::flip(&x);
+				TS_ASSERT_EQUALS(e.getWord(w), x);
+				subset = subset && Scalar::isSubsetOf(&aw, &bw);
+				equal = equal && Scalar::equal(&aw, &bw);
+			}
+			TS_ASSERT_EQUALS(a.isSubsetOf(b), subset);
+			TS_ASSERT_EQUALS(a == b, equal);
+			TS_ASSERT(c.isSubsetOf(a));
+			TS_ASSERT(c.isSubsetOf(b));
+			TS_ASSERT(a.isSubsetOf(d));
+			TS_ASSERT((a & e).none());
+		}
 	}
 };
 
@@ -426,6 +501,7 @@ class RelationFixedBitsetTest : public CxxTest::TestSuite
 	   testers.push_back(new RelationTester< gqrtl::RelationFixedBitset<uint16_t, 1> >());
 	   testers.push_back(new RelationTester< gqrtl::RelationFixedBitset<uint32_t, 1> >());
 	   testers.push_back(new RelationTester< gqrtl::RelationFixedBitset<uint64_t, 2> >());
+	   testers.push_back(new RelationTester< gqrtl::RelationFixedBitset<size_t, 4> >());
 	   testers.push_back(new RelationTester< gqrtl::RelationFixedBitset<size_t, 5> >());
 	   testers.push_back(new RelationTester< gqrtl::RelationFixedBitset<size_t, 10> >());
        }
@@ -458,6 +534,7 @@ class RelationFixedBitsetTest : public CxxTest::TestSuite
                testers[i]->testDecrement();
                testers[i]->testConstIterator();
                testers[i]->testSubset();
+               testers[i]->testKernels();
 	   }
        }
 };
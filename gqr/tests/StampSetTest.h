@@ -0,0 +1,43 @@
+// -*- C++ -*-
+#ifndef STAMP_SET_TEST_H
+#define STAMP_SET_TEST_H
+
+#include "gqrtl/StampSet.h"
+#include "TestSuite.h"
+
+class StampSetTest:public CxxTest::TestSuite {
+ public:
+    void testInsertClear() {
+        gqrtl::StampSet set(100);
+
+        for (size_t i = 0; i < 100; i++)
+            TS_ASSERT(!set.contains(i));
+
+        set.insert(3);
+        set.insert(99);
+        TS_ASSERT(set.contains(3));
+        TS_ASSERT(set.contains(99));
+        TS_ASSERT(!set.contains(4));
+
+        set.clear();
+        TS_ASSERT(!set.contains(3));
+        TS_ASSERT(!set.contains(99));
+
+        set.insert(4);
+        TS_ASSERT(set.contains(4));
+        TS_ASSERT(!set.contains(3));
+    }
+
+    void testManyGenerations() {
+        gqrtl::StampSet set(10);
+
+        for (size_t g = 0; g < 1000; g++) {
+            set.insert(g % 10);
+            TS_ASSERT(set.contains(g % 10));
+            TS_ASSERT(!set.contains((g+1) % 10));
+            set.clear();
+        }
+    }
+};
+
+#endif                          // STAMP_SET_TEST_H